@@ -0,0 +1,357 @@
+#include <cstdio> // for `fopen()` and `fprintf()`
+#include <cstring> // for `strcmp()`
+#include <cmath> // for `cosf()` and `sinf()`
+#include <nctl/Array.h>
+
+#ifdef WITH_ZLIB
+	#include <zlib.h>
+#endif
+
+#include "MapGenerator.h"
+
+namespace {
+
+const unsigned int TileSize = 16;
+const unsigned int TileSetColumns = 16;
+const unsigned int NumTiles = TileSetColumns * TileSetColumns;
+/// The maximum size of a zstd block
+const unsigned int MaxZstdBlockSize = 128 * 1024;
+
+const char Base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/// A xorshift pseudo-random generator, good enough to avoid long runs of equal GIDs
+class Random
+{
+  public:
+	explicit Random(unsigned int seed)
+	    : state_(seed != 0 ? seed : 1) {}
+
+	inline unsigned int next()
+	{
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 17;
+		state_ ^= state_ << 5;
+		return state_;
+	}
+
+	/// Returns a number between zero and one
+	inline float nextFloat() { return (next() & 0xffffff) / float(0x1000000); }
+
+  private:
+	unsigned int state_;
+};
+
+void appendLittleEndian(nctl::Array<unsigned char> &bytes, unsigned int value, unsigned int numBytes)
+{
+	for (unsigned int i = 0; i < numBytes; i++)
+		bytes.pushBack(static_cast<unsigned char>(value >> (i * 8)));
+}
+
+void writeBase64(FILE *file, const unsigned char *bytes, unsigned long int size)
+{
+	char quad[4];
+	unsigned long int i = 0;
+	for (; i + 3 <= size; i += 3)
+	{
+		const unsigned int triple = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+		quad[0] = Base64Chars[(triple >> 18) & 0x3f];
+		quad[1] = Base64Chars[(triple >> 12) & 0x3f];
+		quad[2] = Base64Chars[(triple >> 6) & 0x3f];
+		quad[3] = Base64Chars[triple & 0x3f];
+		fwrite(quad, 1, 4, file);
+	}
+
+	if (i < size)
+	{
+		const bool hasTwoBytes = (i + 1 < size);
+		const unsigned int triple = (bytes[i] << 16) | (hasTwoBytes ? bytes[i + 1] << 8 : 0);
+		quad[0] = Base64Chars[(triple >> 18) & 0x3f];
+		quad[1] = Base64Chars[(triple >> 12) & 0x3f];
+		quad[2] = hasTwoBytes ? Base64Chars[(triple >> 6) & 0x3f] : '=';
+		quad[3] = '=';
+		fwrite(quad, 1, 4, file);
+	}
+}
+
+/// Wraps the bytes in a zstd frame made of raw blocks, which the decoder handles as any other frame
+void compressZstdRaw(const nctl::Array<unsigned char> &input, nctl::Array<unsigned char> &output)
+{
+	output.setCapacity(input.size() + input.size() / MaxZstdBlockSize * 3 + 16);
+	appendLittleEndian(output, 0xfd2fb528, 4);
+	// Single segment frame with a four bytes content size and without a checksum
+	output.pushBack(0xa0);
+	appendLittleEndian(output, input.size(), 4);
+
+	unsigned int offset = 0;
+	do
+	{
+		const unsigned int blockSize = (input.size() - offset > MaxZstdBlockSize) ? MaxZstdBlockSize : input.size() - offset;
+		const bool isLastBlock = (offset + blockSize == input.size());
+		appendLittleEndian(output, (blockSize << 3) | (isLastBlock ? 1 : 0), 3);
+		for (unsigned int i = 0; i < blockSize; i++)
+			output.pushBack(input[offset + i]);
+		offset += blockSize;
+	} while (offset < input.size());
+}
+
+#ifdef WITH_ZLIB
+bool compressZlib(const nctl::Array<unsigned char> &input, nctl::Array<unsigned char> &output, bool gzipHeader)
+{
+	z_stream stream = {};
+	// A window of 15 bits plus 16 writes a gzip header instead of a zlib one
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzipHeader ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	output.setSize(deflateBound(&stream, input.size()) + 32);
+	stream.next_in = const_cast<unsigned char *>(input.data());
+	stream.avail_in = input.size();
+	stream.next_out = output.data();
+	stream.avail_out = output.size();
+	const int result = deflate(&stream, Z_FINISH);
+	output.setSize(stream.total_out);
+	deflateEnd(&stream);
+
+	return (result == Z_STREAM_END);
+}
+#endif
+
+void writeProperties(FILE *file, unsigned int numProperties, Random &random, const char *indent)
+{
+	if (numProperties == 0)
+		return;
+
+	fprintf(file, "%s<properties>\n", indent);
+	for (unsigned int i = 0; i < numProperties; i++)
+	{
+		switch (i % 4)
+		{
+			case 0:
+				fprintf(file, "%s <property name=\"name_%u\" value=\"value_%u\"/>\n", indent, i, random.next() % 64);
+				break;
+			case 1:
+				fprintf(file, "%s <property name=\"count_%u\" type=\"int\" value=\"%u\"/>\n", indent, i, random.next() % 1000);
+				break;
+			case 2:
+				fprintf(file, "%s <property name=\"speed_%u\" type=\"float\" value=\"%.3f\"/>\n", indent, i, random.nextFloat() * 100.0f);
+				break;
+			case 3:
+				fprintf(file, "%s <property name=\"enabled_%u\" type=\"bool\" value=\"%s\"/>\n", indent, i, (random.next() & 1) ? "true" : "false");
+				break;
+		}
+	}
+	fprintf(file, "%s</properties>\n", indent);
+}
+
+bool writeLayerData(FILE *file, const MapGenerator::Configuration &config, Random &random)
+{
+	const unsigned int numGids = config.width * config.height;
+	nctl::Array<unsigned char> bytes;
+	if (config.encoding == MapGenerator::Encoding::Csv)
+		fprintf(file, "  <data encoding=\"csv\">\n");
+	else
+		bytes.setCapacity(numGids * 4);
+
+	for (unsigned int i = 0; i < numGids; i++)
+	{
+		const unsigned int gid = (random.nextFloat() < config.emptyTileRatio) ? 0 : 1 + random.next() % NumTiles;
+		if (config.encoding == MapGenerator::Encoding::Csv)
+		{
+			const bool isLastGid = (i + 1 == numGids);
+			fprintf(file, "%u%s", gid, isLastGid ? "\n" : ",");
+			if ((i + 1) % config.width == 0 && isLastGid == false)
+				fputc('\n', file);
+		}
+		else
+			appendLittleEndian(bytes, gid, 4);
+	}
+
+	if (config.encoding == MapGenerator::Encoding::Csv)
+	{
+		fprintf(file, "</data>\n");
+		return true;
+	}
+
+	nctl::Array<unsigned char> compressed;
+	const char *compression = nullptr;
+	if (config.encoding == MapGenerator::Encoding::Zstd)
+	{
+		compressZstdRaw(bytes, compressed);
+		compression = "zstd";
+	}
+#ifdef WITH_ZLIB
+	else if (config.encoding == MapGenerator::Encoding::Zlib || config.encoding == MapGenerator::Encoding::Gzip)
+	{
+		const bool isGzip = (config.encoding == MapGenerator::Encoding::Gzip);
+		if (compressZlib(bytes, compressed, isGzip) == false)
+			return false;
+		compression = isGzip ? "gzip" : "zlib";
+	}
+#endif
+	else if (config.encoding != MapGenerator::Encoding::Base64)
+		return false;
+
+	if (compression)
+		fprintf(file, "  <data encoding=\"base64\" compression=\"%s\">\n   ", compression);
+	else
+		fprintf(file, "  <data encoding=\"base64\">\n   ");
+	const nctl::Array<unsigned char> &encoded = compression ? compressed : bytes;
+	writeBase64(file, encoded.data(), encoded.size());
+	fprintf(file, "\n  </data>\n");
+
+	return true;
+}
+
+/// Writes a star shaped polygon with fractional coordinates, centered in the object bounds
+void writePolygon(FILE *file, unsigned int numPoints, unsigned int width, unsigned int height, Random &random)
+{
+	const float TwoPi = 6.28318530718f;
+	fprintf(file, "   <polygon points=\"");
+	for (unsigned int i = 0; i < numPoints; i++)
+	{
+		const float angle = TwoPi * i / numPoints;
+		const float radius = 0.5f + 0.5f * random.nextFloat();
+		const float x = 0.5f * width * (1.0f + radius * cosf(angle));
+		const float y = 0.5f * height * (1.0f + radius * sinf(angle));
+		fprintf(file, (i == 0) ? "%.2f,%.2f" : " %.2f,%.2f", x, y);
+	}
+	fprintf(file, "\"/>\n");
+}
+
+void writeObject(FILE *file, unsigned int id, const MapGenerator::Configuration &config, Random &random)
+{
+	const float x = random.nextFloat() * config.width * TileSize;
+	const float y = random.nextFloat() * config.height * TileSize;
+	const unsigned int width = TileSize * (1 + random.next() % 4);
+	const unsigned int height = TileSize * (1 + random.next() % 4);
+
+	// Every kind of object is generated in turn, unless the map only has polygons like a collision map
+	const unsigned int kind = config.onlyPolygons ? 3 : id % 5;
+	switch (kind)
+	{
+		case 0:
+			fprintf(file, "  <object id=\"%u\" name=\"rectangle_%u\" x=\"%.2f\" y=\"%.2f\" width=\"%u\" height=\"%u\"", id, id, x, y, width, height);
+			break;
+		case 1:
+			fprintf(file, "  <object id=\"%u\" name=\"ellipse_%u\" x=\"%.2f\" y=\"%.2f\" width=\"%u\" height=\"%u\"", id, id, x, y, width, height);
+			break;
+		case 2:
+			fprintf(file, "  <object id=\"%u\" name=\"point_%u\" x=\"%.2f\" y=\"%.2f\"", id, id, x, y);
+			break;
+		case 3:
+			fprintf(file, "  <object id=\"%u\" name=\"polygon_%u\" x=\"%.2f\" y=\"%.2f\"", id, id, x, y);
+			break;
+		case 4:
+			fprintf(file, "  <object id=\"%u\" gid=\"%u\" x=\"%.2f\" y=\"%.2f\" width=\"%u\" height=\"%u\" rotation=\"%u\"", id, 1 + random.next() % NumTiles, x, y, TileSize, TileSize, random.next() % 360);
+			break;
+	}
+
+	if (kind != 1 && kind != 2 && kind != 3 && config.numProperties == 0)
+	{
+		fprintf(file, "/>\n");
+		return;
+	}
+
+	fprintf(file, ">\n");
+	writeProperties(file, config.numProperties, random, "   ");
+	if (kind == 1)
+		fprintf(file, "   <ellipse/>\n");
+	else if (kind == 2)
+		fprintf(file, "   <point/>\n");
+	else if (kind == 3)
+		writePolygon(file, config.numPolygonPoints, width, height, random);
+	fprintf(file, "  </object>\n");
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+bool MapGenerator::generate(const char *filename, const Configuration &config)
+{
+	if (isSupported(config.encoding) == false)
+		return false;
+
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+		return false;
+
+	Random random(config.seed);
+	const unsigned int numLayers = config.numLayers + config.numObjectGroups;
+	fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	fprintf(file, "<map version=\"1.10\" tiledversion=\"1.10.2\" orientation=\"orthogonal\" renderorder=\"right-down\" "
+	              "width=\"%u\" height=\"%u\" tilewidth=\"%u\" tileheight=\"%u\" infinite=\"0\" nextlayerid=\"%u\" nextobjectid=\"%u\">\n",
+	        config.width, config.height, TileSize, TileSize, numLayers + 1, config.numObjectGroups * config.numObjects + 1);
+	writeProperties(file, config.numProperties, random, " ");
+	fprintf(file, " <tileset firstgid=\"1\" name=\"tiles\" tilewidth=\"%u\" tileheight=\"%u\" tilecount=\"%u\" columns=\"%u\">\n",
+	        TileSize, TileSize, NumTiles, TileSetColumns);
+	fprintf(file, "  <image source=\"tiles.png\" width=\"%u\" height=\"%u\"/>\n", TileSize * TileSetColumns, TileSize * TileSetColumns);
+	fprintf(file, " </tileset>\n");
+
+	bool hasWritten = true;
+	unsigned int layerId = 1;
+	for (unsigned int i = 0; i < config.numLayers && hasWritten; i++)
+	{
+		fprintf(file, " <layer id=\"%u\" name=\"Tile Layer %u\" width=\"%u\" height=\"%u\">\n", layerId++, i + 1, config.width, config.height);
+		writeProperties(file, config.numProperties, random, "  ");
+		hasWritten = writeLayerData(file, config, random);
+		fprintf(file, " </layer>\n");
+	}
+
+	unsigned int objectId = 1;
+	for (unsigned int i = 0; i < config.numObjectGroups && hasWritten; i++)
+	{
+		fprintf(file, " <objectgroup id=\"%u\" name=\"Object Layer %u\">\n", layerId++, i + 1);
+		writeProperties(file, config.numProperties, random, "  ");
+		for (unsigned int j = 0; j < config.numObjects; j++)
+			writeObject(file, objectId++, config, random);
+		fprintf(file, " </objectgroup>\n");
+	}
+	fprintf(file, "</map>\n");
+
+	hasWritten = hasWritten && (ferror(file) == 0);
+	fclose(file);
+	return hasWritten;
+}
+
+bool MapGenerator::isSupported(Encoding encoding)
+{
+#ifndef WITH_ZLIB
+	if (encoding == Encoding::Zlib || encoding == Encoding::Gzip)
+		return false;
+#endif
+	return true;
+}
+
+const char *MapGenerator::encodingToString(Encoding encoding)
+{
+	switch (encoding)
+	{
+		case Encoding::Csv:
+			return "csv";
+		case Encoding::Base64:
+			return "base64";
+		case Encoding::Zlib:
+			return "zlib";
+		case Encoding::Gzip:
+			return "gzip";
+		case Encoding::Zstd:
+			return "zstd";
+	}
+	return "unknown";
+}
+
+bool MapGenerator::stringToEncoding(const char *string, Encoding &encoding)
+{
+	const Encoding encodings[] = { Encoding::Csv, Encoding::Base64, Encoding::Zlib, Encoding::Gzip, Encoding::Zstd };
+	for (unsigned int i = 0; i < sizeof(encodings) / sizeof(encodings[0]); i++)
+	{
+		if (strcmp(string, encodingToString(encodings[i])) == 0)
+		{
+			encoding = encodings[i];
+			return true;
+		}
+	}
+	return false;
+}
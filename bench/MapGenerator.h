@@ -0,0 +1,64 @@
+#ifndef MAPGENERATOR_H
+#define MAPGENERATOR_H
+
+/// The class that writes synthetic TMX maps of configurable size, for benchmarking the parsers
+/*! Tile GIDs and object positions come from a fixed seed, so that the same configuration always generates the same file. */
+class MapGenerator
+{
+  public:
+	/// The encoding and compression of the layer data
+	enum class Encoding
+	{
+		Csv,
+		Base64,
+		Zlib,
+		Gzip,
+		/// Raw zstd blocks, as the bundled zstd library is only compiled with the decompressor
+		Zstd
+	};
+
+	class Configuration
+	{
+	  public:
+		Configuration()
+		    : numLayers(4), width(256), height(256), numObjectGroups(1), numObjects(1000),
+		      numProperties(2), numPolygonPoints(4), onlyPolygons(false),
+		      encoding(Encoding::Csv), emptyTileRatio(0.25f), seed(1)
+		{}
+
+		/// The number of tile layers
+		unsigned int numLayers;
+		/// The width of the map and of every layer in tiles
+		unsigned int width;
+		/// The height of the map and of every layer in tiles
+		unsigned int height;
+		/// The number of object groups
+		unsigned int numObjectGroups;
+		/// The number of objects in every object group
+		unsigned int numObjects;
+		/// The number of custom properties of every layer, object group and object
+		unsigned int numProperties;
+		/// The number of vertices of every polygon, at least three
+		unsigned int numPolygonPoints;
+		/// True if every object is a polygon, like in a collision map
+		bool onlyPolygons;
+		/// The encoding of the layer data
+		Encoding encoding;
+		/// The fraction of tiles that are left empty
+		float emptyTileRatio;
+		/// The seed of the pseudo-random generator
+		unsigned int seed;
+	};
+
+	/// Writes a map with the specified configuration, returns false if the file cannot be written
+	static bool generate(const char *filename, const Configuration &config);
+
+	/// Returns true if the generator supports an encoding with the current build options
+	static bool isSupported(Encoding encoding);
+	/// Returns the name of an encoding as used on the command line
+	static const char *encodingToString(Encoding encoding);
+	/// Converts a name used on the command line to an encoding, returns false if the name is unknown
+	static bool stringToEncoding(const char *string, Encoding &encoding);
+};
+
+#endif
@@ -0,0 +1,925 @@
+#include <cstdio> // for `printf()`, `sscanf()` and `remove()`
+#include <cstdlib> // for `strtoul()`
+#include <cstring> // for `strcmp()`, `strstr()` and `memcpy()`
+#include <chrono>
+#include <thread> // for `std::this_thread::sleep_for()`
+#include <nctl/Array.h>
+#include <nctl/String.h>
+#include <ncine/FileSystem.h>
+#include <ncine/TimeStamp.h>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+#include "MapModel.h"
+#include "TmxParser.h"
+#include "TmxAttributes.h"
+#include "TmjParser.h"
+#include "TileSetCache.h"
+#include "TemplateCache.h"
+#include "MapCache.h"
+#include "MappedFile.h"
+#include "WorkerPool.h"
+#include "DataDecoder.h"
+#include "MapGenerator.h"
+
+namespace nc = ncine;
+
+namespace {
+
+const unsigned int SweepNumThreads[] = { 1, 2, 4, 8, 16 };
+const char *SweepStageNames[] = { "Decode (1 thr)", "Decode (2 thr)", "Decode (4 thr)", "Decode (8 thr)", "Decode (16 thr)" };
+
+const MapGenerator::Encoding CompareEncodings[] = { MapGenerator::Encoding::Csv, MapGenerator::Encoding::Base64, MapGenerator::Encoding::Zlib,
+	                                                MapGenerator::Encoding::Gzip, MapGenerator::Encoding::Zstd };
+const char *CompareStageNames[] = { "Load (csv)", "Load (base64)", "Load (zlib)", "Load (gzip)", "Load (zstd)" };
+
+/// The timings of a stage of the benchmark, one for every iteration
+struct Stage
+{
+	const char *name = "";
+	nctl::Array<float> milliseconds;
+	/// The number of bytes processed by every iteration, zero if the throughput is not meaningful
+	unsigned long int numBytes = 0;
+	/// The resident memory of the process when the stage starts, zero if the peak cannot be reset
+	unsigned long int startMemory = 0;
+	/// The peak resident memory of the process during the stage, or since the process has started if it cannot be reset
+	unsigned long int peakMemory = 0;
+};
+
+struct Options
+{
+	MapGenerator::Configuration generator;
+	const char *inputFilename = nullptr;
+	const char *outputFilename = "bench_map.tmx";
+	unsigned int numIterations = 10;
+	unsigned int numThreads = 0;
+	bool withDom = true;
+	bool withStream = true;
+	bool withCache = true;
+	bool lazyDecoding = false;
+	/// Measures the decoding of the layer data with every number of threads in `SweepNumThreads`
+	bool threadSweep = false;
+	/// Generates the same map with every encoding in `CompareEncodings` and measures their loading
+	bool compareEncodings = false;
+	/// Measures the loading of a region of a TMX map too, when its size is not zero
+	TmxParser::Region region;
+	bool keepFiles = false;
+};
+
+#if defined(__linux__)
+/// Returns the value in bytes of a memory field of `/proc/self/status`, like `VmRSS` or `VmHWM`
+unsigned long int readStatusMemory(const char *field)
+{
+	FILE *file = fopen("/proc/self/status", "r");
+	if (file == nullptr)
+		return 0;
+
+	const unsigned int fieldLength = static_cast<unsigned int>(strlen(field));
+	unsigned long int kilobytes = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), file) != nullptr)
+	{
+		if (strncmp(line, field, fieldLength) == 0 && line[fieldLength] == ':')
+		{
+			kilobytes = strtoul(line + fieldLength + 1, nullptr, 10);
+			break;
+		}
+	}
+	fclose(file);
+
+	return kilobytes * 1024;
+}
+#endif
+
+/// Resets the peak resident memory of the process to the current one, returns false if the platform does not support it
+bool resetPeakMemory()
+{
+#if defined(__linux__)
+	// Writing 5 to `clear_refs` resets the `VmHWM` field of `/proc/self/status`
+	FILE *file = fopen("/proc/self/clear_refs", "w");
+	if (file == nullptr)
+		return false;
+	const bool hasWritten = (fputs("5", file) >= 0);
+	return (fclose(file) == 0 && hasWritten);
+#else
+	return false;
+#endif
+}
+
+/// Returns the resident memory of the process in bytes, or zero if the platform does not support it
+unsigned long int residentMemory()
+{
+#if defined(__linux__)
+	return readStatusMemory("VmRSS");
+#else
+	return 0;
+#endif
+}
+
+/// Returns the peak resident memory of the process in bytes, since the last reset where supported
+unsigned long int peakMemory()
+{
+#if defined(__linux__)
+	const unsigned long int peak = readStatusMemory("VmHWM");
+	if (peak > 0)
+		return peak;
+#endif
+
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return static_cast<unsigned long int>(counters.PeakWorkingSetSize);
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+	#if defined(__APPLE__)
+	return static_cast<unsigned long int>(usage.ru_maxrss);
+	#else
+	// Linux reports the value in kilobytes
+	return static_cast<unsigned long int>(usage.ru_maxrss) * 1024;
+	#endif
+#endif
+}
+
+void sortTimes(nctl::Array<float> &times)
+{
+	for (unsigned int i = 1; i < times.size(); i++)
+	{
+		const float time = times[i];
+		unsigned int j = i;
+		for (; j > 0 && times[j - 1] > time; j--)
+			times[j] = times[j - 1];
+		times[j] = time;
+	}
+}
+
+void printStages(nctl::Array<Stage> &stages)
+{
+	// The increase over the memory at the start of a stage is only known if the peak can be reset
+	const bool hasStagePeaks = (stages.isEmpty() == false && stages.front().startMemory > 0);
+	printf("\n%-16s %10s %10s %10s %10s %12s\n", "Stage", "Min ms", "Median ms", "Max ms", "MB/s", hasStagePeaks ? "Peak +MiB" : "Max RSS MiB");
+	for (unsigned int i = 0; i < stages.size(); i++)
+	{
+		Stage &stage = stages[i];
+		if (stage.milliseconds.isEmpty())
+			continue;
+
+		sortTimes(stage.milliseconds);
+		const float minTime = stage.milliseconds.front();
+		const float medianTime = stage.milliseconds[stage.milliseconds.size() / 2];
+		const float maxTime = stage.milliseconds.back();
+		printf("%-16s %10.3f %10.3f %10.3f ", stage.name, minTime, medianTime, maxTime);
+		if (stage.numBytes > 0 && medianTime > 0.0f)
+			printf("%10.1f ", (stage.numBytes / (1024.0f * 1024.0f)) / (medianTime * 0.001f));
+		else
+			printf("%10s ", "-");
+		const unsigned long int memory = (stage.peakMemory > stage.startMemory) ? stage.peakMemory - stage.startMemory : 0;
+		printf("%12.1f\n", memory / (1024.0f * 1024.0f));
+	}
+
+	if (hasStagePeaks)
+		printf("Peak +MiB is the increase of the peak resident memory during a stage over the memory at its start\n");
+	else
+		printf("Max RSS MiB is the peak resident memory of the process since it has started, not of a single stage\n");
+}
+
+/// Adds a stage and resets the peak memory, so that it only measures what happens from now on
+Stage &addStage(nctl::Array<Stage> &stages, const char *name, unsigned long int numBytes)
+{
+	stages.emplaceBack();
+	stages.back().name = name;
+	stages.back().numBytes = numBytes;
+	if (resetPeakMemory())
+		stages.back().startMemory = residentMemory();
+	return stages.back();
+}
+
+void printModelSummary(const MapModel &mapModel)
+{
+	const MapModel::Map &map = mapModel.map();
+	unsigned long int numTiles = 0;
+	for (unsigned int i = 0; i < map.layers.size(); i++)
+	{
+		numTiles += map.layers[i].data.tileGids.size();
+		for (unsigned int j = 0; j < map.layers[i].chunks.size(); j++)
+			numTiles += map.layers[i].chunks[j].tileGids.size();
+	}
+	unsigned int numObjects = 0;
+	for (unsigned int i = 0; i < map.objectGroups.size(); i++)
+		numObjects += map.objectGroups[i].objects.size();
+
+	printf("Model: %u tilesets, %u tile layers (%lu GIDs), %u object groups (%u objects), %u strings (%u bytes)\n",
+	       map.tileSets.size(), map.layers.size(), numTiles, map.objectGroups.size(), numObjects,
+	       mapModel.strings().size(), mapModel.strings().numChars());
+}
+
+/// Adds the number of properties of an array and the bytes allocated for them
+void countProperties(const nctl::Array<MapModel::Property> &properties, unsigned int &numProperties, unsigned long int &numBytes)
+{
+	numProperties += properties.size();
+	numBytes += properties.capacity() * sizeof(MapModel::Property);
+}
+
+/// Prints the memory allocated for the properties of every element of the map and for the string table of the model
+void printPropertyMemory(const MapModel &mapModel)
+{
+	const MapModel::Map &map = mapModel.map();
+	unsigned int numProperties = 0;
+	unsigned long int numBytes = 0;
+
+	countProperties(map.properties, numProperties, numBytes);
+	for (unsigned int i = 0; i < map.tileSets.size(); i++)
+	{
+		const MapModel::TileSet &tileSet = map.tileSets[i];
+		countProperties(tileSet.properties, numProperties, numBytes);
+		for (unsigned int j = 0; j < tileSet.terrainTypes.size(); j++)
+			countProperties(tileSet.terrainTypes[j].properties, numProperties, numBytes);
+		for (unsigned int j = 0; j < tileSet.tiles.size(); j++)
+			countProperties(tileSet.tiles[j].properties, numProperties, numBytes);
+	}
+	for (unsigned int i = 0; i < map.layers.size(); i++)
+		countProperties(map.layers[i].properties, numProperties, numBytes);
+	// The properties of the objects of a group are stored in a single array
+	for (unsigned int i = 0; i < map.objectGroups.size(); i++)
+	{
+		countProperties(map.objectGroups[i].properties, numProperties, numBytes);
+		countProperties(map.objectGroups[i].objects.properties, numProperties, numBytes);
+	}
+	for (unsigned int i = 0; i < map.imageLayers.size(); i++)
+		countProperties(map.imageLayers[i].properties, numProperties, numBytes);
+	for (unsigned int i = 0; i < map.groups.size(); i++)
+		countProperties(map.groups[i].properties, numProperties, numBytes);
+	for (unsigned int i = 0; i < map.templates.size(); i++)
+		countProperties(map.templates[i].object.properties, numProperties, numBytes);
+
+	const StringTable &strings = mapModel.strings();
+	printf("Memory: %u properties in %lu bytes (%u bytes each), %u strings in %lu bytes, %lu bytes in total\n",
+	       numProperties, numBytes, static_cast<unsigned int>(sizeof(MapModel::Property)), strings.size(),
+	       strings.numAllocatedBytes(), numBytes + strings.numAllocatedBytes());
+}
+
+bool parseArguments(int argc, char **argv, Options &options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char *arg = argv[i];
+		const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		const bool hasValue = (value != nullptr);
+
+		if (strcmp(arg, "--keep") == 0)
+			options.keepFiles = true;
+		else if (strcmp(arg, "--only-polygons") == 0)
+			options.generator.onlyPolygons = true;
+		else if (strcmp(arg, "--object-heavy") == 0)
+		{
+			// Most of the parsing time goes to the attributes of the objects, the options that follow can still change it
+			options.generator.numLayers = 1;
+			options.generator.width = 64;
+			options.generator.height = 64;
+			options.generator.numObjectGroups = 16;
+			options.generator.numObjects = 5000;
+		}
+		else if (strcmp(arg, "--no-cache") == 0)
+			options.withCache = false;
+		else if (strcmp(arg, "--lazy") == 0)
+			options.lazyDecoding = true;
+		else if (strcmp(arg, "--thread-sweep") == 0)
+			options.threadSweep = true;
+		else if (strcmp(arg, "--compare-encodings") == 0)
+			options.compareEncodings = true;
+		else if (hasValue == false)
+		{
+			fprintf(stderr, "Missing value for \"%s\"\n", arg);
+			return false;
+		}
+		else
+		{
+			const unsigned int number = static_cast<unsigned int>(strtoul(value, nullptr, 10));
+			if (strcmp(arg, "--file") == 0)
+				options.inputFilename = value;
+			else if (strcmp(arg, "--output") == 0)
+				options.outputFilename = value;
+			else if (strcmp(arg, "--layers") == 0)
+				options.generator.numLayers = number;
+			else if (strcmp(arg, "--width") == 0)
+				options.generator.width = number;
+			else if (strcmp(arg, "--height") == 0)
+				options.generator.height = number;
+			else if (strcmp(arg, "--object-groups") == 0)
+				options.generator.numObjectGroups = number;
+			else if (strcmp(arg, "--objects") == 0)
+				options.generator.numObjects = number;
+			else if (strcmp(arg, "--properties") == 0)
+				options.generator.numProperties = number;
+			else if (strcmp(arg, "--polygon-points") == 0)
+				options.generator.numPolygonPoints = (number >= 3) ? number : 3;
+			else if (strcmp(arg, "--seed") == 0)
+				options.generator.seed = number;
+			else if (strcmp(arg, "--iterations") == 0)
+				options.numIterations = (number > 0) ? number : 1;
+			else if (strcmp(arg, "--threads") == 0)
+				options.numThreads = number;
+			else if (strcmp(arg, "--encoding") == 0)
+			{
+				if (MapGenerator::stringToEncoding(value, options.generator.encoding) == false)
+				{
+					fprintf(stderr, "Unknown encoding \"%s\"\n", value);
+					return false;
+				}
+			}
+			else if (strcmp(arg, "--region") == 0)
+			{
+				nc::Recti &rect = options.region.rect;
+				if (sscanf(value, "%d,%d,%d,%d", &rect.x, &rect.y, &rect.w, &rect.h) != 4 || rect.w <= 0 || rect.h <= 0)
+				{
+					fprintf(stderr, "Invalid region \"%s\"\n", value);
+					return false;
+				}
+			}
+			else if (strcmp(arg, "--region-layer") == 0)
+				options.region.layerNames.pushBack(nctl::String(value));
+			else if (strcmp(arg, "--backend") == 0)
+			{
+				options.withDom = (strcmp(value, "dom") == 0 || strcmp(value, "all") == 0);
+				options.withStream = (strcmp(value, "stream") == 0 || strcmp(value, "all") == 0);
+				if (options.withDom == false && options.withStream == false)
+				{
+					fprintf(stderr, "Unknown backend \"%s\"\n", value);
+					return false;
+				}
+			}
+			else
+			{
+				fprintf(stderr, "Unknown option \"%s\"\n", arg);
+				return false;
+			}
+			i++;
+		}
+	}
+
+	return true;
+}
+
+void printUsage(const char *name)
+{
+	printf("Usage: %s [options]\n", name);
+	printf("Measures the map parsers on a generated TMX map or on an existing TMX or TMJ map\n\n");
+	printf("  --file <path>            Benchmark an existing map instead of generating one\n");
+	printf("  --output <path>          The generated map file (default: bench_map.tmx)\n");
+	printf("  --layers <n>             Number of tile layers (default: 4)\n");
+	printf("  --width <n>              Map width in tiles (default: 256)\n");
+	printf("  --height <n>             Map height in tiles (default: 256)\n");
+	printf("  --object-groups <n>      Number of object groups (default: 1)\n");
+	printf("  --objects <n>            Objects in every object group (default: 1000)\n");
+	printf("  --properties <n>         Properties of every layer and object (default: 2)\n");
+	printf("  --polygon-points <n>     Vertices of every polygon (default: 4)\n");
+	printf("  --only-polygons          Generate only polygon objects, like a collision map\n");
+	printf("  --object-heavy           Generate one 64x64 layer and 16 object groups of 5000 objects\n");
+	printf("  --encoding <name>        csv, base64, zlib, gzip or zstd (default: csv)\n");
+	printf("  --seed <n>               Seed of the generated content (default: 1)\n");
+	printf("  --backend <name>         dom, stream or all, for TMX maps (default: all)\n");
+	printf("  --iterations <n>         Iterations of every stage (default: 10)\n");
+	printf("  --threads <n>            Worker threads, zero for the hardware concurrency (default: 0)\n");
+	printf("  --no-cache               Skip the map cache stages\n");
+	printf("  --lazy                   Defer the layer data decoding and measure it in its own stage\n");
+	printf("  --thread-sweep           Measure the layer data decoding with 1, 2, 4, 8 and 16 threads\n");
+	printf("  --compare-encodings      Also load the generated map with every supported encoding\n");
+	printf("  --region <x,y,w,h>       Also measure the loading of a rectangle of tiles of a TMX map\n");
+	printf("  --region-layer <name>    Only decode this layer in the region, it can be repeated\n");
+	printf("  --keep                   Keep the generated map and its cache\n");
+}
+
+/// Parses a list of points like the parser did before `NumberParser`, as a reference for the microbenchmark
+bool parsePolyPointsSscanf(const char *string, nctl::Array<nc::Vector2f> &points)
+{
+	const char *buffer = string;
+	while (*buffer != '\0')
+	{
+		const char *begin = buffer;
+		while (*begin == ' ' || *begin == '\t' || *begin == '\n')
+			begin++;
+		const char *comma = begin;
+		while (*comma != ' ' && *comma != '\t' && *comma != '\n' && *comma != '\0' && *comma != ',')
+			comma++;
+		if (*comma != ',')
+			return false;
+		const char *end = comma + 1;
+		while (*end != ' ' && *end != '\t' && *end != '\n' && *end != '\0' && *end != ',')
+			end++;
+
+		float x = 0.0f;
+		float y = 0.0f;
+		if (sscanf(begin, "%f", &x) != 1 || sscanf(comma + 1, "%f", &y) != 1)
+			return false;
+
+		points.emplaceBack(x, y);
+		buffer = end;
+		while (*buffer == ' ' || *buffer == '\t' || *buffer == '\n')
+			buffer++;
+	}
+
+	points.shrinkToFit();
+	return (points.isEmpty() == false);
+}
+
+/// Copies the values of all the `points` attributes of a TMX file one after the other, each with its terminator
+unsigned long int collectPointLists(const char *string, nctl::Array<char> &chars, nctl::Array<unsigned int> &offsets)
+{
+	const char *Attribute = " points=\"";
+	const unsigned int attributeLength = static_cast<unsigned int>(strlen(Attribute));
+
+	unsigned long int numBytes = 0;
+	const char *begin = strstr(string, Attribute);
+	while (begin != nullptr)
+	{
+		begin += attributeLength;
+		const char *end = strchr(begin, '"');
+		if (end == nullptr)
+			break;
+
+		offsets.pushBack(chars.size());
+		for (const char *c = begin; c < end; c++)
+			chars.pushBack(*c);
+		chars.pushBack('\0');
+		numBytes += static_cast<unsigned long int>(end - begin);
+		begin = strstr(end, Attribute);
+	}
+
+	return numBytes;
+}
+
+using PointsFunction = bool (*)(const char *string, nctl::Array<nc::Vector2f> &points);
+
+/// Parses all the lists of points, returns false at the first one that cannot be parsed
+bool parsePointLists(PointsFunction pointsFunction, const nctl::Array<char> &chars, const nctl::Array<unsigned int> &offsets, float &milliseconds)
+{
+	nctl::Array<nc::Vector2f> points;
+	const nc::TimeStamp timestamp = nc::TimeStamp::now();
+	for (unsigned int i = 0; i < offsets.size(); i++)
+	{
+		points.clear();
+		if (pointsFunction(chars.data() + offsets[i], points) == false)
+			return false;
+	}
+	milliseconds = timestamp.millisecondsSince();
+
+	return true;
+}
+
+/// Copies the contents of all the CSV `<data>` elements of a TMX file one after the other, each with its terminator
+/*! The data of infinite maps is skipped, as it is split in `<chunk>` elements. */
+unsigned long int collectCsvData(const char *string, nctl::Array<char> &chars, nctl::Array<unsigned int> &offsets)
+{
+	const char *Element = "<data encoding=\"csv\">";
+	const unsigned int elementLength = static_cast<unsigned int>(strlen(Element));
+
+	unsigned long int numBytes = 0;
+	const char *begin = strstr(string, Element);
+	while (begin != nullptr)
+	{
+		begin += elementLength;
+		const char *end = strchr(begin, '<');
+		if (end == nullptr)
+			break;
+
+		if (strncmp(end, "</data>", 7) == 0)
+		{
+			offsets.pushBack(chars.size());
+			for (const char *c = begin; c < end; c++)
+				chars.pushBack(*c);
+			chars.pushBack('\0');
+			numBytes += static_cast<unsigned long int>(end - begin);
+		}
+		begin = strstr(end, Element);
+	}
+
+	return numBytes;
+}
+
+bool decodeCsvReference(const char *string, nctl::Array<unsigned int> &tileGids, DataDecoder::Report &report)
+{
+	// Unlike `decodeCsv()`, the reference decoder appends to the array
+	tileGids.clear();
+	return DataDecoder::decodeCsvReference(string, tileGids, report);
+}
+
+bool decodeCsv(const char *string, nctl::Array<unsigned int> &tileGids, DataDecoder::Report &report)
+{
+	// The array is reused, so its capacity is already the one of the previous layer
+	return DataDecoder::decodeCsv(string, 0, tileGids, report);
+}
+
+using CsvFunction = bool (*)(const char *string, nctl::Array<unsigned int> &tileGids, DataDecoder::Report &report);
+
+/// Decodes all the CSV strings, returns false at the first one that cannot be decoded
+/*! \param checksum The sum of all the decoded GIDs, to compare the results of different decoders */
+bool decodeCsvData(CsvFunction csvFunction, const nctl::Array<char> &chars, const nctl::Array<unsigned int> &offsets, float &milliseconds, unsigned long int &checksum)
+{
+	nctl::Array<unsigned int> tileGids;
+	DataDecoder::Report report;
+	checksum = 0;
+	const nc::TimeStamp timestamp = nc::TimeStamp::now();
+	for (unsigned int i = 0; i < offsets.size(); i++)
+	{
+		if (csvFunction(chars.data() + offsets[i], tileGids, report) == false)
+			return false;
+		for (unsigned int j = 0; j < tileGids.size(); j++)
+			checksum += tileGids[j];
+	}
+	milliseconds = timestamp.millisecondsSince();
+
+	return true;
+}
+
+enum class ParserType
+{
+	Dom,
+	Stream,
+	Json
+};
+
+/// Parses the map from a copy of the file contents, as the parsers work in place
+bool parseMap(ParserType parserType, MapModel &mapModel, const nctl::Array<unsigned char> &contents, nctl::Array<unsigned char> &buffer, const char *filename, bool lazyDecoding, float &milliseconds)
+{
+	memcpy(buffer.data(), contents.data(), contents.size());
+	mapModel.tmxDirName() = nc::fs::dirName(filename);
+	// Every iteration parses external tilesets and templates again
+	TileSetCache::clear();
+	TemplateCache::clear();
+
+	const nc::TimeStamp timestamp = nc::TimeStamp::now();
+	bool hasParsed = false;
+	if (parserType == ParserType::Json)
+		hasParsed = TmjParser::loadFromMemory(mapModel, buffer.data(), contents.size(), lazyDecoding);
+	else
+		hasParsed = TmxParser::loadFromMemory(mapModel, buffer.data(), contents.size(), (parserType == ParserType::Dom) ? TmxParser::Backend::Dom : TmxParser::Backend::Stream, lazyDecoding);
+	milliseconds = timestamp.millisecondsSince();
+
+	return hasParsed;
+}
+
+/// Reads the whole file in memory, returns false if it cannot be opened
+bool readFile(const char *filename, nctl::Array<unsigned char> &contents)
+{
+	MappedFile file;
+	if (file.open(filename) == false)
+		return false;
+
+	contents.setSize(file.size());
+	memcpy(contents.data(), file.data(), file.size());
+	return true;
+}
+
+/// Parses a region of the map from a copy of the file contents
+bool parseRegion(ParserType parserType, MapModel &mapModel, const nctl::Array<unsigned char> &contents, nctl::Array<unsigned char> &buffer, const char *filename, const TmxParser::Region &region, float &milliseconds)
+{
+	memcpy(buffer.data(), contents.data(), contents.size());
+	mapModel.tmxDirName() = nc::fs::dirName(filename);
+	TileSetCache::clear();
+	TemplateCache::clear();
+
+	const nc::TimeStamp timestamp = nc::TimeStamp::now();
+	const bool hasParsed = TmxParser::loadRegionFromMemory(mapModel, buffer.data(), contents.size(), region, (parserType == ParserType::Dom) ? TmxParser::Backend::Dom : TmxParser::Backend::Stream);
+	milliseconds = timestamp.millisecondsSince();
+
+	return hasParsed;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0))
+	{
+		printUsage(argv[0]);
+		return EXIT_SUCCESS;
+	}
+	if (parseArguments(argc, argv, options) == false)
+	{
+		printUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	WorkerPool::setNumThreads(options.numThreads);
+	// Stages are referenced while they are filled, the array should never grow
+	nctl::Array<Stage> stages(32);
+
+	const char *filename = options.inputFilename;
+	nc::TimeStamp generatedTime;
+	if (filename == nullptr)
+	{
+		const MapGenerator::Configuration &config = options.generator;
+		if (MapGenerator::isSupported(config.encoding) == false)
+		{
+			fprintf(stderr, "The %s encoding is not supported by this build\n", MapGenerator::encodingToString(config.encoding));
+			return EXIT_FAILURE;
+		}
+
+		filename = options.outputFilename;
+		printf("Generating a %ux%u map with %u %s layers, %u object groups of %u objects and %u properties per element\n",
+		       config.width, config.height, config.numLayers, MapGenerator::encodingToString(config.encoding),
+		       config.numObjectGroups, config.numObjects, config.numProperties);
+
+		Stage &stage = addStage(stages, "Generate", 0);
+		const nc::TimeStamp timestamp = nc::TimeStamp::now();
+		if (MapGenerator::generate(filename, config) == false)
+		{
+			fprintf(stderr, "Cannot write the map file \"%s\"\n", filename);
+			return EXIT_FAILURE;
+		}
+		stage.milliseconds.pushBack(timestamp.millisecondsSince());
+		stage.peakMemory = peakMemory();
+		generatedTime = nc::TimeStamp::now();
+	}
+
+	const unsigned long int fileSize = static_cast<unsigned long int>(nc::fs::fileSize(filename));
+	printf("Map file \"%s\": %.2f MiB, %u iterations, up to %u worker threads\n", filename, fileSize / (1024.0f * 1024.0f), options.numIterations, WorkerPool::numThreads());
+
+	// The contents are kept in memory so that the parse stages do not measure the file system
+	nctl::Array<unsigned char> contents;
+	{
+		Stage &stage = addStage(stages, "Read", fileSize);
+		for (unsigned int i = 0; i < options.numIterations; i++)
+		{
+			const nc::TimeStamp timestamp = nc::TimeStamp::now();
+			// Copying the contents also measures the page faults of a memory-mapped file
+			if (readFile(filename, contents) == false)
+			{
+				fprintf(stderr, "Cannot read the map file \"%s\"\n", filename);
+				return EXIT_FAILURE;
+			}
+			stage.milliseconds.pushBack(timestamp.millisecondsSince());
+		}
+		stage.peakMemory = peakMemory();
+	}
+
+	nctl::Array<unsigned char> buffer;
+	buffer.setSize(contents.size() + 1);
+	buffer[contents.size()] = '\0';
+
+	const bool isJson = nc::fs::hasExtension(filename, "tmj") || nc::fs::hasExtension(filename, "json");
+	const ParserType parserTypes[] = { ParserType::Dom, ParserType::Stream, ParserType::Json };
+	const char *parserNames[] = { "Parse (DOM)", "Parse (stream)", "Parse (JSON)" };
+	const char *decodeNames[] = { "Decode (DOM)", "Decode (stream)", "Decode (JSON)" };
+
+	// The regions are loaded first, so that their peak memory is not the one of a whole map
+	const char *regionNames[] = { "Region (DOM)", "Region (stream)" };
+	for (unsigned int parserIdx = 0; parserIdx < 2 && options.region.rect.w > 0 && isJson == false; parserIdx++)
+	{
+		const ParserType parserType = parserTypes[parserIdx];
+		if ((parserType == ParserType::Dom && options.withDom == false) || (parserType == ParserType::Stream && options.withStream == false))
+			continue;
+
+		Stage &stage = addStage(stages, regionNames[parserIdx], fileSize);
+		for (unsigned int i = 0; i < options.numIterations; i++)
+		{
+			MapModel mapModel;
+			float milliseconds = 0.0f;
+			if (parseRegion(parserType, mapModel, contents, buffer, filename, options.region, milliseconds) == false)
+			{
+				fprintf(stderr, "Cannot parse a region of the map file \"%s\"\n", filename);
+				return EXIT_FAILURE;
+			}
+			stage.milliseconds.pushBack(milliseconds);
+			if (i + 1 == options.numIterations)
+				printModelSummary(mapModel);
+		}
+		stage.peakMemory = peakMemory();
+	}
+	MapModel lastMapModel;
+	for (unsigned int parserIdx = 0; parserIdx < 3; parserIdx++)
+	{
+		const ParserType parserType = parserTypes[parserIdx];
+		if ((parserType == ParserType::Json) != isJson ||
+		    (parserType == ParserType::Dom && options.withDom == false) ||
+		    (parserType == ParserType::Stream && options.withStream == false))
+		{
+			continue;
+		}
+
+		Stage &stage = addStage(stages, parserNames[parserIdx], fileSize);
+		// With lazy decoding the parse stage only measures the time to the first frame, the layer data is decoded afterwards.
+		// The two stages alternate, so they share the same peak memory.
+		Stage *decodeStage = options.lazyDecoding ? &addStage(stages, decodeNames[parserIdx], 0) : nullptr;
+		for (unsigned int i = 0; i < options.numIterations; i++)
+		{
+			MapModel mapModel;
+			float milliseconds = 0.0f;
+			if (parseMap(parserType, mapModel, contents, buffer, filename, options.lazyDecoding, milliseconds) == false)
+			{
+				fprintf(stderr, "Cannot parse the map file \"%s\"\n", filename);
+				return EXIT_FAILURE;
+			}
+			stage.milliseconds.pushBack(milliseconds);
+			if (decodeStage)
+			{
+				const nc::TimeStamp timestamp = nc::TimeStamp::now();
+				mapModel.decodeLayers();
+				decodeStage->milliseconds.pushBack(timestamp.millisecondsSince());
+			}
+			if (i + 1 == options.numIterations)
+				lastMapModel = nctl::move(mapModel);
+		}
+		stage.peakMemory = peakMemory();
+		if (decodeStage)
+			decodeStage->peakMemory = peakMemory();
+	}
+	printModelSummary(lastMapModel);
+	printPropertyMemory(lastMapModel);
+
+	// Layers are decoded one per job, so the scaling is limited by the number of layers
+	if (options.threadSweep)
+	{
+		const ParserType parserType = isJson ? ParserType::Json : (options.withStream ? ParserType::Stream : ParserType::Dom);
+		for (unsigned int sweepIdx = 0; sweepIdx < sizeof(SweepNumThreads) / sizeof(SweepNumThreads[0]); sweepIdx++)
+		{
+			WorkerPool::setNumThreads(SweepNumThreads[sweepIdx]);
+			Stage &stage = addStage(stages, SweepStageNames[sweepIdx], 0);
+			for (unsigned int i = 0; i < options.numIterations; i++)
+			{
+				MapModel mapModel;
+				float milliseconds = 0.0f;
+				if (parseMap(parserType, mapModel, contents, buffer, filename, true, milliseconds) == false)
+				{
+					fprintf(stderr, "Cannot parse the map file \"%s\"\n", filename);
+					return EXIT_FAILURE;
+				}
+				const nc::TimeStamp timestamp = nc::TimeStamp::now();
+				mapModel.decodeLayers();
+				stage.milliseconds.pushBack(timestamp.millisecondsSince());
+			}
+			stage.peakMemory = peakMemory();
+		}
+		WorkerPool::setNumThreads(options.numThreads);
+	}
+
+	// The lists of points of polygons and polylines are parsed on their own, with the number parser and with `sscanf()`
+	if (isJson == false)
+	{
+		memcpy(buffer.data(), contents.data(), contents.size());
+		nctl::Array<char> pointChars;
+		nctl::Array<unsigned int> pointOffsets;
+		const unsigned long int numPointBytes = collectPointLists(reinterpret_cast<const char *>(buffer.data()), pointChars, pointOffsets);
+		if (pointOffsets.isEmpty() == false)
+		{
+			printf("Lists of points: %u (%.2f MiB)\n", pointOffsets.size(), numPointBytes / (1024.0f * 1024.0f));
+			const PointsFunction pointsFunctions[] = { parsePolyPointsSscanf, TmxAttributes::parsePolyPoints };
+			const char *pointsNames[] = { "Points (sscanf)", "Points" };
+			for (unsigned int functionIdx = 0; functionIdx < 2; functionIdx++)
+			{
+				Stage &stage = addStage(stages, pointsNames[functionIdx], numPointBytes);
+				for (unsigned int i = 0; i < options.numIterations; i++)
+				{
+					float milliseconds = 0.0f;
+					if (parsePointLists(pointsFunctions[functionIdx], pointChars, pointOffsets, milliseconds) == false)
+					{
+						fprintf(stderr, "Cannot parse the lists of points\n");
+						return EXIT_FAILURE;
+					}
+					stage.milliseconds.pushBack(milliseconds);
+				}
+				stage.peakMemory = peakMemory();
+			}
+		}
+	}
+
+	// The same map is generated with every encoding, to compare the cost of decoding and decompressing its layer data
+	if (options.compareEncodings && options.inputFilename != nullptr)
+		printf("The encodings can only be compared on a generated map\n");
+	else if (options.compareEncodings)
+	{
+		const ParserType parserType = options.withStream ? ParserType::Stream : ParserType::Dom;
+		for (unsigned int encodingIdx = 0; encodingIdx < sizeof(CompareEncodings) / sizeof(CompareEncodings[0]); encodingIdx++)
+		{
+			MapGenerator::Configuration config = options.generator;
+			config.encoding = CompareEncodings[encodingIdx];
+			if (MapGenerator::isSupported(config.encoding) == false)
+				continue;
+
+			nctl::String encodingFilename(256);
+			encodingFilename.format("%s.%s.tmx", filename, MapGenerator::encodingToString(config.encoding));
+			nctl::Array<unsigned char> encodingContents;
+			if (MapGenerator::generate(encodingFilename.data(), config) == false || readFile(encodingFilename.data(), encodingContents) == false)
+			{
+				fprintf(stderr, "Cannot write the map file \"%s\"\n", encodingFilename.data());
+				return EXIT_FAILURE;
+			}
+			printf("Map file \"%s\": %.2f MiB\n", encodingFilename.data(), encodingContents.size() / (1024.0f * 1024.0f));
+
+			nctl::Array<unsigned char> encodingBuffer;
+			encodingBuffer.setSize(encodingContents.size() + 1);
+			encodingBuffer[encodingContents.size()] = '\0';
+			Stage &stage = addStage(stages, CompareStageNames[encodingIdx], encodingContents.size());
+			for (unsigned int i = 0; i < options.numIterations; i++)
+			{
+				MapModel mapModel;
+				float milliseconds = 0.0f;
+				if (parseMap(parserType, mapModel, encodingContents, encodingBuffer, encodingFilename.data(), false, milliseconds) == false)
+				{
+					fprintf(stderr, "Cannot parse the map file \"%s\"\n", encodingFilename.data());
+					return EXIT_FAILURE;
+				}
+				stage.milliseconds.pushBack(milliseconds);
+			}
+			stage.peakMemory = peakMemory();
+
+			if (options.keepFiles == false)
+				remove(encodingFilename.data());
+		}
+	}
+
+	// The CSV layer data is decoded on its own, with the single pass decoder and with the reference one
+	if (isJson == false)
+	{
+		memcpy(buffer.data(), contents.data(), contents.size());
+		nctl::Array<char> csvChars;
+		nctl::Array<unsigned int> csvOffsets;
+		const unsigned long int numCsvBytes = collectCsvData(reinterpret_cast<const char *>(buffer.data()), csvChars, csvOffsets);
+		if (csvOffsets.isEmpty() == false)
+		{
+			printf("CSV layer data: %u (%.2f MiB)\n", csvOffsets.size(), numCsvBytes / (1024.0f * 1024.0f));
+			const CsvFunction csvFunctions[] = { decodeCsvReference, decodeCsv };
+			const char *csvNames[] = { "CSV (reference)", "CSV" };
+			unsigned long int checksums[2] = { 0, 0 };
+			for (unsigned int functionIdx = 0; functionIdx < 2; functionIdx++)
+			{
+				Stage &stage = addStage(stages, csvNames[functionIdx], numCsvBytes);
+				for (unsigned int i = 0; i < options.numIterations; i++)
+				{
+					float milliseconds = 0.0f;
+					if (decodeCsvData(csvFunctions[functionIdx], csvChars, csvOffsets, milliseconds, checksums[functionIdx]) == false)
+					{
+						fprintf(stderr, "Cannot decode the CSV layer data\n");
+						return EXIT_FAILURE;
+					}
+					stage.milliseconds.pushBack(milliseconds);
+					// The reference decoder is quadratic in the length of a layer, as `sscanf()` measures the rest of the string every time
+					if (milliseconds > 1000.0f)
+						break;
+				}
+				stage.peakMemory = peakMemory();
+			}
+			if (checksums[0] != checksums[1])
+			{
+				fprintf(stderr, "The CSV decoders do not agree on the layer data\n");
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	if (options.withCache)
+	{
+		// The cache is only loaded if its date is newer than the one of the map, and dates have a resolution of one second
+		const float generatedMilliseconds = generatedTime.millisecondsSince();
+		if (options.inputFilename == nullptr && generatedMilliseconds < 1000.0f)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1010 - static_cast<long int>(generatedMilliseconds)));
+
+		const nctl::String cacheFilename = MapCache::cacheFilename(filename);
+		Stage &saveStage = addStage(stages, "Cache save", 0);
+		for (unsigned int i = 0; i < options.numIterations; i++)
+		{
+			const nc::TimeStamp timestamp = nc::TimeStamp::now();
+			if (MapCache::save(lastMapModel, filename) == false)
+			{
+				fprintf(stderr, "Cannot save the map cache \"%s\"\n", cacheFilename.data());
+				return EXIT_FAILURE;
+			}
+			saveStage.milliseconds.pushBack(timestamp.millisecondsSince());
+		}
+		saveStage.peakMemory = peakMemory();
+		saveStage.numBytes = static_cast<unsigned long int>(nc::fs::fileSize(cacheFilename.data()));
+
+		Stage &loadStage = addStage(stages, "Cache load", saveStage.numBytes);
+		for (unsigned int i = 0; i < options.numIterations; i++)
+		{
+			MapModel mapModel;
+			const nc::TimeStamp timestamp = nc::TimeStamp::now();
+			if (MapCache::load(mapModel, filename) == false)
+			{
+				fprintf(stderr, "Cannot load the map cache \"%s\"\n", cacheFilename.data());
+				return EXIT_FAILURE;
+			}
+			loadStage.milliseconds.pushBack(timestamp.millisecondsSince());
+		}
+		loadStage.peakMemory = peakMemory();
+
+		if (options.keepFiles == false)
+			remove(cacheFilename.data());
+	}
+
+	printStages(stages);
+
+	if (options.inputFilename == nullptr && options.keepFiles == false)
+		remove(filename);
+
+	return EXIT_SUCCESS;
+}
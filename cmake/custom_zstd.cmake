@@ -0,0 +1,79 @@
+set(ZSTD_VERSION_TAG "v1.5.5")
+# Download release archive (TRUE) or Git repository (FALSE)
+set(ZSTD_DOWNLOAD_ARCHIVE TRUE)
+
+if(ZSTD_DOWNLOAD_ARCHIVE)
+	# Strip the initial "v" character from the version tag
+	string(REGEX MATCH "^v[0-9]" ZSTD_STRIP_VERSION ${ZSTD_VERSION_TAG})
+	if(ZSTD_STRIP_VERSION STREQUAL "")
+		set(ZSTD_VERSION_TAG_DIR ${ZSTD_VERSION_TAG})
+	else()
+		string(SUBSTRING ${ZSTD_VERSION_TAG} 1 -1 ZSTD_VERSION_TAG_DIR)
+	endif()
+
+	set(ZSTD_SOURCE_DIR_NAME zstd-${ZSTD_VERSION_TAG_DIR})
+else()
+	set(ZSTD_SOURCE_DIR_NAME zstd-src)
+endif()
+
+# Only the decompression part of the library is compiled, without the assembly Huffman decoder
+function(add_zstd_sources ZSTD_SOURCE_DIR)
+	file(GLOB ZSTD_SOURCES ${ZSTD_SOURCE_DIR}/lib/common/*.c ${ZSTD_SOURCE_DIR}/lib/decompress/*.c)
+	target_include_directories(${NCPROJECT_EXE_NAME} PRIVATE ${ZSTD_SOURCE_DIR}/lib)
+	target_sources(${NCPROJECT_EXE_NAME} PRIVATE ${ZSTD_SOURCES})
+	target_compile_definitions(${NCPROJECT_EXE_NAME} PRIVATE "WITH_ZSTD" "ZSTD_DISABLE_ASM")
+endfunction()
+
+if(ANDROID)
+	return()
+endif()
+
+if(ZSTD_DOWNLOAD_ARCHIVE AND ${CMAKE_VERSION} VERSION_GREATER_EQUAL "3.18.0")
+	if (IS_DIRECTORY ${CMAKE_BINARY_DIR}/${ZSTD_SOURCE_DIR_NAME})
+		message(STATUS "zstd release file \"${ZSTD_VERSION_TAG}\" has been already downloaded")
+		set(ZSTD_SOURCE_DIR ${CMAKE_BINARY_DIR}/${ZSTD_SOURCE_DIR_NAME})
+	else()
+		file(DOWNLOAD https://github.com/facebook/zstd/archive/${ZSTD_VERSION_TAG}.tar.gz
+			${CMAKE_BINARY_DIR}/${ZSTD_VERSION_TAG}.tar.gz STATUS result)
+
+		list(GET result 0 result_code)
+		if(result_code)
+			message(FATAL_ERROR "Cannot download zstd release file ${ZSTD_VERSION_TAG}")
+		else()
+			message(STATUS "Downloaded zstd release file \"${ZSTD_VERSION_TAG}\"")
+			file(ARCHIVE_EXTRACT INPUT ${CMAKE_BINARY_DIR}/${ZSTD_VERSION_TAG}.tar.gz DESTINATION ${CMAKE_BINARY_DIR})
+			file(REMOVE ${CMAKE_BINARY_DIR}/${ZSTD_VERSION_TAG}.tar.gz)
+		endif()
+	endif()
+
+	if (IS_DIRECTORY ${CMAKE_BINARY_DIR}/${ZSTD_SOURCE_DIR_NAME})
+		add_zstd_sources(${CMAKE_BINARY_DIR}/${ZSTD_SOURCE_DIR_NAME})
+	endif()
+else()
+	# Download zstd repository at configure time
+	configure_file(cmake/custom_zstd_download.in zstd-download/CMakeLists.txt)
+
+	execute_process(COMMAND ${CMAKE_COMMAND} -G "${CMAKE_GENERATOR}" .
+		RESULT_VARIABLE result
+		WORKING_DIRECTORY ${CMAKE_BINARY_DIR}/zstd-download
+	)
+	if(result)
+		message(STATUS "CMake step for zstd failed: ${result}")
+		set(ZSTD_ERROR TRUE)
+	endif()
+
+	execute_process(COMMAND ${CMAKE_COMMAND} --build .
+		RESULT_VARIABLE result
+		WORKING_DIRECTORY ${CMAKE_BINARY_DIR}/zstd-download
+	)
+	if(result)
+		message(STATUS "Build step for zstd failed: ${result}")
+		set(ZSTD_ERROR TRUE)
+	endif()
+
+	if(ZSTD_ERROR)
+		message(FATAL_ERROR "Cannot download zstd repository")
+	else()
+		add_zstd_sources(${CMAKE_BINARY_DIR}/${ZSTD_SOURCE_DIR_NAME})
+	endif()
+endif()
@@ -0,0 +1,75 @@
+#ifndef DATADECODER_H
+#define DATADECODER_H
+
+#include <nctl/Array.h>
+#include <ncine/Rect.h>
+#include "MapModel.h"
+
+/// The class that decodes the tile GIDs contained in the data of a Tiled layer
+class DataDecoder
+{
+  public:
+	/// The outcome of one or more decoding calls, to be logged later by the calling thread
+	/*! The decoders run on the threads of the worker pool, where logging is not allowed */
+	struct Report
+	{
+		static const unsigned int MaxMessageLength = 128;
+
+		/// The number of GIDs that have been decoded
+		unsigned int numElements;
+		/// The number of chunks at the same position as a previous one, they are not indexed
+		unsigned int numDuplicateChunks;
+		/// The first error message, empty if there was no error
+		char error[MaxMessageLength];
+		/// The first warning message, empty if there was no warning
+		char warning[MaxMessageLength];
+
+		Report();
+		/// Stores a formatted error message, unless one has already been stored
+		void setError(const char *format, ...);
+		/// Stores a formatted warning message, unless one has already been stored
+		void setWarning(const char *format, ...);
+	};
+
+	/// Decodes a string of comma separated GIDs in a single pass
+	/*! The string is scanned with SSE2 or AVX2 instructions when available.
+	 *  Anything that is not a canonical sequence of unsigned numbers separated by commas and whitespace
+	 *  is handed over to `decodeCsvReference()`, so that the result is always the same as the reference parser.
+	 *  \param expectedElements The number of GIDs to reserve space for, usually the layer width times its height */
+	static bool decodeCsv(const char *string, unsigned int expectedElements, nctl::Array<unsigned int> &tileGids, Report &report);
+	/// Decodes a string of comma separated GIDs with a reference two pass parser based on `sscanf()`
+	static bool decodeCsvReference(const char *string, nctl::Array<unsigned int> &tileGids, Report &report);
+
+	/// Decodes a base64 string into a buffer of bytes, skipping any whitespace
+	/*! Blocks of 16 characters are decoded with SSE2 or SSSE3 instructions when available.
+	 *  \param outputSize The size of the output buffer on input, the number of decoded bytes on output */
+	static bool decodeBase64(const char *string, unsigned long int length, unsigned char *output, unsigned long int &outputSize, Report &report);
+	/// Decodes a base64 string of little-endian 32 bits GIDs directly into the array
+	static bool decodeBase64(const char *string, unsigned int expectedElements, nctl::Array<unsigned int> &tileGids, Report &report);
+
+	/// Returns true if the decoder has been compiled with support for the specified compression
+	static bool isSupported(MapModel::Compression compression);
+	/// Decompresses a buffer of zlib or gzip data, detecting the format from its header
+	/*! \param outputSize The size of the output buffer on input, the number of decompressed bytes on output */
+	static bool decompressZlib(const unsigned char *input, unsigned long int inputSize, unsigned char *output, unsigned long int &outputSize, Report &report);
+	/// Decompresses a buffer containing a zstd frame
+	/*! \param outputSize The size of the output buffer on input, the number of decompressed bytes on output */
+	static bool decompressZstd(const unsigned char *input, unsigned long int inputSize, unsigned char *output, unsigned long int &outputSize, Report &report);
+	/// Decodes a base64 string of compressed GIDs and decompresses them directly into the array
+	/*! \param numElements The number of GIDs in the layer, used to size the array before decompressing */
+	static bool decodeCompressedBase64(const char *string, MapModel::Compression compression, unsigned int numElements, nctl::Array<unsigned int> &tileGids, Report &report);
+
+	/// Decodes the string of a layer or of a chunk according to the encoding and the compression of its data
+	/*! If the string cannot be decoded and no other string has been stored before, it is copied in the data.
+	 *  \param numElements The number of GIDs in the layer or in the chunk */
+	static bool decodeLayerData(MapModel::Data &data, const char *string, unsigned int numElements, nctl::Array<unsigned int> &tileGids, Report &report);
+	/// Decodes only the GIDs inside a rectangle of a layer or of a chunk, in the same way as `decodeLayerData()`
+	/*! The data is streamed without storing the GIDs outside of the rectangle and it is not read past its last row.
+	 *  \param width The width in tiles of the layer or of the chunk
+	 *  \param rect The rectangle in tiles relative to the layer or to the chunk, it should be inside of them */
+	static bool decodeLayerDataRegion(MapModel::Data &data, const char *string, unsigned int width, const nc::Recti &rect, nctl::Array<unsigned int> &tileGids, Report &report);
+	/// Returns true if at least one of the GIDs is not zero
+	static bool hasTiles(const nctl::Array<unsigned int> &tileGids);
+};
+
+#endif
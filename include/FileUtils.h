@@ -0,0 +1,23 @@
+#ifndef FILEUTILS_H
+#define FILEUTILS_H
+
+#include <nctl/String.h>
+#include <ncine/FileSystem.h>
+
+namespace nc = ncine;
+
+/// The file functions shared by the caches and the file watcher
+class FileUtils
+{
+  public:
+	/// Returns a negative value, zero or a positive value if the first date is earlier, the same or later than the second one
+	/*! Dates only have a resolution of one second. */
+	static int compareDates(const nc::fs::FileDate &first, const nc::fs::FileDate &second);
+	static inline bool isSameDate(const nc::fs::FileDate &first, const nc::fs::FileDate &second) { return compareDates(first, second) == 0; }
+
+	/// Returns the absolute path of a file, or the path itself if it cannot be resolved
+	/*! It is used as a key, so that the same file referenced from different directories is only stored once. */
+	static nctl::String cacheKey(const char *filename);
+};
+
+#endif
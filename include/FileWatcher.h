@@ -0,0 +1,77 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <nctl/Array.h>
+#include <nctl/String.h>
+#include <ncine/FileSystem.h>
+#include <ncine/TimeStamp.h>
+
+namespace nc = ncine;
+
+/// The class that detects changes to a set of files by polling their modification time and size
+/*! No operating system service is used, files are only checked once every `interval` seconds.
+ *  A change is reported when the new time and size have been seen by two consecutive checks,
+ *  so that a file is not reloaded while the program that saves it is still writing.
+ *  As modification times have a resolution of one second, two saves within the same second
+ *  that do not change the size of a file are reported as a single one. */
+class FileWatcher
+{
+  public:
+	/// The kind of file being watched, it decides what should be reloaded
+	enum class FileType : unsigned char
+	{
+		Map,
+		TileSet,
+		Template,
+		Image
+	};
+
+	/// A file that has changed since the previous report
+	struct Change
+	{
+		FileType type = FileType::Map;
+		/// The index associated with the file when it was added, like the one of its tileset
+		unsigned int index = 0;
+		/// The name of the file, valid until the watcher is cleared
+		const char *filename = nullptr;
+	};
+
+	/// The default number of seconds between two checks of the files
+	static const float DefaultInterval;
+
+	FileWatcher();
+
+	/// Starts watching a file, a file that does not exist is reported as soon as it is created
+	void add(const char *filename, FileType type, unsigned int index);
+	/// Stops watching all files
+	void clear();
+
+	/// Checks the files if the interval has elapsed, appending to the array the ones that have changed
+	/*! \returns True if at least one change has been appended */
+	bool poll(nctl::Array<Change> &changes);
+
+	/// Returns the number of files being watched
+	inline unsigned int size() const { return entries_.size(); }
+	/// Returns the name of a watched file, in the order they have been added
+	inline const char *filename(unsigned int index) const { return entries_[index].filename.data(); }
+
+	/// The number of seconds between two checks of the files
+	float interval;
+
+  private:
+	struct Entry
+	{
+		nctl::String filename;
+		FileType type = FileType::Map;
+		unsigned int index = 0;
+		nc::fs::FileDate date = {};
+		long int size = 0;
+		/// True if a new date or size has been seen and it has not been confirmed yet
+		bool isPending = false;
+	};
+
+	nctl::Array<Entry> entries_;
+	nc::TimeStamp lastPoll_;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+/// A pull JSON reader that tokenizes a mutable buffer in place
+/*! Keys and values are null-terminated and strings are unescaped directly in the buffer,
+ *  which should then outlive any pointer returned by the reader. No memory is allocated.
+ *  Containers are opened by `readValue()` and then walked with `nextKey()` or `nextElement()`. */
+class JsonStreamReader
+{
+  public:
+	enum class Type
+	{
+		Object,
+		Array,
+		String,
+		Number,
+		Boolean,
+		Null,
+		Error
+	};
+
+	JsonStreamReader(char *buffer, unsigned long int size);
+
+	/// Reads the next value, an object or an array is only opened and has to be walked or skipped
+	Type readValue();
+	/// Skips the rest of a container opened by `readValue()`, it does nothing for other types
+	bool skip(Type type);
+
+	/// Advances to the next key of the current object, returns false after its end or on errors
+	bool nextKey();
+	/// Advances to the next element of the current array, returns false after its end or on errors
+	bool nextElement();
+	/// Reads the rest of an opened array as a single comma separated text, if it only contains numbers
+	/*! On success the text is returned by `value()`, otherwise the array is left untouched. */
+	bool readNumberArray();
+
+	/// Returns the last key read by `nextKey()`
+	inline const char *key() const { return key_; }
+	/// Returns the text of the last string, number, boolean or null value
+	inline const char *value() const { return value_; }
+
+	/// Returns the description of the last error or `nullptr`
+	inline const char *errorDescription() const { return errorDescription_; }
+	/// Returns the offset in bytes from the start of the buffer of the last error
+	inline unsigned long int errorOffset() const { return errorOffset_; }
+
+  private:
+	char *const buffer_;
+	char *const end_;
+	char *pos_;
+	/// The character at the current position if it has been overwritten by the terminator of a value, or zero
+	char pendingChar_;
+
+	const char *key_;
+	const char *value_;
+
+	const char *errorDescription_;
+	unsigned long int errorOffset_;
+
+	void error(const char *description, const char *position);
+	/// Returns the next character that is not whitespace, or zero at the end of the buffer
+	char peek();
+	inline void consume()
+	{
+		pendingChar_ = '\0';
+		pos_++;
+	}
+	/// Reads a string starting at the current opening quote, unescaping it in place
+	char *readString();
+};
+
+#endif
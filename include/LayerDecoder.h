@@ -0,0 +1,68 @@
+#ifndef LAYERDECODER_H
+#define LAYERDECODER_H
+
+#include <ncine/Rect.h>
+#include "MapModel.h"
+#include "DataDecoder.h"
+
+/// The class that decodes the data of all the layers of a map in parallel, once they have been parsed
+/*! The strings are only referenced, so they should stay valid until every layer has been decoded.
+ *  Layers are referred to by index, so the array of layers can grow while they are added.
+ *  Layers can also be decoded a few at a time, when they are needed, each of them only once. */
+class LayerDecoder
+{
+  public:
+	/// Adds the data string of a layer, to be decoded according to its width, height and data attributes
+	void addLayer(unsigned int layerIndex, const char *string);
+	/// Adds the data string of the last chunk that has been added to a layer
+	void addChunk(unsigned int layerIndex, const char *string);
+
+	/// Decodes the data of every layer that is still pending as a separate job of the worker pool
+	/*! The arrays of GIDs are reserved on the calling thread before the jobs start, but each job can still resize the arrays of its own layer.
+	 *  Chunks without tiles are removed and the chunk indices are created afterwards.
+	 *  \returns False if the data of at least one layer could not be decoded */
+	bool decode(nctl::Array<MapModel::Layer> &layers);
+	/// Decodes the data of the specified layers that are still pending, in the same way as `decode()`
+	bool decode(nctl::Array<MapModel::Layer> &layers, const nctl::Array<unsigned int> &layerIndices);
+	/// Decodes only the GIDs inside a rectangle of tiles of the specified layers that are still pending
+	/*! The GIDs of a layer are stored in a single chunk that covers the part of the rectangle inside the layer,
+	 *  while the chunks of a layer in an infinite map are clipped to the rectangle or removed if they are outside of it. */
+	bool decodeRegion(nctl::Array<MapModel::Layer> &layers, const nc::Recti &rect, const nctl::Array<unsigned int> &layerIndices);
+
+	/// Returns true if the data of a layer has been added but not decoded yet
+	bool isPending(unsigned int layerIndex) const;
+	/// Returns the number of layers that have been added but not decoded yet
+	inline unsigned int numPendingLayers() const { return numPendingJobs_; }
+
+  private:
+	struct Job
+	{
+		unsigned int layerIndex = 0;
+		const char *string = nullptr;
+		/// The strings of the chunks, in the same order as the chunks of the layer
+		nctl::Array<const char *> chunkStrings;
+		bool isPending = true;
+		bool hasDecoded = false;
+		/// Filled by the worker thread and logged by the calling one once the job has finished
+		DataDecoder::Report report;
+	};
+
+	nctl::Array<Job> jobs_;
+	unsigned int numPendingJobs_ = 0;
+
+	/// Returns the job of a layer, creating it if the layer has not been added yet
+	Job &retrieveJob(unsigned int layerIndex);
+	/// Returns the index of the job of a layer, or -1 if the layer has not been added
+	int findJob(unsigned int layerIndex) const;
+	/// Appends the indices of the pending jobs of the specified layers, each of them only once
+	void findPendingJobs(const nctl::Array<unsigned int> &layerIndices, nctl::Array<unsigned int> &jobIndices) const;
+	/// Decodes the specified jobs in parallel, logs their reports, then releases all jobs if none of them is pending anymore
+	/*! \param rect The rectangle of tiles to decode, or `nullptr` to decode all the tiles of the layers */
+	bool decodeJobs(nctl::Array<MapModel::Layer> &layers, const nctl::Array<unsigned int> &jobIndices, const nc::Recti *rect);
+	/// Logs the outcome of a job that has finished
+	static void logReport(const Job &job, const MapModel::Layer &layer, bool isRegion);
+	static void decodeJob(unsigned int jobIndex, void *userData);
+	static void decodeRegionJob(unsigned int jobIndex, void *userData);
+};
+
+#endif
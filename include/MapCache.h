@@ -0,0 +1,29 @@
+#ifndef MAPCACHE_H
+#define MAPCACHE_H
+
+#include <nctl/String.h>
+
+class MapModel;
+
+/// The class that saves and loads a compiled binary version of a parsed map
+/*! The cache file is stored next to the TMX file and it is only used if it is newer than the map
+ *  and all of its external tilesets and object templates. A file with the same date, to the second,
+ *  counts as modified after the cache. Its payload is protected by a hash, and tile GID arrays are
+ *  stored raw and aligned, so that they can be copied straight from the memory-mapped file. */
+class MapCache
+{
+  public:
+	/// The version of the binary format, it should be increased every time `MapModel` changes
+	static const unsigned int Version = 8;
+	/// The extension appended to the name of the TMX file
+	static const char *Extension;
+
+	/// Returns the name of the cache file associated with a TMX file
+	static nctl::String cacheFilename(const char *tmxFilename);
+	/// Loads a map from its cache file if it exists and it is still valid
+	static bool load(MapModel &mapModel, const char *tmxFilename);
+	/// Saves a parsed map in its cache file, the data of all its layers should have been decoded
+	static bool save(const MapModel &mapModel, const char *tmxFilename);
+};
+
+#endif
@@ -79,8 +79,14 @@ class MapFactory
 
 	static const unsigned int MaxOverlayPoints = 64;
 
-	static bool instantiate(const MapModel &mapModel, const Configuration &config);
-	static bool drawObjectsWithImGui(const ncine::Camera &camera, const MapModel &mapModel, unsigned int objectGroupIdx);
+	/// Creates the scene nodes of all the visible layers by walking the draw list of the map, each layer on its own depth
+	/*! The data of visible layers that has not been decoded yet is decoded first, hidden layers are left untouched. */
+	static bool instantiate(MapModel &mapModel, const Configuration &config);
+	/// Loads again the texture of a tileset of the last instantiated map, without creating its scene nodes again
+	/*! \returns False if the image cannot be loaded or if its size is not the one of the tileset anymore */
+	static bool reloadTileSetImage(const MapModel &mapModel, const Configuration &config, unsigned int tileSetIdx);
+	/// Draws the non-tile objects of an entry of the draw list, returns false if the entry is not a visible object group
+	static bool drawObjectsWithImGui(const ncine::Camera &camera, const MapModel &mapModel, unsigned int drawEntryIdx);
 };
 
 #endif
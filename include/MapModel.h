@@ -1,21 +1,32 @@
 #ifndef MAPMODEL_H
 #define MAPMODEL_H
 
+#include <cstdint>
 #include <nctl/Array.h>
 #include <nctl/String.h>
+#include <nctl/UniquePtr.h>
+#include <nctl/HashMap.h>
 #include <ncine/Color.h>
 #include <ncine/Vector2.h>
+#include <ncine/Rect.h>
+
+#include "StringTable.h"
 
 namespace nc = ncine;
 
+class LayerDecoder;
+class MappedFile;
+
 /// The class that holds all the information contained in a Tiled map
+/*! Names, types and paths are stored once in the string table of the model and referenced by handle.
+ *  When a map is parsed with lazy decoding, the tile GIDs of its layers are only decoded by `decodeLayers()`. */
 class MapModel
 {
   public:
-	static const unsigned int MaxSourceLength = 256;
-	static const unsigned int MaxNameLength = 64;
+	/// The handle of a string in the table of the model
+	using StringId = StringTable::Id;
 
-	enum class PropertyType
+	enum class PropertyType : unsigned char
 	{
 		StringType,
 		IntType,
@@ -26,11 +37,10 @@ class MapModel
 		ObjectType
 	};
 
+	/// A property stores its value inline, string and file values are handles in the string table of the model
 	struct Property
 	{
-		static const unsigned int MaxStringLength = 1024;
-
-		char name[MaxNameLength];
+		StringId name = StringTable::EmptyId;
 		PropertyType type = PropertyType::StringType;
 		union
 		{
@@ -39,16 +49,15 @@ class MapModel
 			bool boolValue;
 			int color;
 			int object;
+			StringId string;
 		} value;
-		char string[MaxStringLength];
 
-		Property()
-		{
-			name[0] = '\0';
-			value.intValue = 0;
-			string[0] = '\0';
-		}
+		Property() { value.intValue = 0; }
+
+		/// Returns true if the value of the property is a handle in the string table
+		inline bool hasStringValue() const { return (type == PropertyType::StringType || type == PropertyType::FileType); }
 
+		inline StringId stringValue() const { return hasStringValue() ? value.string : StringTable::EmptyId; }
 		inline int intValue() const { return (type == PropertyType::IntType) ? value.intValue : 0; }
 		inline float floatValue() const { return (type == PropertyType::FloatType) ? value.floatValue : 0.0f; }
 		inline bool boolValue() const { return (type == PropertyType::BoolType) ? value.boolValue : false; }
@@ -62,7 +71,7 @@ class MapModel
 		static const unsigned int MaxFormatLength = 8;
 
 		char format[MaxFormatLength];
-		char source[MaxSourceLength];
+		StringId source = StringTable::EmptyId;
 		/// True if a transparent color has been specified in the TMX file
 		bool hasTransparency = false;
 		nc::Color trans;
@@ -91,7 +100,7 @@ class MapModel
 
 	struct Terrain
 	{
-		char name[MaxNameLength];
+		StringId name = StringTable::EmptyId;
 		int tile;
 
 		nctl::Array<Property> properties;
@@ -132,8 +141,8 @@ class MapModel
 	struct TileSet
 	{
 		unsigned int firstGid;
-		char source[MaxSourceLength];
-		char name[MaxNameLength];
+		StringId source = StringTable::EmptyId;
+		StringId name = StringTable::EmptyId;
 		int tileWidth;
 		int tileHeight;
 		int spacing = 0;
@@ -168,7 +177,6 @@ class MapModel
 	{
 		static const unsigned int MaxEncodingLength = 7; // "base64" and "csv"
 		static const unsigned int MaxCompressionLength = 5; // "gzip", "zlib", "zstd".
-		static const unsigned int MaxDataLength = 1024 * 64;
 
 		Encoding encoding;
 		Compression compression = Compression::Uncompressed;
@@ -178,10 +186,26 @@ class MapModel
 		nctl::Array<unsigned int> tileGids;
 	};
 
+	/// A chunk of tiles of a layer in an infinite map
+	struct Chunk
+	{
+		/// Horizontal position of the chunk in tiles
+		int x = 0;
+		/// Vertical position of the chunk in tiles
+		int y = 0;
+		int width = 0;
+		int height = 0;
+
+		nctl::Array<unsigned int> tileGids;
+	};
+
+	/// The hash map that associates the packed position of a chunk with its index in the array of chunks
+	using ChunkHashMap = nctl::HashMap<uint64_t, unsigned int, nctl::FNV1aHashFunc<uint64_t>>;
+
 	struct Layer
 	{
 		int id;
-		char name[MaxNameLength];
+		StringId name = StringTable::EmptyId;
 		int x = 0;
 		int y = 0;
 		int width;
@@ -191,9 +215,31 @@ class MapModel
 		nc::Color tintColor = nc::Color::White;
 		float offsetX = 0.0f;
 		float offsetY = 0.0f;
+		/// The index of the group that contains the layer, or -1 if the layer is at the root of the map
+		int groupIndex = -1;
 
 		Data data;
 		nctl::Array<Property> properties;
+
+		/// The chunks of tiles of a layer in an infinite map, empty chunks are not stored
+		/*! When only a region of the map has been decoded, the GIDs of a finite layer are stored in a single chunk as well. */
+		nctl::Array<Chunk> chunks;
+		/// The index to find a chunk from its position, only created when the layer has chunks
+		nctl::UniquePtr<ChunkHashMap> chunkIndices;
+
+		/// Creates the hash map index from the array of chunks
+		/*! It does not log, as it runs on worker threads, a chunk at the same position as a previous one is not indexed.
+		 *  \returns The number of chunks that have not been indexed because of their position */
+		unsigned int createChunkIndices();
+
+		/// Packs the position in tiles of a chunk in a key for the hash map
+		static inline uint64_t chunkKey(int x, int y) { return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y); }
+		/// Returns the chunk that starts at the specified position in tiles, or `nullptr` if there is none
+		inline const Chunk *findChunk(int x, int y) const
+		{
+			const unsigned int *index = chunkIndices ? chunkIndices->find(chunkKey(x, y)) : nullptr;
+			return index ? &chunks[*index] : nullptr;
+		}
 	};
 
 	enum class HorizontalAlign
@@ -216,7 +262,7 @@ class MapModel
 		static const unsigned int MaxDataLength = 256;
 
 		char data[MaxDataLength];
-		char fontFamily[MaxNameLength];
+		StringId fontFamily = StringTable::EmptyId;
 		int pixelSize = 16;
 		bool wrap = false;
 		nc::Color color = nc::Color::Black;
@@ -229,7 +275,7 @@ class MapModel
 		VerticalAlign vAlign = VerticalAlign::Top;
 	};
 
-	enum class ObjectType
+	enum class ObjectType : unsigned char
 	{
 		Tile,
 		Rectangle,
@@ -240,13 +286,26 @@ class MapModel
 		Text
 	};
 
-	struct Object
+	/// The flags of the object fields that an instance specifies instead of inheriting them from its template
+	struct ObjectOverride
 	{
-		static const unsigned int MaxTypeLength = 256;
+		static const unsigned char Name = 0x01;
+		static const unsigned char Type = 0x02;
+		static const unsigned char Width = 0x04;
+		static const unsigned char Height = 0x08;
+		static const unsigned char Rotation = 0x10;
+		static const unsigned char Gid = 0x20;
+		static const unsigned char Visible = 0x40;
+		/// Set when resolving an instance that has its own shape, otherwise its points and text are the ones of the template
+		static const unsigned char Shape = 0x80;
+	};
 
+	/// A single object as it is parsed, before being appended to the arrays of its group
+	struct Object
+	{
 		int id;
-		char name[MaxNameLength];
-		char type[MaxTypeLength];
+		StringId name = StringTable::EmptyId;
+		StringId type = StringTable::EmptyId;
 		float x = 0.0f;
 		float y = 0.0f;
 		float width = 0.0f;
@@ -254,14 +313,95 @@ class MapModel
 		float rotation = 0.0f;
 		unsigned int gid = 0;
 		bool visible = true;
-		char templateFile[MaxSourceLength];
+		StringId templateFile = StringTable::EmptyId;
+		/// The `ObjectOverride` flags of the fields that have been specified
+		unsigned char overrides = 0;
 
 		ObjectType objectType = ObjectType::Tile;
-		nctl::Array<nc::Vector2i> points;
+		nctl::Array<nc::Vector2f> points;
 		struct Text text;
 		nctl::Array<Property> properties;
 	};
 
+	/// An object template loaded from a TX file, shared by all the instances that reference it
+	struct ObjectTemplate
+	{
+		/// The path of the template file, as referenced by the instances
+		StringId source = StringTable::EmptyId;
+		/// The external tileset of a tile template, its path is relative to the template file
+		StringId tileSetSource = StringTable::EmptyId;
+		unsigned int tileSetFirstGid = 0;
+		Object object;
+	};
+
+	/// The data of an object that is only needed when inspecting it
+	struct ObjectDetails
+	{
+		int id;
+		StringId name = StringTable::EmptyId;
+		StringId type = StringTable::EmptyId;
+		StringId templateFile = StringTable::EmptyId;
+		/// The `ObjectOverride` flags of the fields that have not been inherited from the template
+		unsigned char overrides = 0;
+		/// The index of the template in the map, or -1 if the object is not a template instance
+		/*! Only the properties of the instance are stored with the object, the other ones are in the template. */
+		int templateIndex = -1;
+
+		/// The range of the points of a polygon or a polyline in the shared array of the group
+		/*! It is empty for an instance with the shape of its template, as is the text index. */
+		unsigned int firstPoint = 0;
+		unsigned int numPoints = 0;
+		/// The index of the text in the shared array of the group, or -1 if the object is not a text
+		int textIndex = -1;
+		/// The range of the properties in the shared array of the group
+		unsigned int firstProperty = 0;
+		unsigned int numProperties = 0;
+	};
+
+	/// The objects of a group stored as a structure of arrays, all indexed by object
+	/*! The arrays read when drawing or instantiating objects are kept apart from the rest,
+	 *  so that a loop over the objects of a big group only touches contiguous memory. */
+	struct ObjectArray
+	{
+		nctl::Array<nc::Vector2f> positions;
+		nctl::Array<nc::Vector2f> sizes;
+		nctl::Array<float> rotations;
+		nctl::Array<unsigned int> gids;
+		nctl::Array<ObjectType> objectTypes;
+		nctl::Array<bool> visible;
+
+		nctl::Array<ObjectDetails> details;
+		/// The points of all polygons and polylines, relative to the position of their object
+		nctl::Array<nc::Vector2f> points;
+		nctl::Array<Text> texts;
+		nctl::Array<Property> properties;
+
+		inline unsigned int size() const { return objectTypes.size(); }
+		inline bool isEmpty() const { return objectTypes.isEmpty(); }
+
+		/// Reserves space for a number of objects in all the per-object arrays
+		void setCapacity(unsigned int capacity);
+		/// Appends an object, copying its points, text and properties into the shared arrays
+		void append(const Object &object);
+		/// Shrinks all arrays to their size once the group has been parsed
+		void shrinkToFit();
+		/// Returns true if all arrays have the same size and every range is inside its shared array
+		bool isConsistent() const;
+
+		/// Returns true if an object is a template instance that has the points and text of its template
+		inline bool hasTemplateShape(unsigned int index) const
+		{
+			return (details[index].templateIndex >= 0 && (details[index].overrides & ObjectOverride::Shape) == 0);
+		}
+
+		/// Returns the points of an object, looking them up in the templates of the map for an instance with the shape of its template
+		const nc::Vector2f *objectPoints(unsigned int index, const nctl::Array<ObjectTemplate> &templates) const;
+		unsigned int numObjectPoints(unsigned int index, const nctl::Array<ObjectTemplate> &templates) const;
+		inline const Property *objectProperties(unsigned int index) const { return properties.data() + details[index].firstProperty; }
+		/// Returns the text of an object, or `nullptr` if it is not a text, looking it up in the same way as the points
+		const Text *objectText(unsigned int index, const nctl::Array<ObjectTemplate> &templates) const;
+	};
+
 	enum class DrawOrder
 	{
 		Index,
@@ -271,7 +411,7 @@ class MapModel
 	struct ObjectGroup
 	{
 		int id;
-		char name[MaxNameLength];
+		StringId name = StringTable::EmptyId;
 		nc::Color color = nc::Color(0xa0a0a4);
 		int x = 0;
 		int y = 0;
@@ -283,15 +423,17 @@ class MapModel
 		float offsetX = 0.0f;
 		float offsetY = 0.0f;
 		DrawOrder drawOrder;
+		/// The index of the group that contains the layer, or -1 if the layer is at the root of the map
+		int groupIndex = -1;
 
-		nctl::Array<Object> objects;
+		ObjectArray objects;
 		nctl::Array<Property> properties;
 	};
 
 	struct ImageLayer
 	{
 		int id;
-		char name[MaxNameLength];
+		StringId name = StringTable::EmptyId;
 		float offsetX = 0.0f;
 		float offsetY = 0.0f;
 		int x = 0;
@@ -299,11 +441,48 @@ class MapModel
 		float opacity = 1.0f;
 		bool visible = true;
 		nc::Color tintColor = nc::Color::White;
+		/// The index of the group that contains the layer, or -1 if the layer is at the root of the map
+		int groupIndex = -1;
 
 		Image image;
 		nctl::Array<Property> properties;
 	};
 
+	/// A group of layers, its offset, opacity and visibility apply to all the layers and groups inside it
+	struct Group
+	{
+		int id;
+		StringId name = StringTable::EmptyId;
+		float offsetX = 0.0f;
+		float offsetY = 0.0f;
+		float opacity = 1.0f;
+		bool visible = true;
+		nc::Color tintColor = nc::Color::White;
+		/// The index of the parent group, always smaller than the index of the group, or -1 for a group at the root of the map
+		int parentIndex = -1;
+
+		nctl::Array<Property> properties;
+	};
+
+	enum class LayerType : unsigned char
+	{
+		TileLayer,
+		ObjectGroup,
+		ImageLayer
+	};
+
+	/// A layer in render order, with the values of its groups already applied
+	struct DrawEntry
+	{
+		LayerType type = LayerType::TileLayer;
+		/// The index of the layer in the array of its type
+		unsigned int index = 0;
+		float offsetX = 0.0f;
+		float offsetY = 0.0f;
+		float opacity = 1.0f;
+		bool visible = true;
+	};
+
 	enum class Orientation
 	{
 		Orthogonal,
@@ -358,20 +537,73 @@ class MapModel
 		nctl::Array<ObjectGroup> objectGroups;
 		nctl::Array<ImageLayer> imageLayers;
 		nctl::Array<Property> properties;
+		/// The object templates referenced by the objects of the map
+		nctl::Array<ObjectTemplate> templates;
+		/// The groups of layers, a parent group always comes before its children
+		nctl::Array<Group> groups;
+		/// All the layers of any type, in the order they should be drawn
+		nctl::Array<DrawEntry> drawList;
+
+		/// Appends a layer at the end of the draw list
+		void addDrawEntry(LayerType type, unsigned int index);
+		/// Applies to every entry of the draw list the offset, opacity and visibility of its layer and of all its groups
+		void accumulateGroupValues();
+		/// Returns true if every entry and every group index refers to an existing element
+		bool hasValidDrawList() const;
 	};
 
+	MapModel();
+	~MapModel();
+	MapModel(MapModel &&other);
+	MapModel &operator=(MapModel &&other);
+
 	void reset();
 
+	/// Interns the names and the string values of some properties in another table, replacing their handles
+	static void reinternProperties(nctl::Array<Property> &properties, const StringTable &srcStrings, StringTable &destStrings);
+
 	inline const Map &map() const { return map_; }
 	inline Map &map() { return map_; }
 
+	inline const StringTable &strings() const { return strings_; }
+	inline StringTable &strings() { return strings_; }
+	/// Returns the string associated with a handle of this model
+	inline const char *string(StringId id) const { return strings_.string(id); }
+
 	inline const nctl::String &tmxDirName() const { return tmxDirName_; }
 	inline nctl::String &tmxDirName() { return tmxDirName_; }
 	inline const nctl::String &tsxDirName() const { return tmxDirName_; }
 	inline nctl::String &tsxDirName() { return tmxDirName_; }
 
+	/// Takes the data of the layers that have been parsed but not decoded yet
+	/*! Their strings should stay valid until they are decoded, `setSourceFile()` can be used to keep them alive. */
+	void setPendingLayers(nctl::UniquePtr<LayerDecoder> layerDecoder);
+	/// Takes the file that contains the data strings of the pending layers, it is closed once all of them are decoded
+	void setSourceFile(nctl::UniquePtr<MappedFile> sourceFile);
+	/// Returns true if the data of at least one layer has not been decoded yet
+	bool hasPendingLayers() const;
+	/// Returns true if the data of a layer has not been decoded yet
+	bool isLayerPending(unsigned int layerIndex) const;
+	/// Decodes in parallel the data of the specified layers that have not been decoded yet
+	/*! \returns False if the data of at least one of the layers could not be decoded */
+	bool decodeLayers(const nctl::Array<unsigned int> &layerIndices);
+	/// Decodes in parallel the data of all the layers that have not been decoded yet
+	bool decodeLayers();
+	/// Decodes only the GIDs inside a rectangle of tiles of the specified layers, the other layers are left without tiles
+	/*! The model is partial afterwards, its layers are never decoded in full and it cannot be cached.
+	 *  \returns False if the data of at least one of the layers could not be decoded */
+	bool decodeRegion(const nc::Recti &rect, const nctl::Array<unsigned int> &layerIndices);
+	/// Returns true if only a region of the map has been decoded
+	inline bool isPartial() const { return region_.w > 0 && region_.h > 0; }
+	/// Returns the rectangle of tiles that has been decoded, or an empty one if the map has been decoded in full
+	inline const nc::Recti &region() const { return region_; }
+
   private:
 	Map map_;
+	StringTable strings_;
+	nctl::UniquePtr<LayerDecoder> layerDecoder_;
+	nctl::UniquePtr<MappedFile> sourceFile_;
+	nc::Recti region_;
 	nctl::String tmxDirName_;
 	nctl::String tsxDirName_; // TODO: inside tileset
 };
@@ -0,0 +1,42 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <nctl/UniquePtr.h>
+
+/// The contents of a file in a writable buffer, suitable for in-situ parsing
+/*! On Linux the file is memory-mapped with a private copy-on-write mapping, so that
+ *  only the modified pages are copied and the file itself is never changed.
+ *  On other platforms, or if the mapping fails, the file is read into a heap buffer. */
+class MappedFile
+{
+  public:
+	MappedFile();
+	~MappedFile();
+
+	/// Maps or reads the specified file, closing the previous one
+	/*! A file whose contents are kept after parsing should not be mapped, as another process could truncate it in the meantime. */
+	bool open(const char *filename, bool canMap = true);
+	/// Unmaps the file or frees its buffer
+	void close();
+
+	inline unsigned char *data() { return data_; }
+	inline unsigned long int size() const { return size_; }
+	/// Returns true if the file is memory-mapped instead of being read into a buffer
+	inline bool isMapped() const { return isMapped_; }
+
+  private:
+	unsigned char *data_;
+	unsigned long int size_;
+	bool isMapped_;
+	nctl::UniquePtr<unsigned char[]> buffer_;
+
+	bool map(const char *filename);
+	bool read(const char *filename);
+
+	/// Deleted copy constructor
+	MappedFile(const MappedFile &) = delete;
+	/// Deleted assignment operator
+	MappedFile &operator=(const MappedFile &) = delete;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef NUMBERPARSER_H
+#define NUMBERPARSER_H
+
+/// The locale-independent functions that convert text to numbers, in the style of `std::from_chars()`
+/*! Every function parses a number at the beginning of a null-terminated string, without skipping whitespace,
+ *  and returns a pointer to the first character after it, or the string itself if no number could be parsed.
+ *  The value is only written on success, integers that do not fit in their type are clamped to its range. */
+class NumberParser
+{
+  public:
+	/// Parses an optionally signed integer in base 10 or 16, without any prefix
+	static const char *parseInt(const char *string, int &value, int base = 10);
+	/// Parses an unsigned integer in base 10 or 16, without any prefix or sign
+	static const char *parseUint(const char *string, unsigned int &value, int base = 10);
+	/// Parses at most `maxDigits` hexadecimal digits, like the `%8x` conversion of `sscanf()` does for a width of eight
+	static const char *parseHex(const char *string, unsigned int maxDigits, unsigned int &value);
+	/// Parses an optionally signed decimal number with an optional fractional part and exponent, always with a dot as separator
+	/*! The result is correctly rounded when both the digits and the power of ten are exact in a float, like for
+	 *  most numbers written by Tiled, otherwise it goes through a double and it is within one unit in the last place. */
+	static const char *parseFloat(const char *string, float &value);
+};
+
+#endif
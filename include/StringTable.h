@@ -0,0 +1,58 @@
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include <cstdint>
+#include <nctl/Array.h>
+
+/// A table that stores every distinct string once and references it with a 32 bits handle
+/*! Handles are only meaningful for the table that returned them, the empty string always has the zero handle.
+ *  A pointer returned by `string()` is invalidated by the next call to `intern()`. */
+class StringTable
+{
+  public:
+	using Id = uint32_t;
+	static const Id EmptyId = 0;
+
+	StringTable();
+
+	/// Returns the handle of a string, adding it to the table if it is not already there
+	Id intern(const char *string);
+	/// Returns the handle of the first `length` characters of a string, adding them to the table if needed
+	Id intern(const char *string, unsigned int length);
+	/// Returns the handle of a string of another table, adding it to this table if needed
+	inline Id intern(const StringTable &other, Id id) { return intern(other.string(id), other.length(id)); }
+	/// Returns the handle of a string without adding it, or `EmptyId` if it is not in the table
+	Id find(const char *string) const;
+
+	/// Returns the string associated with a handle, or an empty string if the handle is not valid
+	const char *string(Id id) const;
+	/// Returns the length of the string associated with a handle
+	unsigned int length(Id id) const;
+
+	/// Returns the number of strings in the table, including the empty one
+	inline unsigned int size() const { return offsets_.size(); }
+	/// Returns the number of bytes used by the characters of all strings, terminators included
+	inline unsigned int numChars() const { return chars_.size(); }
+	/// Returns the number of bytes allocated by the table, including the unused capacity of its arrays
+	inline unsigned long int numAllocatedBytes() const
+	{
+		return chars_.capacity() + (offsets_.capacity() + slots_.capacity()) * sizeof(uint32_t);
+	}
+
+	/// Removes all strings except the empty one
+	void clear();
+
+  private:
+	/// All the strings one after the other, each with its terminator
+	nctl::Array<char> chars_;
+	/// The offset of every string inside `chars_`, indexed by handle
+	nctl::Array<uint32_t> offsets_;
+	/// The open addressing index of the strings, every slot contains a handle plus one or zero if it is empty
+	nctl::Array<uint32_t> slots_;
+
+	unsigned int findSlot(const char *string, unsigned int length) const;
+	void rehash(unsigned int numSlots);
+	static uint32_t hash(const char *string, unsigned int length);
+};
+
+#endif
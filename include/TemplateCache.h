@@ -0,0 +1,41 @@
+#ifndef TEMPLATECACHE_H
+#define TEMPLATECACHE_H
+
+#include "MapModel.h"
+
+/// The process-wide cache of object templates parsed from TX files
+/*! Entries are keyed by the absolute path of the template file and are only returned
+ *  if its modification time and size have not changed since it was parsed.
+ *  Every entry has its own string table, strings are interned again in the table of the map when retrieved. */
+class TemplateCache
+{
+  public:
+	/// The maximum number of templates in the cache, it is emptied when full
+	static const unsigned int Capacity = 128;
+
+	/// The function that parses a template file
+	using ParseFunction = bool (*)(const char *filename, MapModel::ObjectTemplate &objectTemplate, StringTable &strings);
+
+	/// Loads every template referenced by the objects of a map once, then applies it to its instances
+	/*! Templates are added to the map and their GIDs are remapped to the tilesets of the map.
+	 *  The fields that an instance has not overridden are copied from its template,
+	 *  while the template properties are not, as they can be accessed through the template index. */
+	static bool resolve(MapModel &mapModel, ParseFunction parseFunction);
+
+	/// Copies the cached template parsed from the specified file, if it is still valid
+	/*! The `source` field is left untouched as it depends on the map. */
+	static bool retrieve(const char *filename, MapModel::ObjectTemplate &objectTemplate, StringTable &strings);
+	/// Adds or replaces the template parsed from the specified file, its handles refer to the specified string table
+	static void insert(const char *filename, const MapModel::ObjectTemplate &objectTemplate, const StringTable &strings);
+	/// Removes all templates from the cache
+	static void clear();
+
+	/// Returns the number of templates in the cache
+	static unsigned int size();
+	/// Returns the number of lookups that found a valid template since the cache was created
+	static unsigned int numHits();
+	/// Returns the number of lookups that did not find a valid template since the cache was created
+	static unsigned int numMisses();
+};
+
+#endif
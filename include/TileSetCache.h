@@ -0,0 +1,42 @@
+#ifndef TILESETCACHE_H
+#define TILESETCACHE_H
+
+#include "MapModel.h"
+
+/// The process-wide cache of tilesets parsed from external TSX files
+/*! Entries are keyed by the absolute path of the TSX file and are only returned
+ *  if its modification time and size have not changed since it was parsed.
+ *  Every entry has its own string table, strings are interned again in the table of the map when retrieved. */
+class TileSetCache
+{
+  public:
+	/// The maximum number of tilesets in the cache, it is emptied when full
+	static const unsigned int Capacity = 128;
+
+	/// The function that parses the contents of a TSX file into a tileset, it is called concurrently on different tilesets and string tables
+	/*! It runs on a worker thread, so it should not log but describe a failure in the error string, whose capacity is already reserved. */
+	using ParseFunction = bool (*)(const char *filename, unsigned char *bufferPtr, unsigned long int bufferSize, MapModel::TileSet &tileSet, StringTable &strings, nctl::String &error);
+
+	/// Retrieves the external tilesets of a map from the cache, parsing in parallel the ones that are missing
+	/*! Tilesets without a source are left untouched. The newly parsed ones are added to the cache afterwards.
+	 *  The files are opened and the errors are logged by the calling thread, the worker threads only parse their contents.
+	 *  \param strings The string table of the map, it is only modified by the calling thread */
+	static bool loadExternal(nctl::Array<MapModel::TileSet> &tileSets, StringTable &strings, const nctl::String &tmxDirName, nctl::String &tsxDirName, ParseFunction parseFunction);
+
+	/// Copies the cached tileset parsed from the specified file, if it is still valid
+	/*! The `firstGid` and `source` fields are left untouched as they depend on the map. */
+	static bool retrieve(const char *filename, MapModel::TileSet &tileSet, StringTable &strings);
+	/// Adds or replaces the tileset parsed from the specified file, its handles refer to the specified string table
+	static void insert(const char *filename, const MapModel::TileSet &tileSet, const StringTable &strings);
+	/// Removes all tilesets from the cache
+	static void clear();
+
+	/// Returns the number of tilesets in the cache
+	static unsigned int size();
+	/// Returns the number of lookups that found a valid tileset since the cache was created
+	static unsigned int numHits();
+	/// Returns the number of lookups that did not find a valid tileset since the cache was created
+	static unsigned int numMisses();
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef TMJPARSER_H
+#define TMJPARSER_H
+
+#include "MapModel.h"
+
+/// The class that parses a JSON Tiled map
+/*! The map model is filled while the file is being tokenized in place, in the same way as the XML parsers. */
+class TmjParser
+{
+  public:
+	/// Parses a map from a buffer that is modified in place
+	/*! \param lazyDecoding Leaves the layer data to be decoded by `MapModel::decodeLayers()`, the buffer should stay valid until then */
+	static bool loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize, bool lazyDecoding = false);
+	/// Parses a map from a file, with lazy decoding the model keeps the contents of the file until all layers are decoded
+	static bool loadFromFile(MapModel &mapModel, const char *filename, bool lazyDecoding = false);
+	/// Parses the contents of an external tileset in the JSON or in the XML format, depending on the file extension
+	/*! It does not log, a failure is described in the error string. */
+	static bool loadTileSetFromMemory(const char *filename, unsigned char *bufferPtr, unsigned long int bufferSize, MapModel::TileSet &tileSet, StringTable &strings, nctl::String &error);
+	/// Parses an object template in the JSON or in the XML format, depending on the file extension
+	static bool loadTemplateFile(const char *filename, MapModel::ObjectTemplate &objectTemplate, StringTable &strings);
+};
+
+#endif
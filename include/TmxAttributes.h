@@ -0,0 +1,50 @@
+#ifndef TMXATTRIBUTES_H
+#define TMXATTRIBUTES_H
+
+#include "MapModel.h"
+
+/// The functions that apply the value of a single TMX attribute to the map model
+/*! They are shared by all parser backends, so that a map is always parsed in the same way.
+ *  Attribute names are resolved with a single probe in a perfect hash table, built from the names at startup, before dispatching.
+ *  Names, types and paths are interned in the string table that is passed along with the model.
+ *  Every `apply` function returns false if the attribute name is not recognized. */
+class TmxAttributes
+{
+  public:
+	static bool applyMap(MapModel::Map &map, const char *name, const char *value);
+	/// Applies the attributes of both the map tileset element and the external TSX file
+	static bool applyTileSet(MapModel::TileSet &tileSet, StringTable &strings, const char *name, const char *value);
+	static bool applyImage(MapModel::Image &image, StringTable &strings, const char *name, const char *value);
+	static bool applyTileOffset(MapModel::TileOffset &tileOffset, const char *name, const char *value);
+	static bool applyGrid(MapModel::Grid &grid, const char *name, const char *value);
+	static bool applyTerrain(MapModel::Terrain &terrain, StringTable &strings, const char *name, const char *value);
+	static bool applyTile(MapModel::Tile &tile, const char *name, const char *value);
+	static bool applyFrame(MapModel::Frame &frame, const char *name, const char *value);
+	static bool applyLayer(MapModel::Layer &layer, StringTable &strings, const char *name, const char *value);
+	static bool applyData(MapModel::Data &data, const char *name, const char *value);
+	static bool applyChunk(MapModel::Chunk &chunk, const char *name, const char *value);
+	static bool applyObjectGroup(MapModel::ObjectGroup &objectGroup, StringTable &strings, const char *name, const char *value);
+	/// Objects without a `gid` attribute should be initialized as rectangles before applying attributes
+	static bool applyObject(MapModel::Object &object, StringTable &strings, const char *name, const char *value);
+	static bool applyText(MapModel::Text &text, StringTable &strings, const char *name, const char *value);
+	static bool applyImageLayer(MapModel::ImageLayer &imageLayer, StringTable &strings, const char *name, const char *value);
+	static bool applyGroup(MapModel::Group &group, StringTable &strings, const char *name, const char *value);
+	/// Applies the name and the type of a property, the value should be applied afterwards with `applyPropertyValue()`
+	static bool applyProperty(MapModel::Property &property, StringTable &strings, const char *name, const char *value);
+	/// Applies the value of a property according to its type, interning string and file values
+	static void applyPropertyValue(MapModel::Property &property, StringTable &strings, const char *value);
+
+	/// Parses a list of space separated points with comma separated floating point coordinates
+	static bool parsePolyPoints(const char *string, nctl::Array<nc::Vector2f> &points);
+
+	/// Converts a string to an integer in decimal or hexadecimal form, returning zero on failure
+	static int toInt(const char *value);
+	/// Converts a string to an unsigned integer in decimal or hexadecimal form, returning zero on failure
+	static unsigned int toUint(const char *value);
+	/// Converts a string to a floating point number regardless of the locale, returning zero on failure
+	static float toFloat(const char *value);
+	/// Returns true if the string starts with '1', 't', 'T', 'y' or 'Y'
+	static bool toBool(const char *value);
+};
+
+#endif
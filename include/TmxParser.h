@@ -1,6 +1,10 @@
 #ifndef TMXPARSER_H
 #define TMXPARSER_H
 
+#include <nctl/Array.h>
+#include <nctl/String.h>
+#include <ncine/Rect.h>
+
 namespace nc = ncine;
 
 class MapModel;
@@ -9,8 +13,33 @@ class MapModel;
 class TmxParser
 {
   public:
-	static bool loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize);
-	static bool loadFromFile(MapModel &mapModel, const char *filename);
+	enum class Backend
+	{
+		/// Builds a pugixml document of the whole file and then walks it
+		Dom,
+		/// Fills the map model while the file is being tokenized, without building a document
+		Stream
+	};
+
+	/// The tiles and the layers to decode when only a region of a map is needed
+	struct Region
+	{
+		/// The rectangle of tiles to decode, in map coordinates
+		nc::Recti rect;
+		/// The names of the tile layers to decode, all of them when empty
+		nctl::Array<nctl::String> layerNames;
+	};
+
+	/// Parses a map from a buffer that is modified in place
+	/*! \param lazyDecoding Leaves the layer data to be decoded by `MapModel::decodeLayers()`, the buffer should stay valid until then */
+	static bool loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize, Backend backend = Backend::Dom, bool lazyDecoding = false);
+	/// Parses a map from a file, with lazy decoding the model keeps the contents of the file until all layers are decoded
+	static bool loadFromFile(MapModel &mapModel, const char *filename, Backend backend = Backend::Dom, bool lazyDecoding = false);
+	/// Parses a map decoding only the GIDs inside a rectangle of tiles of some of its layers
+	/*! The rest of the layer data is skipped without being stored, the other layers are left without tiles.
+	 *  The tiles are stored as chunks and the model is partial, as explained by `MapModel::decodeRegion()`. */
+	static bool loadRegionFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize, const Region &region, Backend backend = Backend::Dom);
+	static bool loadRegionFromFile(MapModel &mapModel, const char *filename, const Region &region, Backend backend = Backend::Dom);
 };
 
 #endif
@@ -0,0 +1,22 @@
+#ifndef TMXSTREAMPARSER_H
+#define TMXSTREAMPARSER_H
+
+#include "MapModel.h"
+
+/// The class that parses an XML Tiled map while it is being tokenized
+/*! The map model is filled as soon as elements are read, without building a document.
+ *  Auxiliary memory does not depend on the size of the file, which is modified in place. */
+class TmxStreamParser
+{
+  public:
+	/// Parses a map from a buffer that is modified in place
+	/*! \param lazyDecoding Leaves the layer data to be decoded by `MapModel::decodeLayers()`, the buffer should stay valid until then */
+	static bool loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize, bool lazyDecoding = false);
+	/// Parses the contents of an external TSX file into a tileset, it can be called concurrently on different tilesets and string tables
+	/*! It does not log, a failure is described in the error string. */
+	static bool loadTileSetFromMemory(const char *filename, unsigned char *bufferPtr, unsigned long int bufferSize, MapModel::TileSet &tileSet, StringTable &strings, nctl::String &error);
+	/// Parses a TX object template file
+	static bool loadTemplateFile(const char *filename, MapModel::ObjectTemplate &objectTemplate, StringTable &strings);
+};
+
+#endif
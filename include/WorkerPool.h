@@ -0,0 +1,25 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+/// A small pool of threads that processes a number of independent jobs
+/*! The threads only live for the duration of a `run()` call and pick the next job index from a shared counter.
+ *  Jobs are run serially on the calling thread when threads are not available. */
+class WorkerPool
+{
+  public:
+	/// The function called for every job, it should only access data that belongs to its job index
+	using JobFunction = void (*)(unsigned int jobIndex, void *userData);
+
+	/// The maximum number of threads used by a single run
+	static const unsigned int MaxThreads = 16;
+
+	/// Runs the function for every job index and returns when all of them have been processed
+	static void run(unsigned int numJobs, JobFunction function, void *userData);
+	/// Returns the number of threads that a run with enough jobs would use
+	static unsigned int numThreads();
+	/// Sets the number of threads used by the next runs, zero to use the hardware concurrency
+	/*! The value is clamped to `MaxThreads` and it can exceed the hardware concurrency, for scaling measurements. */
+	static void setNumThreads(unsigned int numThreads);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef XMLSTREAMREADER_H
+#define XMLSTREAMREADER_H
+
+/// A pull XML reader that tokenizes a mutable buffer in place
+/*! Names, attribute values and text are null-terminated and have their entities decoded
+ *  directly in the buffer, which should then outlive any pointer returned by the reader.
+ *  The only auxiliary memory is a fixed stack of open elements and the attributes of the current one.
+ *  Comments, processing instructions and the document type declaration are skipped. */
+class XmlStreamReader
+{
+  public:
+	static const unsigned int MaxAttributes = 32;
+	static const unsigned int MaxDepth = 64;
+
+	enum class Event
+	{
+		StartElement,
+		EndElement,
+		Text,
+		EndDocument,
+		Error
+	};
+
+	struct Attribute
+	{
+		const char *name;
+		const char *value;
+	};
+
+	XmlStreamReader(char *buffer, unsigned long int size);
+
+	/// Advances to the next event, an empty element generates both a start and an end event
+	Event next();
+	/// Consumes events until the end of the current element, to be called after a start event
+	bool skipElement();
+
+	/// Returns true if the current element has the specified name, valid after a start or an end event
+	bool isElement(const char *name) const;
+	/// Returns the number of elements that are open, including the current one after a start event
+	inline unsigned int depth() const { return depth_; }
+
+	inline unsigned int numAttributes() const { return numAttributes_; }
+	inline const Attribute &attribute(unsigned int index) const { return attributes_[index]; }
+	/// Returns the value of the attribute of the current element with the specified name, or `nullptr`
+	const char *attributeValue(const char *name) const;
+
+	/// Returns the null-terminated text, valid after a text event
+	inline const char *text() const { return text_; }
+
+	/// Returns the description of the last error or `nullptr`
+	inline const char *errorDescription() const { return errorDescription_; }
+	/// Returns the offset in bytes from the start of the buffer of the last error
+	inline unsigned long int errorOffset() const { return errorOffset_; }
+
+  private:
+	struct ElementName
+	{
+		const char *name;
+		unsigned int length;
+	};
+
+	char *const buffer_;
+	char *const end_;
+	char *pos_;
+	/// True if the character at the current position was a '<' overwritten by the terminator of a text
+	bool tagPending_;
+	/// True if the current element was empty and its end event has still to be generated
+	bool endPending_;
+
+	ElementName elementStack_[MaxDepth];
+	unsigned int depth_;
+	ElementName current_;
+
+	Attribute attributes_[MaxAttributes];
+	unsigned int numAttributes_;
+	const char *text_;
+
+	const char *errorDescription_;
+	unsigned long int errorOffset_;
+
+	Event error(const char *description, const char *position);
+	/// Moves the current position after the specified terminator, returns false if it is not found
+	bool skipAfter(const char *terminator);
+	/// Skips a document type declaration, including its internal subset
+	bool skipDoctype();
+	Event parseStartElement(char *name);
+	Event parseEndElement(char *name);
+};
+
+#endif
@@ -0,0 +1,1271 @@
+#include <cstdint>
+#include <cstdarg> // for `va_list`
+#include <cstdio> // for `sscanf()` and `vsnprintf()`
+#include <cstring> // for `strlen()` and `memcpy()`
+
+#if defined(__AVX2__)
+	#define WITH_AVX2_DECODER
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+	#define WITH_SSSE3_DECODER
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define WITH_SSE2_DECODER
+#endif
+
+#if defined(WITH_AVX2_DECODER)
+	#include <immintrin.h>
+#elif defined(WITH_SSSE3_DECODER)
+	#include <tmmintrin.h>
+#elif defined(WITH_SSE2_DECODER)
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#ifdef WITH_ZLIB
+	#include <zlib.h>
+#endif
+#ifdef WITH_ZSTD
+	// Needed for `ZSTD_d_stableOutBuffer`, the library is always compiled together with the viewer
+	#define ZSTD_STATIC_LINKING_ONLY
+	#include <zstd.h>
+	#include <zstd_errors.h>
+#endif
+
+#include <nctl/CString.h>
+#include <nctl/UniquePtr.h>
+#include "DataDecoder.h"
+#include "NumberParser.h"
+
+namespace {
+
+/// The maximum number of digits that is accumulated without checking for an overflow
+const unsigned int MaxGidDigits = 10;
+
+inline bool isDigit(char c)
+{
+	return (static_cast<unsigned char>(c - '0') < 10);
+}
+
+inline bool isWhitespace(char c)
+{
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+}
+
+#if defined(WITH_AVX2_DECODER) || defined(WITH_SSE2_DECODER)
+
+inline unsigned int countTrailingZeros(uint32_t mask)
+{
+	#if defined(_MSC_VER)
+	unsigned long index = 0;
+	_BitScanForward(&index, mask);
+	return static_cast<unsigned int>(index);
+	#else
+	return static_cast<unsigned int>(__builtin_ctz(mask));
+	#endif
+}
+
+/// Returns a mask with the lowest `numBits` bits set
+inline uint32_t lowBitsMask(unsigned int numBits)
+{
+	return (numBits >= 32) ? ~0u : (1u << numBits) - 1;
+}
+
+/// Returns the number of consecutive bits set starting from the lowest one
+inline unsigned int countTrailingOnes(uint32_t mask)
+{
+	return (~mask != 0) ? countTrailingZeros(~mask) : 32;
+}
+
+struct BlockMasks
+{
+	uint32_t digits;
+	uint32_t commas;
+	uint32_t whitespaces;
+	uint32_t terminators;
+};
+
+	#if defined(WITH_AVX2_DECODER)
+const unsigned int BlockSize = 32;
+
+inline void classifyBlock(const char *block, BlockMasks &masks)
+{
+	const __m256i chars = _mm256_load_si256(reinterpret_cast<const __m256i *>(block));
+
+	// Bias the subtraction result to use a signed comparison as an unsigned one
+	const __m256i biased = _mm256_xor_si256(_mm256_sub_epi8(chars, _mm256_set1_epi8('0')), _mm256_set1_epi8(static_cast<char>(0x80)));
+	const __m256i digits = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + 10)), biased);
+	const __m256i commas = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(','));
+	const __m256i whitespaces = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t'))),
+	                                            _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\r'))));
+	const __m256i terminators = _mm256_cmpeq_epi8(chars, _mm256_setzero_si256());
+
+	masks.digits = static_cast<uint32_t>(_mm256_movemask_epi8(digits));
+	masks.commas = static_cast<uint32_t>(_mm256_movemask_epi8(commas));
+	masks.whitespaces = static_cast<uint32_t>(_mm256_movemask_epi8(whitespaces));
+	masks.terminators = static_cast<uint32_t>(_mm256_movemask_epi8(terminators));
+}
+	#else
+const unsigned int BlockSize = 16;
+
+inline void classifyBlock(const char *block, BlockMasks &masks)
+{
+	const __m128i chars = _mm_load_si128(reinterpret_cast<const __m128i *>(block));
+
+	// Bias the subtraction result to use a signed comparison as an unsigned one
+	const __m128i biased = _mm_xor_si128(_mm_sub_epi8(chars, _mm_set1_epi8('0')), _mm_set1_epi8(static_cast<char>(0x80)));
+	const __m128i digits = _mm_cmplt_epi8(biased, _mm_set1_epi8(static_cast<char>(0x80 + 10)));
+	const __m128i commas = _mm_cmpeq_epi8(chars, _mm_set1_epi8(','));
+	const __m128i whitespaces = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t'))),
+	                                         _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('\r'))));
+	const __m128i terminators = _mm_cmpeq_epi8(chars, _mm_setzero_si128());
+
+	masks.digits = static_cast<uint32_t>(_mm_movemask_epi8(digits));
+	masks.commas = static_cast<uint32_t>(_mm_movemask_epi8(commas));
+	masks.whitespaces = static_cast<uint32_t>(_mm_movemask_epi8(whitespaces));
+	masks.terminators = static_cast<uint32_t>(_mm_movemask_epi8(terminators));
+}
+	#endif
+
+/// Decodes canonical CSV data by classifying a whole block of characters at a time
+/*! Blocks are loaded from aligned addresses, so a load never crosses into a page that does not contain part of the string.
+ *  \returns False if the string is not canonical and it should be decoded by the reference parser */
+bool decodeCsvFast(const char *string, nctl::Array<unsigned int> &tileGids)
+{
+	const unsigned int misalignment = static_cast<unsigned int>(reinterpret_cast<uintptr_t>(string) & (BlockSize - 1));
+	const char *block = string - misalignment;
+	const uint32_t blockMask = lowBitsMask(BlockSize);
+	uint32_t validMask = blockMask & ~lowBitsMask(misalignment);
+
+	unsigned int value = 0;
+	unsigned int numDigits = 0;
+	bool valueSpansBlocks = false;
+	bool sawValue = false;
+	bool sawSeparator = false;
+	bool lastBlock = false;
+
+	while (lastBlock == false)
+	{
+		BlockMasks masks;
+		classifyBlock(block, masks);
+
+		masks.terminators &= validMask;
+		if (masks.terminators)
+		{
+			validMask &= lowBitsMask(countTrailingZeros(masks.terminators));
+			lastBlock = true;
+		}
+
+		const uint32_t digits = masks.digits & validMask;
+		const uint32_t commas = masks.commas & validMask;
+		if ((validMask & ~(digits | commas | (masks.whitespaces & validMask))) != 0)
+			return false;
+
+		// The first run of digits might be the continuation of a value from the previous block
+		uint32_t runDigits = digits;
+		if (valueSpansBlocks)
+		{
+			const unsigned int runLength = countTrailingOnes(digits);
+			numDigits += runLength;
+			if (numDigits > MaxGidDigits)
+				return false;
+			for (unsigned int i = 0; i < runLength; i++)
+				value = value * 10 + static_cast<unsigned int>(block[i] - '0');
+
+			if (runLength < BlockSize)
+			{
+				tileGids.pushBack(value);
+				valueSpansBlocks = false;
+				runDigits &= ~lowBitsMask(runLength);
+			}
+			else
+			{
+				block += BlockSize;
+				validMask = blockMask;
+				continue;
+			}
+		}
+
+		const uint32_t runStarts = runDigits & ~(runDigits << 1);
+		uint32_t events = runStarts | commas;
+		while (events)
+		{
+			const unsigned int position = countTrailingZeros(events);
+			events &= events - 1;
+
+			if (commas & (1u << position))
+			{
+				if (sawValue == false)
+					return false;
+				sawValue = false;
+				sawSeparator = true;
+				continue;
+			}
+
+			// Two values without a comma between them
+			if (sawValue)
+				return false;
+			sawValue = true;
+
+			const unsigned int runLength = countTrailingOnes(runDigits >> position);
+			numDigits = runLength;
+			if (numDigits > MaxGidDigits)
+				return false;
+			value = 0;
+			for (unsigned int i = 0; i < runLength; i++)
+				value = value * 10 + static_cast<unsigned int>(block[position + i] - '0');
+
+			if (position + runLength < BlockSize)
+				tileGids.pushBack(value);
+			else
+				valueSpansBlocks = true;
+		}
+
+		block += BlockSize;
+		validMask = blockMask;
+	}
+
+	if (valueSpansBlocks)
+		tileGids.pushBack(value);
+
+	// A single value, a dangling separator or no values at all are left to the reference parser
+	return (sawValue && sawSeparator);
+}
+
+#else
+
+/// Decodes canonical CSV data one character at a time
+/*! \returns False if the string is not canonical and it should be decoded by the reference parser */
+bool decodeCsvFast(const char *string, nctl::Array<unsigned int> &tileGids)
+{
+	const char *buffer = string;
+	bool sawValue = false;
+	bool sawSeparator = false;
+
+	while (*buffer != '\0')
+	{
+		const char c = *buffer;
+		if (isDigit(c))
+		{
+			// Two values without a comma between them
+			if (sawValue)
+				return false;
+			sawValue = true;
+
+			unsigned int value = 0;
+			unsigned int numDigits = 0;
+			while (isDigit(*buffer))
+			{
+				value = value * 10 + static_cast<unsigned int>(*buffer - '0');
+				buffer++;
+				numDigits++;
+			}
+			if (numDigits > MaxGidDigits)
+				return false;
+
+			tileGids.pushBack(value);
+		}
+		else if (c == ',')
+		{
+			if (sawValue == false)
+				return false;
+			sawValue = false;
+			sawSeparator = true;
+			buffer++;
+		}
+		else if (isWhitespace(c))
+			buffer++;
+		else
+			return false;
+	}
+
+	// A single value, a dangling separator or no values at all are left to the reference parser
+	return (sawValue && sawSeparator);
+}
+
+#endif
+
+/// Sextet values of base64 characters, -2 for whitespaces, -3 for padding and -1 for invalid characters
+const signed char Base64Table[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -2, -2, -1, -1, -2, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+	52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -3, -1, -1,
+	-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+	15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+	-1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+	41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+const signed char Base64Whitespace = -2;
+const signed char Base64Padding = -3;
+/// The number of characters that are decoded at once when streaming base64 data to a decompressor
+const unsigned int Base64WindowLength = 16 * 1024;
+
+#if defined(WITH_SSE2_DECODER)
+
+/// Decodes blocks of 16 base64 characters into 12 bytes until an invalid character is found
+/*! Each block writes 16 bytes in the output buffer, so there should always be four more bytes available.
+ *  \returns The number of characters that have been consumed, always a multiple of 16 */
+unsigned long int decodeBase64Blocks(const char *src, unsigned long int srcLength, unsigned char *dst, unsigned long int dstLength)
+{
+	unsigned long int consumed = 0;
+	while (srcLength - consumed >= 16 && dstLength >= 16)
+	{
+		const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + consumed));
+
+		// Translate ASCII characters to sextets with range checks instead of a table lookup
+		const __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1)));
+		const __m128i isLower = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('z' + 1)));
+		const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+		const __m128i isPlus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+		const __m128i isSlash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+
+		const __m128i isValid = _mm_or_si128(_mm_or_si128(isUpper, isLower), _mm_or_si128(_mm_or_si128(isDigit, isPlus), isSlash));
+		if (_mm_movemask_epi8(isValid) != 0xFFFF)
+			break;
+
+		const __m128i offsets = _mm_or_si128(_mm_or_si128(_mm_and_si128(isUpper, _mm_set1_epi8(-'A')), _mm_and_si128(isLower, _mm_set1_epi8(26 - 'a'))),
+		                                     _mm_or_si128(_mm_or_si128(_mm_and_si128(isDigit, _mm_set1_epi8(52 - '0')), _mm_and_si128(isPlus, _mm_set1_epi8(62 - '+'))),
+		                                                  _mm_and_si128(isSlash, _mm_set1_epi8(63 - '/'))));
+		const __m128i sextets = _mm_add_epi8(chars, offsets);
+
+	#if defined(WITH_SSSE3_DECODER)
+		// Merge four sextets in the lowest 24 bits of every 32 bits lane
+		const __m128i pairs = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+		const __m128i merged = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+		// Reverse the three bytes of every lane and pack them together
+		const __m128i packed = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), packed);
+	#else
+		// Merge four sextets in the lowest 24 bits of every 32 bits lane
+		const __m128i pairs = _mm_add_epi16(_mm_slli_epi16(_mm_and_si128(sextets, _mm_set1_epi16(0x00FF)), 6), _mm_srli_epi16(sextets, 8));
+		const __m128i merged = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pairs, _mm_set1_epi32(0x0000FFFF)), 12), _mm_srli_epi32(pairs, 16));
+
+		// There is no byte shuffle instruction in SSE2
+		alignas(16) uint32_t lanes[4];
+		_mm_store_si128(reinterpret_cast<__m128i *>(lanes), merged);
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			dst[i * 3 + 0] = static_cast<unsigned char>(lanes[i] >> 16);
+			dst[i * 3 + 1] = static_cast<unsigned char>(lanes[i] >> 8);
+			dst[i * 3 + 2] = static_cast<unsigned char>(lanes[i]);
+		}
+	#endif
+
+		consumed += 16;
+		dst += 12;
+		dstLength -= 12;
+	}
+
+	return consumed;
+}
+
+#endif
+
+/// Converts an array of little-endian GIDs to the host byte order
+inline void gidsFromLittleEndian(nctl::Array<unsigned int> &tileGids)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	for (unsigned int i = 0; i < tileGids.size(); i++)
+		tileGids[i] = __builtin_bswap32(tileGids[i]);
+#else
+	(void)tileGids;
+#endif
+}
+
+/// The state of a base64 decoding that can be split across multiple windows of characters
+struct Base64State
+{
+	uint32_t quantum = 0;
+	unsigned int numSextets = 0;
+	unsigned int numPaddings = 0;
+	/// The number of characters consumed by the previous windows, used to report errors
+	unsigned long int position = 0;
+};
+
+/// Decodes a window of base64 characters, advancing the destination pointer
+bool decodeBase64Window(Base64State &state, const char *string, unsigned long int length, unsigned char *&dst, unsigned char *dstEnd, DataDecoder::Report &report)
+{
+	const unsigned char *src = reinterpret_cast<const unsigned char *>(string);
+	const unsigned char *srcEnd = src + length;
+
+	while (src < srcEnd)
+	{
+#if defined(WITH_SSE2_DECODER)
+		// The vectorized path can only start at the beginning of a quantum
+		if (state.numSextets == 0 && state.numPaddings == 0)
+		{
+			const unsigned long int consumed = decodeBase64Blocks(reinterpret_cast<const char *>(src), srcEnd - src, dst, dstEnd - dst);
+			src += consumed;
+			dst += (consumed / 4) * 3;
+			if (src == srcEnd)
+				break;
+		}
+#endif
+
+		const signed char value = Base64Table[*src];
+		if (value >= 0)
+		{
+			if (state.numPaddings > 0)
+			{
+				report.setError("Base64 data continues after padding at byte %lu", state.position + (src - reinterpret_cast<const unsigned char *>(string)));
+				return false;
+			}
+
+			state.quantum = (state.quantum << 6) | static_cast<uint32_t>(value);
+			state.numSextets++;
+			if (state.numSextets == 4)
+			{
+				if (dstEnd - dst < 3)
+				{
+					report.setError("Base64 data exceeds the size of the output buffer");
+					return false;
+				}
+				dst[0] = static_cast<unsigned char>(state.quantum >> 16);
+				dst[1] = static_cast<unsigned char>(state.quantum >> 8);
+				dst[2] = static_cast<unsigned char>(state.quantum);
+				dst += 3;
+				state.quantum = 0;
+				state.numSextets = 0;
+			}
+		}
+		else if (value == Base64Padding)
+			state.numPaddings++;
+		else if (value != Base64Whitespace)
+		{
+			report.setError("Invalid base64 character at byte %lu", state.position + (src - reinterpret_cast<const unsigned char *>(string)));
+			return false;
+		}
+		src++;
+	}
+
+	state.position += length;
+	return true;
+}
+
+/// Validates the padding and writes the bytes encoded by the last incomplete quantum
+bool finishBase64(Base64State &state, unsigned char *&dst, unsigned char *dstEnd, DataDecoder::Report &report)
+{
+	// A final quantum of two or three sextets encodes one or two bytes
+	const unsigned int numSextets = state.numSextets;
+	const unsigned int numPaddings = state.numPaddings;
+	const unsigned int numRemainingBytes = (numSextets > 1) ? numSextets - 1 : 0;
+	if (numSextets == 1 || numSextets + numPaddings > 4 || (numPaddings > 0 && numSextets + numPaddings != 4))
+	{
+		report.setError("Base64 data has an incomplete final quantum");
+		return false;
+	}
+	if (dstEnd - dst < numRemainingBytes)
+	{
+		report.setError("Base64 data exceeds the size of the output buffer");
+		return false;
+	}
+	if (numRemainingBytes > 0)
+	{
+		const uint32_t quantum = state.quantum << (6 * (4 - numSextets));
+		dst[0] = static_cast<unsigned char>(quantum >> 16);
+		if (numRemainingBytes > 1)
+			dst[1] = static_cast<unsigned char>(quantum >> 8);
+		dst += numRemainingBytes;
+	}
+
+	return true;
+}
+
+/// A streaming decompressor that writes directly into a fixed size output buffer
+/*! Without an output buffer, the data is decompressed one window at a time with `feedWindow()`. */
+class Decompressor
+{
+  public:
+	Decompressor(MapModel::Compression compression, unsigned char *output, unsigned long int outputSize, DataDecoder::Report &report);
+	~Decompressor();
+
+	/// Decompresses a window of input data, it can be called multiple times
+	bool feed(const unsigned char *input, unsigned long int inputSize);
+	/// Decompresses as much input data as fits in an output window that is consumed before the next call
+	/*! \param inputSize The size of the input data on input, the size of the data not consumed yet on output
+	 *  \param outputSize The size of the output window on input, the number of decompressed bytes on output */
+	bool feedWindow(const unsigned char *&input, unsigned long int &inputSize, unsigned char *output, unsigned long int &outputSize);
+	/// Checks that the compressed stream is complete and returns the number of decompressed bytes
+	bool finish(unsigned long int &decompressedSize);
+	inline bool hasEnded() const { return hasEnded_; }
+
+  private:
+	MapModel::Compression compression_;
+	unsigned long int outputSize_;
+	DataDecoder::Report &report_;
+	bool isInitialized_;
+	bool hasEnded_;
+
+#ifdef WITH_ZLIB
+	z_stream zStream_;
+#endif
+#ifdef WITH_ZSTD
+	ZSTD_DCtx *zstdContext_;
+	ZSTD_outBuffer zstdOutput_;
+#endif
+
+	/// Deleted copy constructor
+	Decompressor(const Decompressor &) = delete;
+	/// Deleted assignment operator
+	Decompressor &operator=(const Decompressor &) = delete;
+};
+
+Decompressor::Decompressor(MapModel::Compression compression, unsigned char *output, unsigned long int outputSize, DataDecoder::Report &report)
+    : compression_(compression), outputSize_(outputSize), report_(report), isInitialized_(false), hasEnded_(false)
+{
+	if (compression_ == MapModel::Compression::gzip || compression_ == MapModel::Compression::zlib)
+	{
+#ifdef WITH_ZLIB
+		zStream_ = {};
+		zStream_.next_out = output;
+		zStream_.avail_out = static_cast<uInt>(outputSize);
+
+		// Adding 32 to the window bits enables the automatic detection of the zlib or gzip header
+		const int result = inflateInit2(&zStream_, MAX_WBITS + 32);
+		if (result == Z_OK)
+			isInitialized_ = true;
+		else
+			report_.setError("Cannot initialize the zlib stream: %s", zStream_.msg ? zStream_.msg : "unknown error");
+#else
+		report_.setError("The decoder has been compiled without zlib support");
+#endif
+	}
+	else if (compression_ == MapModel::Compression::zstd)
+	{
+#ifdef WITH_ZSTD
+		zstdOutput_.dst = output;
+		zstdOutput_.size = outputSize;
+		zstdOutput_.pos = 0;
+
+		zstdContext_ = ZSTD_createDCtx();
+		if (zstdContext_ != nullptr)
+		{
+			// The whole output buffer is always available, there is no need for an internal window buffer
+			if (output != nullptr)
+				ZSTD_DCtx_setParameter(zstdContext_, ZSTD_d_stableOutBuffer, 1);
+			isInitialized_ = true;
+		}
+		else
+			report_.setError("Cannot create the zstd decompression context");
+#else
+		report_.setError("The decoder has been compiled without zstd support");
+#endif
+	}
+	else
+		report_.setError("Unsupported layer data compression");
+}
+
+Decompressor::~Decompressor()
+{
+	if (isInitialized_ == false)
+		return;
+
+#ifdef WITH_ZLIB
+	if (compression_ == MapModel::Compression::gzip || compression_ == MapModel::Compression::zlib)
+		inflateEnd(&zStream_);
+#endif
+#ifdef WITH_ZSTD
+	if (compression_ == MapModel::Compression::zstd)
+		ZSTD_freeDCtx(zstdContext_);
+#endif
+}
+
+bool Decompressor::feed(const unsigned char *input, unsigned long int inputSize)
+{
+	if (isInitialized_ == false)
+		return false;
+	// Trailing data after the end of the compressed stream is ignored
+	if (hasEnded_ || inputSize == 0)
+		return true;
+
+#ifdef WITH_ZLIB
+	if (compression_ == MapModel::Compression::gzip || compression_ == MapModel::Compression::zlib)
+	{
+		zStream_.next_in = const_cast<Bytef *>(input);
+		zStream_.avail_in = static_cast<uInt>(inputSize);
+
+		const int result = inflate(&zStream_, Z_NO_FLUSH);
+		if (result == Z_STREAM_END)
+			hasEnded_ = true;
+		else if (result != Z_OK && result != Z_BUF_ERROR)
+		{
+			report_.setError("Cannot decompress zlib data: %s", zStream_.msg ? zStream_.msg : "unknown error");
+			return false;
+		}
+		else if (zStream_.avail_in > 0 && zStream_.avail_out == 0)
+		{
+			report_.setError("Decompressed data exceeds the expected size of %lu bytes", outputSize_);
+			return false;
+		}
+	}
+#endif
+#ifdef WITH_ZSTD
+	if (compression_ == MapModel::Compression::zstd)
+	{
+		ZSTD_inBuffer zstdInput = { input, inputSize, 0 };
+		while (zstdInput.pos < zstdInput.size)
+		{
+			const size_t inputPos = zstdInput.pos;
+			const size_t outputPos = zstdOutput_.pos;
+			const size_t result = ZSTD_decompressStream(zstdContext_, &zstdOutput_, &zstdInput);
+			if (ZSTD_isError(result))
+			{
+				if (ZSTD_getErrorCode(result) == ZSTD_error_dstSize_tooSmall)
+					report_.setError("Decompressed data exceeds the expected size of %lu bytes", outputSize_);
+				else
+					report_.setError("Cannot decompress zstd data: %s", ZSTD_getErrorName(result));
+				return false;
+			}
+			else if (result == 0)
+			{
+				hasEnded_ = true;
+				break;
+			}
+			else if (zstdInput.pos == inputPos && zstdOutput_.pos == outputPos)
+			{
+				report_.setError("Decompressed data exceeds the expected size of %lu bytes", outputSize_);
+				return false;
+			}
+		}
+	}
+#endif
+
+	return true;
+}
+
+bool Decompressor::feedWindow(const unsigned char *&input, unsigned long int &inputSize, unsigned char *output, unsigned long int &outputSize)
+{
+	if (isInitialized_ == false)
+		return false;
+	if (hasEnded_)
+	{
+		inputSize = 0;
+		outputSize = 0;
+		return true;
+	}
+
+#ifdef WITH_ZLIB
+	if (compression_ == MapModel::Compression::gzip || compression_ == MapModel::Compression::zlib)
+	{
+		zStream_.next_in = const_cast<Bytef *>(input);
+		zStream_.avail_in = static_cast<uInt>(inputSize);
+		zStream_.next_out = output;
+		zStream_.avail_out = static_cast<uInt>(outputSize);
+
+		const int result = inflate(&zStream_, Z_NO_FLUSH);
+		if (result == Z_STREAM_END)
+			hasEnded_ = true;
+		else if (result != Z_OK && result != Z_BUF_ERROR)
+		{
+			report_.setError("Cannot decompress zlib data: %s", zStream_.msg ? zStream_.msg : "unknown error");
+			return false;
+		}
+
+		input = zStream_.next_in;
+		inputSize = zStream_.avail_in;
+		outputSize -= zStream_.avail_out;
+	}
+#endif
+#ifdef WITH_ZSTD
+	if (compression_ == MapModel::Compression::zstd)
+	{
+		ZSTD_inBuffer zstdInput = { input, inputSize, 0 };
+		ZSTD_outBuffer zstdOutput = { output, outputSize, 0 };
+		const size_t result = ZSTD_decompressStream(zstdContext_, &zstdOutput, &zstdInput);
+		if (ZSTD_isError(result))
+		{
+			report_.setError("Cannot decompress zstd data: %s", ZSTD_getErrorName(result));
+			return false;
+		}
+		else if (result == 0)
+			hasEnded_ = true;
+
+		input += zstdInput.pos;
+		inputSize -= static_cast<unsigned long int>(zstdInput.pos);
+		outputSize = static_cast<unsigned long int>(zstdOutput.pos);
+	}
+#endif
+
+	return true;
+}
+
+bool Decompressor::finish(unsigned long int &decompressedSize)
+{
+	if (isInitialized_ == false)
+		return false;
+
+	if (hasEnded_ == false)
+	{
+		report_.setError("Compressed data is truncated");
+		return false;
+	}
+
+#ifdef WITH_ZLIB
+	if (compression_ == MapModel::Compression::gzip || compression_ == MapModel::Compression::zlib)
+		decompressedSize = zStream_.total_out;
+#endif
+#ifdef WITH_ZSTD
+	if (compression_ == MapModel::Compression::zstd)
+		decompressedSize = static_cast<unsigned long int>(zstdOutput_.pos);
+#endif
+
+	return true;
+}
+
+/// Decompresses a whole buffer with a single call to the streaming decompressor
+bool decompress(MapModel::Compression compression, const unsigned char *input, unsigned long int inputSize, unsigned char *output, unsigned long int &outputSize, DataDecoder::Report &report)
+{
+	Decompressor decompressor(compression, output, outputSize, report);
+	if (decompressor.feed(input, inputSize) == false)
+		return false;
+	return decompressor.finish(outputSize);
+}
+
+/// Keeps the GIDs inside a rectangle of a grid while all the GIDs of the grid are streamed in row-major order
+class RegionCollector
+{
+  public:
+	RegionCollector(unsigned int gridWidth, const nc::Recti &rect, nctl::Array<unsigned int> &tileGids);
+
+	/// Returns true when the last GID of the rectangle has been streamed, the following ones can be ignored
+	inline bool isComplete() const { return gidIndex_ >= endIndex_; }
+	/// Returns the number of GIDs to skip before the next one that is inside the rectangle
+	unsigned int numGidsToSkip() const;
+	/// Returns the number of GIDs to keep before the next one that is outside the rectangle
+	unsigned int numGidsToKeep() const;
+	/// Skips a number of GIDs, which should not be more than the ones returned by `numGidsToSkip()`
+	inline void skip(unsigned int numGids) { gidIndex_ += numGids; }
+	/// Keeps a GID, which should be inside the rectangle
+	inline void keep(unsigned int gid)
+	{
+		tileGids_.pushBack(gid);
+		gidIndex_++;
+	}
+	/// Streams a buffer of little-endian 32 bits GIDs, which can be split at any byte
+	void addBytes(const unsigned char *bytes, unsigned long int numBytes);
+	/// Fills the GIDs that were missing from the data with zeros
+	/*! \returns The number of GIDs that were missing */
+	unsigned int complete();
+
+  private:
+	unsigned int gridWidth_;
+	nc::Recti rect_;
+	unsigned int gidIndex_;
+	/// The index of the first GID of the rectangle
+	unsigned int startIndex_;
+	/// The index after the last GID of the rectangle
+	unsigned int endIndex_;
+	nctl::Array<unsigned int> &tileGids_;
+	/// The bytes of a GID that was split between two buffers
+	unsigned char partialGid_[4];
+	unsigned int numPartialBytes_;
+};
+
+RegionCollector::RegionCollector(unsigned int gridWidth, const nc::Recti &rect, nctl::Array<unsigned int> &tileGids)
+    : gridWidth_(gridWidth), rect_(rect), gidIndex_(0), startIndex_(rect.y * gridWidth + rect.x),
+      endIndex_((rect.y + rect.h - 1) * gridWidth + rect.x + rect.w), tileGids_(tileGids), numPartialBytes_(0)
+{
+	tileGids_.clear();
+	tileGids_.setCapacity(rect.w * rect.h);
+}
+
+unsigned int RegionCollector::numGidsToSkip() const
+{
+	if (gidIndex_ < startIndex_)
+		return startIndex_ - gidIndex_;
+
+	const unsigned int column = gidIndex_ % gridWidth_;
+	if (column < static_cast<unsigned int>(rect_.x))
+		return rect_.x - column;
+	else if (column >= static_cast<unsigned int>(rect_.x + rect_.w))
+		return gridWidth_ - column + rect_.x;
+	return 0;
+}
+
+unsigned int RegionCollector::numGidsToKeep() const
+{
+	if (gidIndex_ < startIndex_ || gidIndex_ >= endIndex_)
+		return 0;
+
+	const unsigned int column = gidIndex_ % gridWidth_;
+	if (column < static_cast<unsigned int>(rect_.x) || column >= static_cast<unsigned int>(rect_.x + rect_.w))
+		return 0;
+	return rect_.x + rect_.w - column;
+}
+
+void RegionCollector::addBytes(const unsigned char *bytes, unsigned long int numBytes)
+{
+	while (numBytes > 0 && isComplete() == false)
+	{
+		if (numPartialBytes_ > 0 || numBytes < 4)
+		{
+			// A GID split between two buffers is assembled one byte at a time
+			partialGid_[numPartialBytes_++] = *bytes++;
+			numBytes--;
+			if (numPartialBytes_ == 4)
+			{
+				if (numGidsToKeep() > 0)
+					keep(partialGid_[0] | (partialGid_[1] << 8) | (partialGid_[2] << 16) | (static_cast<unsigned int>(partialGid_[3]) << 24));
+				else
+					skip(1);
+				numPartialBytes_ = 0;
+			}
+			continue;
+		}
+
+		const unsigned int numWholeGids = static_cast<unsigned int>(numBytes / 4);
+		const unsigned int numGidsToSkip = this->numGidsToSkip();
+		if (numGidsToSkip > 0)
+		{
+			const unsigned int numSkipped = (numGidsToSkip < numWholeGids) ? numGidsToSkip : numWholeGids;
+			skip(numSkipped);
+			bytes += numSkipped * 4;
+			numBytes -= numSkipped * 4;
+		}
+		else
+		{
+			const unsigned int numGidsToKeep = this->numGidsToKeep();
+			const unsigned int numKept = (numGidsToKeep < numWholeGids) ? numGidsToKeep : numWholeGids;
+			for (unsigned int i = 0; i < numKept; i++)
+				keep(bytes[i * 4] | (bytes[i * 4 + 1] << 8) | (bytes[i * 4 + 2] << 16) | (static_cast<unsigned int>(bytes[i * 4 + 3]) << 24));
+			bytes += numKept * 4;
+			numBytes -= numKept * 4;
+		}
+	}
+}
+
+unsigned int RegionCollector::complete()
+{
+	const unsigned int numMissingGids = rect_.w * rect_.h - tileGids_.size();
+	for (unsigned int i = 0; i < numMissingGids; i++)
+		tileGids_.pushBack(0);
+	gidIndex_ = endIndex_;
+	return numMissingGids;
+}
+
+/// Streams the GIDs of a string of comma separated values, parsing only the ones inside the rectangle
+bool collectCsvRegion(const char *string, RegionCollector &collector, DataDecoder::Report &report)
+{
+	const char *buffer = string;
+	while (collector.isComplete() == false && *buffer != '\0')
+	{
+		unsigned int numGidsToSkip = collector.numGidsToSkip();
+		if (numGidsToSkip > 0)
+		{
+			// The values outside of the rectangle are only counted, looking for their separators
+			const unsigned int numGids = numGidsToSkip;
+			for (; numGidsToSkip > 0 && *buffer != '\0'; buffer++)
+			{
+				if (*buffer == ',')
+					numGidsToSkip--;
+			}
+			collector.skip(numGids - numGidsToSkip);
+			continue;
+		}
+
+		while (isWhitespace(*buffer))
+			buffer++;
+		unsigned int gid = 0;
+		const char *end = NumberParser::parseUint(buffer, gid);
+		if (end == buffer)
+		{
+			report.setError("CSV layer data parsing failed at byte %u", static_cast<unsigned int>(buffer - string));
+			return false;
+		}
+		collector.keep(gid);
+
+		buffer = end;
+		while (isWhitespace(*buffer))
+			buffer++;
+		if (*buffer == ',')
+			buffer++;
+		else if (*buffer != '\0')
+		{
+			report.setError("CSV layer data parsing failed at byte %u", static_cast<unsigned int>(buffer - string));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/// Streams the GIDs of a base64 string, decompressing it if needed, until the last one inside the rectangle
+/*! Only a window of characters, of decoded bytes and of decompressed bytes is kept in memory at any time. */
+bool collectBase64Region(const char *string, MapModel::Compression compression, RegionCollector &collector, DataDecoder::Report &report)
+{
+	const unsigned long int WindowBufferSize = (Base64WindowLength / 4) * 3 + 3;
+	const unsigned long int OutputWindowSize = 64 * 1024;
+	const bool isCompressed = (compression != MapModel::Compression::Uncompressed);
+	nctl::UniquePtr<unsigned char[]> windowBuffer = nctl::makeUnique<unsigned char[]>(WindowBufferSize);
+	nctl::UniquePtr<unsigned char[]> outputBuffer;
+	nctl::UniquePtr<Decompressor> decompressor;
+	if (isCompressed)
+	{
+		outputBuffer = nctl::makeUnique<unsigned char[]>(OutputWindowSize);
+		decompressor = nctl::makeUnique<Decompressor>(compression, nullptr, 0, report);
+	}
+
+	Base64State state;
+	const char *src = string;
+	bool isLastWindow = false;
+	while (isLastWindow == false && collector.isComplete() == false)
+	{
+		const unsigned int length = nctl::strnlen(src, Base64WindowLength);
+		isLastWindow = (length < Base64WindowLength);
+
+		unsigned char *dst = windowBuffer.get();
+		unsigned char *dstEnd = dst + WindowBufferSize;
+		if (decodeBase64Window(state, src, length, dst, dstEnd, report) == false)
+			return false;
+		if (isLastWindow && finishBase64(state, dst, dstEnd, report) == false)
+			return false;
+		src += length;
+
+		const unsigned long int decodedSize = static_cast<unsigned long int>(dst - windowBuffer.get());
+		if (isCompressed == false)
+		{
+			collector.addBytes(windowBuffer.get(), decodedSize);
+			continue;
+		}
+
+		// A window of compressed data can expand to more than one output window
+		const unsigned char *input = windowBuffer.get();
+		unsigned long int inputSize = decodedSize;
+		unsigned long int outputSize = OutputWindowSize;
+		do
+		{
+			outputSize = OutputWindowSize;
+			if (decompressor->feedWindow(input, inputSize, outputBuffer.get(), outputSize) == false)
+				return false;
+			collector.addBytes(outputBuffer.get(), outputSize);
+		} while ((inputSize > 0 || outputSize == OutputWindowSize) && collector.isComplete() == false && decompressor->hasEnded() == false);
+	}
+
+	if (isCompressed && collector.isComplete() == false && decompressor->hasEnded() == false)
+	{
+		report.setError("Compressed data is truncated");
+		return false;
+	}
+	return true;
+}
+
+/// Returns true if the data can be decoded, otherwise the first string that cannot be decoded is kept in the data
+bool canDecodeData(MapModel::Data &data, const char *string)
+{
+	if (data.compression != MapModel::Compression::Uncompressed &&
+	    (data.encoding != MapModel::Encoding::Base64 || DataDecoder::isSupported(data.compression) == false))
+	{
+		if (data.string.get() == nullptr)
+		{
+			const unsigned int stringLength = strlen(string);
+			data.string = nctl::makeUnique<char[]>(stringLength + 1);
+			memcpy(data.string.get(), string, stringLength);
+			data.string[stringLength] = '\0';
+		}
+		return false;
+	}
+	return true;
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+DataDecoder::Report::Report()
+    : numElements(0), numDuplicateChunks(0)
+{
+	error[0] = '\0';
+	warning[0] = '\0';
+}
+
+void DataDecoder::Report::setError(const char *format, ...)
+{
+	if (error[0] != '\0')
+		return;
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(error, MaxMessageLength, format, args);
+	va_end(args);
+}
+
+void DataDecoder::Report::setWarning(const char *format, ...)
+{
+	if (warning[0] != '\0')
+		return;
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(warning, MaxMessageLength, format, args);
+	va_end(args);
+}
+
+bool DataDecoder::decodeCsv(const char *string, unsigned int expectedElements, nctl::Array<unsigned int> &tileGids, Report &report)
+{
+	tileGids.clear();
+	if (expectedElements > tileGids.capacity())
+		tileGids.setCapacity(expectedElements);
+
+	const bool hasDecoded = decodeCsvFast(string, tileGids);
+	if (hasDecoded == false)
+	{
+		tileGids.clear();
+		return decodeCsvReference(string, tileGids, report);
+	}
+
+	report.numElements += tileGids.size();
+	return true;
+}
+
+bool DataDecoder::decodeCsvReference(const char *string, nctl::Array<unsigned int> &tileGids, Report &report)
+{
+	// Count elements
+	const char *buffer = string;
+	unsigned int numElements = 0;
+	while (*buffer != '\0')
+	{
+		while (*buffer != ',' && *buffer != '\0')
+			buffer++;
+		if (*buffer == ',')
+		{
+			numElements++;
+			buffer++;
+		}
+	}
+
+	if (numElements == 0)
+	{
+		report.setError("There are no elements in the CSV layer data");
+		return false;
+	}
+
+	tileGids.setCapacity(numElements);
+
+	// Parse elements
+	buffer = string;
+	while (*buffer != '\0')
+	{
+		const char *begin = buffer;
+		while (*begin == ' ' || *begin == '\t' || *begin == '\n')
+			begin++;
+		const char *end = begin;
+		while (*end != ' ' && *end != '\t' && *end != '\n' && *end != '\0' && *end != ',')
+			end++;
+
+		unsigned int value = 0;
+		const int matched = sscanf(begin, "%u", &value);
+		if (matched != 1)
+		{
+			report.setError("CSV layer data parsing failed at byte %u", static_cast<unsigned int>(begin - string));
+			return false;
+		}
+		tileGids.pushBack(value);
+
+		buffer = end;
+		while (*buffer != ',' && *buffer != '\0')
+			buffer++;
+		if (*buffer == ',')
+			buffer++;
+	}
+
+	report.numElements += tileGids.size();
+	return true;
+}
+
+bool DataDecoder::decodeBase64(const char *string, unsigned long int length, unsigned char *output, unsigned long int &outputSize, Report &report)
+{
+	Base64State state;
+	unsigned char *dst = output;
+	unsigned char *dstEnd = output + outputSize;
+
+	if (decodeBase64Window(state, string, length, dst, dstEnd, report) == false)
+		return false;
+	if (finishBase64(state, dst, dstEnd, report) == false)
+		return false;
+
+	outputSize = static_cast<unsigned long int>(dst - output);
+	return true;
+}
+
+bool DataDecoder::decodeBase64(const char *string, unsigned int expectedElements, nctl::Array<unsigned int> &tileGids, Report &report)
+{
+	const unsigned long int length = strlen(string);
+	// Every four characters encode three bytes
+	const unsigned long int maxDecodedSize = (length / 4) * 3 + 3;
+	const unsigned long int expectedSize = expectedElements * sizeof(unsigned int);
+
+	const unsigned long int outputSize = (expectedElements > 0) ? expectedSize : maxDecodedSize;
+	tileGids.clear();
+	tileGids.setSize(static_cast<unsigned int>((outputSize + sizeof(unsigned int) - 1) / sizeof(unsigned int)));
+
+	unsigned long int decodedSize = outputSize;
+	const bool hasDecoded = decodeBase64(string, length, reinterpret_cast<unsigned char *>(tileGids.data()), decodedSize, report);
+	if (hasDecoded == false)
+	{
+		tileGids.clear();
+		return false;
+	}
+
+	if (decodedSize % sizeof(unsigned int) != 0)
+		report.setWarning("Base64 layer data size of %lu bytes is not a multiple of four", decodedSize);
+	if (expectedElements > 0 && decodedSize != expectedSize)
+		report.setWarning("Base64 layer data has %lu elements instead of %u", decodedSize / sizeof(unsigned int), expectedElements);
+
+	tileGids.setSize(static_cast<unsigned int>(decodedSize / sizeof(unsigned int)));
+	gidsFromLittleEndian(tileGids);
+
+	report.numElements += tileGids.size();
+	return true;
+}
+
+bool DataDecoder::isSupported(MapModel::Compression compression)
+{
+	switch (compression)
+	{
+		case MapModel::Compression::Uncompressed:
+			return true;
+		case MapModel::Compression::gzip:
+		case MapModel::Compression::zlib:
+#ifdef WITH_ZLIB
+			return true;
+#else
+			return false;
+#endif
+		case MapModel::Compression::zstd:
+#ifdef WITH_ZSTD
+			return true;
+#else
+			return false;
+#endif
+		default:
+			return false;
+	}
+}
+
+bool DataDecoder::decompressZlib(const unsigned char *input, unsigned long int inputSize, unsigned char *output, unsigned long int &outputSize, Report &report)
+{
+	return decompress(MapModel::Compression::zlib, input, inputSize, output, outputSize, report);
+}
+
+bool DataDecoder::decompressZstd(const unsigned char *input, unsigned long int inputSize, unsigned char *output, unsigned long int &outputSize, Report &report)
+{
+	return decompress(MapModel::Compression::zstd, input, inputSize, output, outputSize, report);
+}
+
+bool DataDecoder::decodeCompressedBase64(const char *string, MapModel::Compression compression, unsigned int numElements, nctl::Array<unsigned int> &tileGids, Report &report)
+{
+	if (isSupported(compression) == false)
+	{
+		report.setError("Unsupported layer data compression");
+		return false;
+	}
+
+	tileGids.clear();
+	tileGids.setSize(numElements);
+	const unsigned long int expectedSize = numElements * sizeof(unsigned int);
+
+	// The string is decoded one window at a time and each window is decompressed directly in the array,
+	// so that the memory needed on top of the tile GIDs does not depend on the size of the layer
+	const unsigned long int WindowBufferSize = (Base64WindowLength / 4) * 3 + 3;
+	nctl::UniquePtr<unsigned char[]> windowBuffer = nctl::makeUnique<unsigned char[]>(WindowBufferSize);
+	Decompressor decompressor(compression, reinterpret_cast<unsigned char *>(tileGids.data()), expectedSize, report);
+
+	Base64State state;
+	const char *src = string;
+	bool hasDecompressed = true;
+	bool isLastWindow = false;
+	while (isLastWindow == false && hasDecompressed)
+	{
+		const unsigned int length = nctl::strnlen(src, Base64WindowLength);
+		isLastWindow = (length < Base64WindowLength);
+
+		unsigned char *dst = windowBuffer.get();
+		unsigned char *dstEnd = dst + WindowBufferSize;
+		hasDecompressed = decodeBase64Window(state, src, length, dst, dstEnd, report);
+		if (hasDecompressed && isLastWindow)
+			hasDecompressed = finishBase64(state, dst, dstEnd, report);
+		if (hasDecompressed)
+			hasDecompressed = decompressor.feed(windowBuffer.get(), static_cast<unsigned long int>(dst - windowBuffer.get()));
+
+		src += length;
+	}
+
+	unsigned long int decompressedSize = 0;
+	if (hasDecompressed)
+		hasDecompressed = decompressor.finish(decompressedSize);
+
+	if (hasDecompressed == false)
+	{
+		tileGids.clear();
+		return false;
+	}
+
+	if (decompressedSize != expectedSize)
+		report.setWarning("Compressed layer data has %lu elements instead of %u", decompressedSize / sizeof(unsigned int), numElements);
+
+	tileGids.setSize(static_cast<unsigned int>(decompressedSize / sizeof(unsigned int)));
+	gidsFromLittleEndian(tileGids);
+
+	report.numElements += tileGids.size();
+	return true;
+}
+
+bool DataDecoder::decodeLayerData(MapModel::Data &data, const char *string, unsigned int numElements, nctl::Array<unsigned int> &tileGids, Report &report)
+{
+	if (canDecodeData(data, string) == false)
+		return false;
+	else if (data.compression != MapModel::Compression::Uncompressed)
+		return decodeCompressedBase64(string, data.compression, numElements, tileGids, report);
+	else if (data.encoding == MapModel::Encoding::Base64)
+		return decodeBase64(string, numElements, tileGids, report);
+	else
+		return decodeCsv(string, numElements, tileGids, report);
+}
+
+bool DataDecoder::decodeLayerDataRegion(MapModel::Data &data, const char *string, unsigned int width, const nc::Recti &rect, nctl::Array<unsigned int> &tileGids, Report &report)
+{
+	if (canDecodeData(data, string) == false)
+		return false;
+
+	RegionCollector collector(width, rect, tileGids);
+	const bool hasDecoded = (data.encoding == MapModel::Encoding::Base64)
+	                            ? collectBase64Region(string, data.compression, collector, report)
+	                            : collectCsvRegion(string, collector, report);
+	if (hasDecoded == false)
+	{
+		tileGids.clear();
+		return false;
+	}
+
+	const unsigned int numMissingGids = collector.complete();
+	if (numMissingGids > 0)
+		report.setWarning("Layer data ends before the region, %u elements have been set to zero", numMissingGids);
+
+	report.numElements += tileGids.size();
+	return true;
+}
+
+bool DataDecoder::hasTiles(const nctl::Array<unsigned int> &tileGids)
+{
+	for (unsigned int i = 0; i < tileGids.size(); i++)
+	{
+		if (tileGids[i] != 0)
+			return true;
+	}
+	return false;
+}
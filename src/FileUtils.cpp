@@ -0,0 +1,25 @@
+#include "FileUtils.h"
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+int FileUtils::compareDates(const nc::fs::FileDate &first, const nc::fs::FileDate &second)
+{
+	const int firstValues[6] = { first.year, first.month, first.day, first.hour, first.minute, first.second };
+	const int secondValues[6] = { second.year, second.month, second.day, second.hour, second.minute, second.second };
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		if (firstValues[i] != secondValues[i])
+			return (firstValues[i] < secondValues[i]) ? -1 : 1;
+	}
+	return 0;
+}
+
+nctl::String FileUtils::cacheKey(const char *filename)
+{
+	nctl::String key = nc::fs::absolutePath(filename);
+	if (key.isEmpty())
+		key = filename;
+	return key;
+}
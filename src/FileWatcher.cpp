@@ -0,0 +1,83 @@
+#include "FileWatcher.h"
+#include "FileUtils.h"
+
+const float FileWatcher::DefaultInterval = 0.5f;
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+FileWatcher::FileWatcher()
+    : interval(DefaultInterval), lastPoll_(nc::TimeStamp::now())
+{
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void FileWatcher::add(const char *filename, FileType type, unsigned int index)
+{
+	// A file shared by more than one tileset or template is checked only once per index
+	for (unsigned int i = 0; i < entries_.size(); i++)
+	{
+		const Entry &entry = entries_[i];
+		if (entry.type == type && entry.index == index && entry.filename == filename)
+			return;
+	}
+
+	entries_.emplaceBack();
+	Entry &entry = entries_.back();
+	entry.filename = filename;
+	entry.type = type;
+	entry.index = index;
+	if (nc::fs::isFile(filename))
+	{
+		entry.date = nc::fs::lastModificationTime(filename);
+		entry.size = nc::fs::fileSize(filename);
+	}
+}
+
+void FileWatcher::clear()
+{
+	entries_.clear();
+}
+
+bool FileWatcher::poll(nctl::Array<Change> &changes)
+{
+	if (entries_.isEmpty() || lastPoll_.secondsSince() < interval)
+		return false;
+	lastPoll_ = nc::TimeStamp::now();
+
+	const unsigned int numChanges = changes.size();
+	for (unsigned int i = 0; i < entries_.size(); i++)
+	{
+		Entry &entry = entries_[i];
+		// A file that is being replaced might briefly not exist, it is checked again at the next poll
+		if (nc::fs::isFile(entry.filename.data()) == false)
+			continue;
+
+		const nc::fs::FileDate date = nc::fs::lastModificationTime(entry.filename.data());
+		const long int size = nc::fs::fileSize(entry.filename.data());
+		if (FileUtils::isSameDate(date, entry.date) && size == entry.size)
+		{
+			if (entry.isPending)
+			{
+				entry.isPending = false;
+				changes.emplaceBack();
+				Change &change = changes.back();
+				change.type = entry.type;
+				change.index = entry.index;
+				change.filename = entry.filename.data();
+			}
+		}
+		else
+		{
+			entry.date = date;
+			entry.size = size;
+			entry.isPending = true;
+		}
+	}
+
+	return (changes.size() > numChanges);
+}
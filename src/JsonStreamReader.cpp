@@ -0,0 +1,379 @@
+#include "JsonStreamReader.h"
+
+namespace {
+
+inline bool isSpace(char c)
+{
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+}
+
+inline bool isDigit(char c)
+{
+	return (c >= '0' && c <= '9');
+}
+
+inline bool isNumberChar(char c)
+{
+	return (isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E');
+}
+
+bool parseHex4(const char *string, unsigned long int &codePoint)
+{
+	codePoint = 0;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		const char c = string[i];
+		codePoint <<= 4;
+		if (c >= '0' && c <= '9')
+			codePoint |= c - '0';
+		else if (c >= 'a' && c <= 'f')
+			codePoint |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			codePoint |= c - 'A' + 10;
+		else
+			return false;
+	}
+	return true;
+}
+
+/// Writes the UTF-8 encoding of a code point and returns the position after it
+char *encodeUtf8(char *dest, unsigned long int codePoint)
+{
+	if (codePoint < 0x80)
+		*dest++ = static_cast<char>(codePoint);
+	else if (codePoint < 0x800)
+	{
+		*dest++ = static_cast<char>(0xC0 | (codePoint >> 6));
+		*dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+	else if (codePoint < 0x10000)
+	{
+		*dest++ = static_cast<char>(0xE0 | (codePoint >> 12));
+		*dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+	else
+	{
+		*dest++ = static_cast<char>(0xF0 | (codePoint >> 18));
+		*dest++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+	return dest;
+}
+
+/// Checks that a literal has been written correctly, as only its first character is used to detect it
+bool isLiteral(const char *begin, const char *end, const char *literal)
+{
+	while (begin < end && *literal != '\0')
+	{
+		if (*begin++ != *literal++)
+			return false;
+	}
+	return (begin == end && *literal == '\0');
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+JsonStreamReader::JsonStreamReader(char *buffer, unsigned long int size)
+    : buffer_(buffer), end_(buffer + size), pos_(buffer), pendingChar_('\0'),
+      key_(""), value_(""), errorDescription_(nullptr), errorOffset_(0)
+{
+	// Skipping the UTF-8 byte order mark
+	if (size >= 3 && buffer[0] == '\xEF' && buffer[1] == '\xBB' && buffer[2] == '\xBF')
+		pos_ += 3;
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+JsonStreamReader::Type JsonStreamReader::readValue()
+{
+	if (errorDescription_ != nullptr)
+		return Type::Error;
+
+	const char first = peek();
+	if (first == '{')
+	{
+		consume();
+		return Type::Object;
+	}
+	else if (first == '[')
+	{
+		consume();
+		return Type::Array;
+	}
+	else if (first == '"')
+	{
+		char *string = readString();
+		if (string == nullptr)
+			return Type::Error;
+		value_ = string;
+		return Type::String;
+	}
+	else if (first == '\0')
+	{
+		error("Unexpected end of document", pos_);
+		return Type::Error;
+	}
+	else if (first != '-' && isDigit(first) == false && first != 't' && first != 'f' && first != 'n')
+	{
+		error("Unexpected character", pos_);
+		return Type::Error;
+	}
+
+	char *valueEnd = pos_;
+	while (valueEnd < end_ && isSpace(*valueEnd) == false && *valueEnd != ',' && *valueEnd != '}' && *valueEnd != ']')
+		valueEnd++;
+	if (valueEnd >= end_)
+	{
+		error("Unexpected end of document", pos_);
+		return Type::Error;
+	}
+
+	Type type = Type::Number;
+	if (first == 't' || first == 'f')
+	{
+		type = Type::Boolean;
+		if (isLiteral(pos_, valueEnd, "true") == false && isLiteral(pos_, valueEnd, "false") == false)
+			type = Type::Error;
+	}
+	else if (first == 'n')
+		type = isLiteral(pos_, valueEnd, "null") ? Type::Null : Type::Error;
+
+	if (type == Type::Error)
+	{
+		error("Invalid literal", pos_);
+		return Type::Error;
+	}
+
+	// The terminator overwrites the delimiter, which is remembered for the next call
+	value_ = pos_;
+	pendingChar_ = *valueEnd;
+	*valueEnd = '\0';
+	pos_ = valueEnd;
+	return type;
+}
+
+bool JsonStreamReader::skip(Type type)
+{
+	if (type != Type::Object && type != Type::Array)
+		return (type != Type::Error);
+
+	unsigned int depth = 1;
+	char *p = pos_;
+	char c = (pendingChar_ != '\0') ? pendingChar_ : *p;
+	while (p < end_)
+	{
+		if (c == '"')
+		{
+			p++;
+			while (p < end_ && *p != '"')
+				p += (*p == '\\') ? 2 : 1;
+		}
+		else if (c == '{' || c == '[')
+			depth++;
+		else if (c == '}' || c == ']')
+		{
+			depth--;
+			if (depth == 0)
+			{
+				pendingChar_ = '\0';
+				pos_ = p + 1;
+				return true;
+			}
+		}
+
+		p++;
+		if (p < end_)
+			c = *p;
+	}
+
+	error("Unexpected end of document", pos_);
+	return false;
+}
+
+bool JsonStreamReader::nextKey()
+{
+	if (errorDescription_ != nullptr)
+		return false;
+
+	char c = peek();
+	if (c == ',')
+	{
+		consume();
+		c = peek();
+	}
+	if (c == '}')
+	{
+		consume();
+		return false;
+	}
+	else if (c != '"')
+	{
+		error("Expected a key", pos_);
+		return false;
+	}
+
+	char *string = readString();
+	if (string == nullptr)
+		return false;
+	key_ = string;
+
+	if (peek() != ':')
+	{
+		error("Expected a colon after the key", pos_);
+		return false;
+	}
+	consume();
+	return true;
+}
+
+bool JsonStreamReader::nextElement()
+{
+	if (errorDescription_ != nullptr)
+		return false;
+
+	char c = peek();
+	if (c == ',')
+	{
+		consume();
+		c = peek();
+	}
+	if (c == ']')
+	{
+		consume();
+		return false;
+	}
+	else if (c == '\0')
+	{
+		error("Unexpected end of document", pos_);
+		return false;
+	}
+	return true;
+}
+
+bool JsonStreamReader::readNumberArray()
+{
+	if (errorDescription_ != nullptr || pendingChar_ != '\0')
+		return false;
+
+	char *p = pos_;
+	while (p < end_ && *p != ']')
+	{
+		if (isNumberChar(*p) == false && isSpace(*p) == false && *p != ',')
+			return false;
+		p++;
+	}
+	if (p >= end_)
+	{
+		error("Unexpected end of document", pos_);
+		return false;
+	}
+
+	*p = '\0';
+	value_ = pos_;
+	pos_ = p + 1;
+	return true;
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void JsonStreamReader::error(const char *description, const char *position)
+{
+	if (errorDescription_ == nullptr)
+	{
+		errorDescription_ = description;
+		errorOffset_ = static_cast<unsigned long int>(position - buffer_);
+	}
+}
+
+char JsonStreamReader::peek()
+{
+	if (pendingChar_ != '\0')
+	{
+		if (isSpace(pendingChar_) == false)
+			return pendingChar_;
+		consume();
+	}
+
+	while (pos_ < end_ && isSpace(*pos_))
+		pos_++;
+	return (pos_ < end_) ? *pos_ : '\0';
+}
+
+char *JsonStreamReader::readString()
+{
+	char *start = pos_ + 1;
+	char *p = start;
+	while (p < end_ && *p != '"' && *p != '\\')
+		p++;
+
+	// Escape sequences are never shorter than the characters they represent
+	char *dest = p;
+	while (p < end_ && *p != '"')
+	{
+		if (*p != '\\')
+		{
+			*dest++ = *p++;
+			continue;
+		}
+
+		if (p + 1 >= end_)
+			break;
+		switch (p[1])
+		{
+			case '"':
+			case '\\':
+			case '/': *dest++ = p[1]; break;
+			case 'b': *dest++ = '\b'; break;
+			case 'f': *dest++ = '\f'; break;
+			case 'n': *dest++ = '\n'; break;
+			case 'r': *dest++ = '\r'; break;
+			case 't': *dest++ = '\t'; break;
+			case 'u':
+			{
+				unsigned long int codePoint = 0;
+				if (p + 6 > end_ || parseHex4(p + 2, codePoint) == false)
+				{
+					error("Invalid unicode escape sequence", p);
+					return nullptr;
+				}
+				p += 4;
+
+				// A high surrogate should be followed by a low one
+				unsigned long int lowSurrogate = 0;
+				if (codePoint >= 0xD800 && codePoint <= 0xDBFF && p + 8 <= end_ && p[2] == '\\' && p[3] == 'u' &&
+				    parseHex4(p + 4, lowSurrogate) && lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF)
+				{
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+					p += 6;
+				}
+				dest = encodeUtf8(dest, codePoint);
+				break;
+			}
+			default:
+				error("Invalid escape sequence", p);
+				return nullptr;
+		}
+		p += 2;
+	}
+
+	if (p >= end_)
+	{
+		error("Unterminated string", start - 1);
+		return nullptr;
+	}
+
+	*dest = '\0';
+	pos_ = p + 1;
+	pendingChar_ = '\0';
+	return start;
+}
@@ -0,0 +1,301 @@
+#include "LayerDecoder.h"
+#include "DataDecoder.h"
+#include "WorkerPool.h"
+
+namespace {
+
+struct DecodeJobsData
+{
+	LayerDecoder *decoder;
+	nctl::Array<MapModel::Layer> *layers;
+	const nctl::Array<unsigned int> *jobIndices;
+	const nc::Recti *rect;
+};
+
+/// Returns the intersection of two rectangles, with a zero size if they do not overlap
+nc::Recti intersect(const nc::Recti &first, const nc::Recti &second)
+{
+	const int left = (first.x > second.x) ? first.x : second.x;
+	const int top = (first.y > second.y) ? first.y : second.y;
+	const int right = (first.x + first.w < second.x + second.w) ? first.x + first.w : second.x + second.w;
+	const int bottom = (first.y + first.h < second.y + second.h) ? first.y + first.h : second.y + second.h;
+
+	if (right <= left || bottom <= top)
+		return nc::Recti(left, top, 0, 0);
+	return nc::Recti(left, top, right - left, bottom - top);
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void LayerDecoder::addLayer(unsigned int layerIndex, const char *string)
+{
+	retrieveJob(layerIndex).string = string;
+}
+
+void LayerDecoder::addChunk(unsigned int layerIndex, const char *string)
+{
+	retrieveJob(layerIndex).chunkStrings.pushBack(string);
+}
+
+bool LayerDecoder::decode(nctl::Array<MapModel::Layer> &layers)
+{
+	nctl::Array<unsigned int> jobIndices(numPendingJobs_);
+	for (unsigned int i = 0; i < jobs_.size(); i++)
+	{
+		if (jobs_[i].isPending)
+			jobIndices.pushBack(i);
+	}
+
+	return decodeJobs(layers, jobIndices, nullptr);
+}
+
+bool LayerDecoder::decode(nctl::Array<MapModel::Layer> &layers, const nctl::Array<unsigned int> &layerIndices)
+{
+	nctl::Array<unsigned int> jobIndices(layerIndices.size());
+	findPendingJobs(layerIndices, jobIndices);
+	return decodeJobs(layers, jobIndices, nullptr);
+}
+
+bool LayerDecoder::decodeRegion(nctl::Array<MapModel::Layer> &layers, const nc::Recti &rect, const nctl::Array<unsigned int> &layerIndices)
+{
+	nctl::Array<unsigned int> jobIndices(layerIndices.size());
+	findPendingJobs(layerIndices, jobIndices);
+	return decodeJobs(layers, jobIndices, &rect);
+}
+
+bool LayerDecoder::isPending(unsigned int layerIndex) const
+{
+	const int jobIndex = findJob(layerIndex);
+	return (jobIndex >= 0 && jobs_[jobIndex].isPending);
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+LayerDecoder::Job &LayerDecoder::retrieveJob(unsigned int layerIndex)
+{
+	// Layers are added in order, so the job of a layer is either the last one or a new one
+	if (jobs_.isEmpty() || jobs_.back().layerIndex != layerIndex)
+	{
+		jobs_.emplaceBack();
+		jobs_.back().layerIndex = layerIndex;
+		numPendingJobs_++;
+	}
+	return jobs_.back();
+}
+
+int LayerDecoder::findJob(unsigned int layerIndex) const
+{
+	// Jobs are sorted by layer index, as layers are added in order
+	unsigned int first = 0;
+	unsigned int last = jobs_.size();
+	while (first < last)
+	{
+		const unsigned int middle = first + (last - first) / 2;
+		if (jobs_[middle].layerIndex < layerIndex)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+
+	return (first < jobs_.size() && jobs_[first].layerIndex == layerIndex) ? static_cast<int>(first) : -1;
+}
+
+void LayerDecoder::findPendingJobs(const nctl::Array<unsigned int> &layerIndices, nctl::Array<unsigned int> &jobIndices) const
+{
+	for (unsigned int i = 0; i < layerIndices.size(); i++)
+	{
+		const int jobIndex = findJob(layerIndices[i]);
+		if (jobIndex < 0 || jobs_[jobIndex].isPending == false)
+			continue;
+
+		// The same layer could be requested more than once
+		bool isDuplicate = false;
+		for (unsigned int j = 0; j < jobIndices.size(); j++)
+			isDuplicate = isDuplicate || (jobIndices[j] == static_cast<unsigned int>(jobIndex));
+		if (isDuplicate == false)
+			jobIndices.pushBack(static_cast<unsigned int>(jobIndex));
+	}
+}
+
+bool LayerDecoder::decodeJobs(nctl::Array<MapModel::Layer> &layers, const nctl::Array<unsigned int> &jobIndices, const nc::Recti *rect)
+{
+	// Reserving on the calling thread, so that the decoders only reallocate if the data has more GIDs than expected.
+	// Each job still resizes its own arrays, which is safe as no other job touches them.
+	for (unsigned int i = 0; i < jobIndices.size(); i++)
+	{
+		const Job &job = jobs_[jobIndices[i]];
+		MapModel::Layer &layer = layers[job.layerIndex];
+		if (rect != nullptr)
+		{
+			// The region of a finite layer becomes its only chunk, the chunks of an infinite one are clipped by the decoder
+			if (job.chunkStrings.isEmpty())
+			{
+				const nc::Recti layerRect = intersect(*rect, nc::Recti(0, 0, layer.width, layer.height));
+				layer.chunks.clear();
+				if (layerRect.w > 0)
+				{
+					layer.chunks.emplaceBack();
+					MapModel::Chunk &chunk = layer.chunks.back();
+					chunk.x = layerRect.x;
+					chunk.y = layerRect.y;
+					chunk.width = layerRect.w;
+					chunk.height = layerRect.h;
+					chunk.tileGids.setCapacity(layerRect.w * layerRect.h);
+				}
+			}
+		}
+		else if (job.chunkStrings.isEmpty())
+		{
+			const unsigned int numElements = layer.width * layer.height;
+			if (layer.data.tileGids.capacity() < numElements)
+				layer.data.tileGids.setCapacity(numElements);
+		}
+		else
+		{
+			for (unsigned int j = 0; j < layer.chunks.size(); j++)
+			{
+				MapModel::Chunk &chunk = layer.chunks[j];
+				const unsigned int numElements = chunk.width * chunk.height;
+				if (chunk.tileGids.capacity() < numElements)
+					chunk.tileGids.setCapacity(numElements);
+			}
+		}
+	}
+
+	DecodeJobsData jobsData;
+	jobsData.decoder = this;
+	jobsData.layers = &layers;
+	jobsData.jobIndices = &jobIndices;
+	jobsData.rect = rect;
+	WorkerPool::run(jobIndices.size(), (rect != nullptr) ? decodeRegionJob : decodeJob, &jobsData);
+
+	bool allDecoded = true;
+	for (unsigned int i = 0; i < jobIndices.size(); i++)
+	{
+		Job &job = jobs_[jobIndices[i]];
+		logReport(job, layers[job.layerIndex], rect != nullptr);
+		if (job.hasDecoded == false)
+			allDecoded = false;
+		job.isPending = false;
+		numPendingJobs_--;
+	}
+
+	if (numPendingJobs_ == 0)
+		jobs_.clear();
+	return allDecoded;
+}
+
+void LayerDecoder::logReport(const Job &job, const MapModel::Layer &layer, bool isRegion)
+{
+	const DataDecoder::Report &report = job.report;
+	if (report.error[0] != '\0')
+		LOGE_X("Cannot decode the data of layer #%d: %s", layer.id, report.error);
+	if (report.warning[0] != '\0')
+		LOGW_X("%s in layer #%d", report.warning, layer.id);
+	if (report.numDuplicateChunks > 0)
+		LOGW_X("Layer #%d has more than one chunk at the same position, %u of them are not indexed", layer.id, report.numDuplicateChunks);
+
+	if (job.hasDecoded == false)
+		return;
+	else if (isRegion)
+		LOGI_X("There are %u non-empty chunks inside the region in layer #%d", layer.chunks.size(), layer.id);
+	else if (job.chunkStrings.isEmpty())
+		LOGI_X("There are %u elements in layer #%d", report.numElements, layer.id);
+	else
+		LOGI_X("There are %u non-empty chunks in layer #%d", layer.chunks.size(), layer.id);
+}
+
+/// Decodes a layer or all of its chunks, it only writes to its own layer and job
+void LayerDecoder::decodeJob(unsigned int jobIndex, void *userData)
+{
+	DecodeJobsData &data = *static_cast<DecodeJobsData *>(userData);
+	Job &job = data.decoder->jobs_[(*data.jobIndices)[jobIndex]];
+	MapModel::Layer &layer = (*data.layers)[job.layerIndex];
+
+	if (job.chunkStrings.isEmpty())
+	{
+		if (job.string != nullptr)
+			job.hasDecoded = DataDecoder::decodeLayerData(layer.data, job.string, layer.width * layer.height, layer.data.tileGids, job.report);
+		return;
+	}
+
+	// Chunks without tiles are not stored, so that memory only depends on the painted area of the map
+	unsigned int numChunks = 0;
+	job.hasDecoded = true;
+	for (unsigned int i = 0; i < layer.chunks.size() && i < job.chunkStrings.size(); i++)
+	{
+		MapModel::Chunk &chunk = layer.chunks[i];
+		const bool hasParsed = DataDecoder::decodeLayerData(layer.data, job.chunkStrings[i], chunk.width * chunk.height, chunk.tileGids, job.report);
+		job.hasDecoded = job.hasDecoded && hasParsed;
+		if (hasParsed && DataDecoder::hasTiles(chunk.tileGids))
+		{
+			if (numChunks != i)
+				layer.chunks[numChunks] = nctl::move(chunk);
+			numChunks++;
+		}
+	}
+	while (layer.chunks.size() > numChunks)
+		layer.chunks.popBack();
+
+	job.report.numDuplicateChunks = layer.createChunkIndices();
+}
+
+/// Decodes the part of a layer or of its chunks that is inside the rectangle, it only writes to its own layer and job
+void LayerDecoder::decodeRegionJob(unsigned int jobIndex, void *userData)
+{
+	DecodeJobsData &data = *static_cast<DecodeJobsData *>(userData);
+	Job &job = data.decoder->jobs_[(*data.jobIndices)[jobIndex]];
+	MapModel::Layer &layer = (*data.layers)[job.layerIndex];
+	const nc::Recti &rect = *data.rect;
+
+	if (job.chunkStrings.isEmpty())
+	{
+		// A layer outside of the rectangle has nothing to decode
+		job.hasDecoded = true;
+		if (job.string != nullptr && layer.chunks.isEmpty() == false)
+		{
+			MapModel::Chunk &chunk = layer.chunks[0];
+			const nc::Recti chunkRect(chunk.x, chunk.y, chunk.width, chunk.height);
+			job.hasDecoded = DataDecoder::decodeLayerDataRegion(layer.data, job.string, layer.width, chunkRect, chunk.tileGids, job.report);
+			if (job.hasDecoded == false)
+				layer.chunks.clear();
+		}
+		job.report.numDuplicateChunks = layer.createChunkIndices();
+		return;
+	}
+
+	// Chunks outside of the rectangle or without tiles inside of it are not stored
+	unsigned int numChunks = 0;
+	job.hasDecoded = true;
+	for (unsigned int i = 0; i < layer.chunks.size() && i < job.chunkStrings.size(); i++)
+	{
+		MapModel::Chunk &chunk = layer.chunks[i];
+		const nc::Recti chunkRect = intersect(rect, nc::Recti(chunk.x, chunk.y, chunk.width, chunk.height));
+		if (chunkRect.w == 0)
+			continue;
+
+		const nc::Recti localRect(chunkRect.x - chunk.x, chunkRect.y - chunk.y, chunkRect.w, chunkRect.h);
+		const bool hasParsed = DataDecoder::decodeLayerDataRegion(layer.data, job.chunkStrings[i], chunk.width, localRect, chunk.tileGids, job.report);
+		job.hasDecoded = job.hasDecoded && hasParsed;
+		if (hasParsed && DataDecoder::hasTiles(chunk.tileGids))
+		{
+			chunk.x = chunkRect.x;
+			chunk.y = chunkRect.y;
+			chunk.width = chunkRect.w;
+			chunk.height = chunkRect.h;
+			if (numChunks != i)
+				layer.chunks[numChunks] = nctl::move(chunk);
+			numChunks++;
+		}
+	}
+	while (layer.chunks.size() > numChunks)
+		layer.chunks.popBack();
+
+	job.report.numDuplicateChunks = layer.createChunkIndices();
+}
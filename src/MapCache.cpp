@@ -0,0 +1,812 @@
+#include <cstdint>
+#include <cstring> // for `memcpy()`
+#include <nctl/Array.h>
+#include <nctl/CString.h>
+#include <ncine/IFile.h>
+#include <ncine/FileSystem.h>
+
+#include "MapCache.h"
+#include "MapModel.h"
+#include "MappedFile.h"
+#include "FileUtils.h"
+
+namespace {
+
+const char Magic[8] = { 'N', 'C', 'T', 'M', 'A', 'P', 'B', 'N' };
+const uint32_t EndiannessMarker = 0x01020304;
+/// The alignment of tile GID arrays inside the file
+const unsigned int DataAlignment = 16;
+
+struct Header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t endianness;
+	/// The size of the TMX file when the cache was created
+	uint64_t tmxSize;
+	uint64_t payloadSize;
+	uint64_t payloadHash;
+	uint8_t padding[24];
+};
+
+static_assert(sizeof(Header) % DataAlignment == 0, "The header size should be a multiple of the data alignment");
+
+inline uint64_t rotateLeft(uint64_t value, unsigned int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+/// Hashes the payload as four interleaved streams of 64 bits words, to avoid a single long dependency chain
+uint64_t hashPayload(const unsigned char *data, unsigned long int size)
+{
+	const uint64_t Prime = 0x100000001b3ULL;
+	uint64_t lanes[4] = { 0xcbf29ce484222325ULL, 0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL };
+
+	unsigned long int offset = 0;
+	for (; offset + 32 <= size; offset += 32)
+	{
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			uint64_t word;
+			memcpy(&word, data + offset + i * 8, sizeof(uint64_t));
+			lanes[i] = rotateLeft((lanes[i] ^ word) * Prime, 29);
+		}
+	}
+
+	uint64_t hash = lanes[0] ^ rotateLeft(lanes[1], 16) ^ rotateLeft(lanes[2], 32) ^ rotateLeft(lanes[3], 48);
+	for (; offset < size; offset++)
+		hash = (hash ^ data[offset]) * Prime;
+	hash = (hash ^ size) * Prime;
+
+	return hash;
+}
+
+/// Returns true if a file has been modified after the cache or in the same second
+/*! Dates only have a resolution of one second, so a file saved right after the cache could have the same date. */
+bool isStale(const nc::fs::FileDate &fileDate, const nc::fs::FileDate &cacheDate)
+{
+	return (FileUtils::compareDates(fileDate, cacheDate) >= 0);
+}
+
+/// The archive that appends values to a buffer
+class Writer
+{
+  public:
+	static const bool IsReading = false;
+
+	explicit Writer(nctl::Array<unsigned char> &buffer)
+	    : buffer_(buffer) {}
+
+	inline bool isValid() const { return true; }
+
+	void bytes(const void *data, unsigned long int size)
+	{
+		const unsigned int offset = buffer_.size();
+		if (offset + size > buffer_.capacity())
+		{
+			const unsigned int newCapacity = buffer_.capacity() * 2;
+			buffer_.setCapacity(newCapacity > offset + size ? newCapacity : offset + size);
+		}
+		buffer_.setSize(offset + size);
+		if (size > 0)
+			memcpy(buffer_.data() + offset, data, size);
+	}
+
+	void align()
+	{
+		static const unsigned char Zeroes[DataAlignment] = {};
+		const unsigned int remainder = buffer_.size() % DataAlignment;
+		if (remainder != 0)
+			bytes(Zeroes, DataAlignment - remainder);
+	}
+
+	template <class T>
+	void value(T &value) { bytes(&value, sizeof(T)); }
+
+	void chars(char *string, unsigned int maxLength)
+	{
+		uint32_t length = nctl::strnlen(string, maxLength - 1);
+		value(length);
+		bytes(string, length);
+	}
+
+	void string(nctl::UniquePtr<char[]> &string)
+	{
+		uint32_t length = string ? static_cast<uint32_t>(strlen(string.get())) + 1 : 0;
+		value(length);
+		if (length > 0)
+			bytes(string.get(), length);
+	}
+
+	void strings(StringTable &strings)
+	{
+		uint32_t size = strings.size();
+		value(size);
+		// The empty string is implicit
+		for (unsigned int i = 1; i < strings.size(); i++)
+		{
+			uint32_t length = strings.length(i);
+			value(length);
+			bytes(strings.string(i), length);
+		}
+	}
+
+	void id(MapModel::StringId &id) { value(id); }
+
+	void color(nc::Color &color)
+	{
+		const uint8_t channels[4] = { color.r(), color.g(), color.b(), color.a() };
+		bytes(channels, 4);
+	}
+
+	template <class T>
+	void array(nctl::Array<T> &array);
+
+	void gids(nctl::Array<unsigned int> &gids)
+	{
+		uint32_t size = gids.size();
+		value(size);
+		align();
+		bytes(gids.data(), size * sizeof(unsigned int));
+	}
+
+	/// Writes an array of plain values with a single copy
+	template <class T>
+	void values(nctl::Array<T> &array)
+	{
+		uint32_t size = array.size();
+		value(size);
+		bytes(array.data(), size * sizeof(T));
+	}
+
+	inline void invalidate() {}
+
+  private:
+	nctl::Array<unsigned char> &buffer_;
+};
+
+/// The archive that reads values from a buffer, checking that they are all inside of it
+class Reader
+{
+  public:
+	static const bool IsReading = true;
+
+	Reader(const unsigned char *data, unsigned long int size, unsigned long int offset)
+	    : data_(data), size_(size), offset_(offset), numStrings_(0), isValid_(offset <= size) {}
+
+	inline bool isValid() const { return isValid_; }
+	inline bool isAtEnd() const { return offset_ == size_; }
+	inline unsigned long int remaining() const { return size_ - offset_; }
+
+	void bytes(void *data, unsigned long int size)
+	{
+		if (isValid_ == false || size > remaining())
+		{
+			isValid_ = false;
+			memset(data, 0, size);
+			return;
+		}
+		if (size > 0)
+			memcpy(data, data_ + offset_, size);
+		offset_ += size;
+	}
+
+	void align()
+	{
+		const unsigned long int remainder = offset_ % DataAlignment;
+		if (remainder != 0)
+		{
+			if (DataAlignment - remainder > remaining())
+				isValid_ = false;
+			else
+				offset_ += DataAlignment - remainder;
+		}
+	}
+
+	template <class T>
+	void value(T &value) { bytes(&value, sizeof(T)); }
+
+	void chars(char *string, unsigned int maxLength)
+	{
+		uint32_t length = 0;
+		value(length);
+		if (length >= maxLength)
+			isValid_ = false;
+		else
+			bytes(string, length);
+		string[isValid_ ? length : 0] = '\0';
+	}
+
+	void string(nctl::UniquePtr<char[]> &string)
+	{
+		uint32_t length = 0;
+		value(length);
+		if (length > remaining())
+			isValid_ = false;
+		if (isValid_ == false || length == 0)
+			return;
+
+		string = nctl::makeUnique<char[]>(length);
+		bytes(string.get(), length);
+		string[length - 1] = '\0';
+	}
+
+	/// Strings are interned in order, so that every handle in the file refers to the same string in the table
+	void strings(StringTable &strings)
+	{
+		uint32_t size = 0;
+		value(size);
+		if (size == 0 || size - 1 > remaining())
+			isValid_ = false;
+
+		strings.clear();
+		for (unsigned int i = 1; i < size && isValid_; i++)
+		{
+			uint32_t length = 0;
+			value(length);
+			if (length == 0 || length > remaining())
+			{
+				isValid_ = false;
+				break;
+			}
+
+			if (strings.intern(reinterpret_cast<const char *>(data_ + offset_), length) != i)
+				isValid_ = false; // duplicated or truncated strings
+			offset_ += length;
+		}
+		numStrings_ = isValid_ ? size : 0;
+	}
+
+	void id(MapModel::StringId &id)
+	{
+		value(id);
+		if (id >= numStrings_)
+		{
+			isValid_ = false;
+			id = StringTable::EmptyId;
+		}
+	}
+
+	void color(nc::Color &color)
+	{
+		uint8_t channels[4];
+		bytes(channels, 4);
+		color = nc::Color(channels[0], channels[1], channels[2], channels[3]);
+	}
+
+	template <class T>
+	void array(nctl::Array<T> &array);
+
+	void gids(nctl::Array<unsigned int> &gids)
+	{
+		uint32_t size = 0;
+		value(size);
+		align();
+		if (isValid_ == false || size > remaining() / sizeof(unsigned int))
+		{
+			isValid_ = false;
+			return;
+		}
+
+		gids.clear();
+		gids.setSize(size);
+		bytes(gids.data(), size * sizeof(unsigned int));
+	}
+
+	template <class T>
+	void values(nctl::Array<T> &array)
+	{
+		uint32_t size = 0;
+		value(size);
+		if (isValid_ == false || size > remaining() / sizeof(T))
+		{
+			isValid_ = false;
+			return;
+		}
+
+		array.clear();
+		array.setSize(size);
+		bytes(array.data(), size * sizeof(T));
+	}
+
+	/// Marks the archive as invalid when the data that has been read is not consistent
+	inline void invalidate() { isValid_ = false; }
+
+  private:
+	const unsigned char *data_;
+	unsigned long int size_;
+	unsigned long int offset_;
+	/// The number of strings in the table that has been read, handles should be smaller
+	unsigned int numStrings_;
+	bool isValid_;
+};
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Property &property)
+{
+	ar.id(property.name);
+	ar.value(property.type);
+	if (property.hasStringValue())
+		ar.id(property.value.string);
+	else
+		ar.value(property.value);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Image &image)
+{
+	ar.chars(image.format, MapModel::Image::MaxFormatLength);
+	ar.id(image.source);
+	ar.value(image.hasTransparency);
+	ar.color(image.trans);
+	ar.value(image.width);
+	ar.value(image.height);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Terrain &terrain)
+{
+	ar.id(terrain.name);
+	ar.value(terrain.tile);
+	ar.array(terrain.properties);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Frame &frame)
+{
+	ar.value(frame.tileId);
+	ar.value(frame.duration);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Tile &tile)
+{
+	ar.value(tile.id);
+	ar.value(tile.type);
+	ar.value(tile.terrain);
+	ar.value(tile.probability);
+	ar.array(tile.frames);
+	ar.array(tile.properties);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::TileSet &tileSet)
+{
+	ar.value(tileSet.firstGid);
+	ar.id(tileSet.source);
+	ar.id(tileSet.name);
+	ar.value(tileSet.tileWidth);
+	ar.value(tileSet.tileHeight);
+	ar.value(tileSet.spacing);
+	ar.value(tileSet.margin);
+	ar.value(tileSet.tileCount);
+	ar.value(tileSet.columns);
+	ar.value(tileSet.objectAlignment);
+	serialize(ar, tileSet.image);
+	ar.value(tileSet.tileOffset.x);
+	ar.value(tileSet.tileOffset.y);
+	ar.value(tileSet.grid.orientation);
+	ar.value(tileSet.grid.width);
+	ar.value(tileSet.grid.height);
+	ar.array(tileSet.terrainTypes);
+	ar.array(tileSet.tiles);
+	ar.array(tileSet.properties);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Chunk &chunk)
+{
+	ar.value(chunk.x);
+	ar.value(chunk.y);
+	ar.value(chunk.width);
+	ar.value(chunk.height);
+	ar.gids(chunk.tileGids);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Layer &layer)
+{
+	ar.value(layer.id);
+	ar.id(layer.name);
+	ar.value(layer.x);
+	ar.value(layer.y);
+	ar.value(layer.width);
+	ar.value(layer.height);
+	ar.value(layer.opacity);
+	ar.value(layer.visible);
+	ar.color(layer.tintColor);
+	ar.value(layer.offsetX);
+	ar.value(layer.offsetY);
+	ar.value(layer.groupIndex);
+
+	ar.value(layer.data.encoding);
+	ar.value(layer.data.compression);
+	ar.string(layer.data.string);
+	ar.gids(layer.data.tileGids);
+
+	ar.array(layer.properties);
+	ar.array(layer.chunks);
+	if (Archive::IsReading && ar.isValid() && layer.createChunkIndices() > 0)
+		LOGW_X("Layer #%d has more than one chunk at the same position", layer.id);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Text &text)
+{
+	ar.chars(text.data, MapModel::Text::MaxDataLength);
+	ar.id(text.fontFamily);
+	ar.value(text.pixelSize);
+	ar.value(text.wrap);
+	ar.color(text.color);
+	ar.value(text.bold);
+	ar.value(text.italic);
+	ar.value(text.underline);
+	ar.value(text.strikeout);
+	ar.value(text.kerning);
+	ar.value(text.hAlign);
+	ar.value(text.vAlign);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Object &object)
+{
+	ar.value(object.id);
+	ar.id(object.name);
+	ar.id(object.type);
+	ar.value(object.x);
+	ar.value(object.y);
+	ar.value(object.width);
+	ar.value(object.height);
+	ar.value(object.rotation);
+	ar.value(object.gid);
+	ar.value(object.visible);
+	ar.id(object.templateFile);
+	ar.value(object.overrides);
+	ar.value(object.objectType);
+	ar.values(object.points);
+	serialize(ar, object.text);
+	ar.array(object.properties);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::ObjectTemplate &objectTemplate)
+{
+	ar.id(objectTemplate.source);
+	ar.id(objectTemplate.tileSetSource);
+	ar.value(objectTemplate.tileSetFirstGid);
+	serialize(ar, objectTemplate.object);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::ObjectDetails &details)
+{
+	ar.value(details.id);
+	ar.id(details.name);
+	ar.id(details.type);
+	ar.id(details.templateFile);
+	ar.value(details.overrides);
+	ar.value(details.templateIndex);
+	ar.value(details.firstPoint);
+	ar.value(details.numPoints);
+	ar.value(details.textIndex);
+	ar.value(details.firstProperty);
+	ar.value(details.numProperties);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::ObjectArray &objects)
+{
+	ar.values(objects.positions);
+	ar.values(objects.sizes);
+	ar.values(objects.rotations);
+	ar.values(objects.gids);
+	ar.values(objects.objectTypes);
+	ar.values(objects.visible);
+	ar.array(objects.details);
+	ar.values(objects.points);
+	ar.array(objects.texts);
+	ar.array(objects.properties);
+	if (Archive::IsReading && ar.isValid() && objects.isConsistent() == false)
+		ar.invalidate();
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::ObjectGroup &objectGroup)
+{
+	ar.value(objectGroup.id);
+	ar.id(objectGroup.name);
+	ar.color(objectGroup.color);
+	ar.value(objectGroup.x);
+	ar.value(objectGroup.y);
+	ar.value(objectGroup.width);
+	ar.value(objectGroup.height);
+	ar.value(objectGroup.opacity);
+	ar.value(objectGroup.visible);
+	ar.color(objectGroup.tintColor);
+	ar.value(objectGroup.offsetX);
+	ar.value(objectGroup.offsetY);
+	ar.value(objectGroup.drawOrder);
+	ar.value(objectGroup.groupIndex);
+	serialize(ar, objectGroup.objects);
+	ar.array(objectGroup.properties);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::ImageLayer &imageLayer)
+{
+	ar.value(imageLayer.id);
+	ar.id(imageLayer.name);
+	ar.value(imageLayer.offsetX);
+	ar.value(imageLayer.offsetY);
+	ar.value(imageLayer.x);
+	ar.value(imageLayer.y);
+	ar.value(imageLayer.opacity);
+	ar.value(imageLayer.visible);
+	ar.color(imageLayer.tintColor);
+	ar.value(imageLayer.groupIndex);
+	serialize(ar, imageLayer.image);
+	ar.array(imageLayer.properties);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Group &group)
+{
+	ar.value(group.id);
+	ar.id(group.name);
+	ar.value(group.offsetX);
+	ar.value(group.offsetY);
+	ar.value(group.opacity);
+	ar.value(group.visible);
+	ar.color(group.tintColor);
+	ar.value(group.parentIndex);
+	ar.array(group.properties);
+}
+
+/// Only the layer of an entry is stored, the accumulated values are computed again after reading
+template <class Archive>
+void serialize(Archive &ar, MapModel::DrawEntry &entry)
+{
+	ar.value(entry.type);
+	ar.value(entry.index);
+}
+
+/// Checks the template indices, and that an instance with the shape of its template has the same type as the template
+bool hasValidTemplateIndices(const MapModel::Map &map)
+{
+	for (unsigned int i = 0; i < map.objectGroups.size(); i++)
+	{
+		const MapModel::ObjectArray &objects = map.objectGroups[i].objects;
+		for (unsigned int j = 0; j < objects.size(); j++)
+		{
+			const int templateIndex = objects.details[j].templateIndex;
+			if (templateIndex >= static_cast<int>(map.templates.size()))
+				return false;
+			if (objects.hasTemplateShape(j) && objects.objectTypes[j] != map.templates[templateIndex].object.objectType)
+				return false;
+		}
+	}
+	return true;
+}
+
+template <class Archive>
+void serialize(Archive &ar, MapModel::Map &map)
+{
+	ar.chars(map.version, MapModel::Map::MaxVersionLength);
+	ar.chars(map.tiledVersion, MapModel::Map::MaxVersionLength);
+	ar.value(map.orientation);
+	ar.value(map.renderOrder);
+	ar.value(map.compressionLevel);
+	ar.value(map.width);
+	ar.value(map.height);
+	ar.value(map.tileWidth);
+	ar.value(map.tileHeight);
+	ar.value(map.hexSideLength);
+	ar.value(map.staggerAxis);
+	ar.value(map.staggerIndex);
+	ar.color(map.backgroundColor);
+	ar.value(map.nextLayerId);
+	ar.value(map.nextObjectId);
+	ar.value(map.infinite);
+
+	ar.array(map.tileSets);
+	ar.array(map.layers);
+	ar.array(map.objectGroups);
+	ar.array(map.imageLayers);
+	ar.array(map.properties);
+	ar.array(map.templates);
+	if (Archive::IsReading && ar.isValid() && hasValidTemplateIndices(map) == false)
+		ar.invalidate();
+	ar.array(map.groups);
+	ar.array(map.drawList);
+	if (Archive::IsReading && ar.isValid())
+	{
+		if (map.hasValidDrawList())
+			map.accumulateGroupValues();
+		else
+			ar.invalidate();
+	}
+}
+
+template <class T>
+void Writer::array(nctl::Array<T> &array)
+{
+	uint32_t size = array.size();
+	value(size);
+	for (unsigned int i = 0; i < array.size(); i++)
+		serialize(*this, array[i]);
+}
+
+template <class T>
+void Reader::array(nctl::Array<T> &array)
+{
+	uint32_t size = 0;
+	value(size);
+	// Every element takes at least one byte, a bigger size can only come from a corrupted file
+	if (size > remaining())
+		isValid_ = false;
+	if (isValid_ == false)
+		return;
+
+	array.clear();
+	array.setCapacity(size);
+	for (unsigned int i = 0; i < size && isValid_; i++)
+	{
+		array.emplaceBack();
+		serialize(*this, array.back());
+	}
+}
+
+}
+
+const char *MapCache::Extension = ".cache";
+
+nctl::String MapCache::cacheFilename(const char *tmxFilename)
+{
+	nctl::String filename(tmxFilename);
+	filename.append(Extension);
+	return filename;
+}
+
+bool MapCache::load(MapModel &mapModel, const char *tmxFilename)
+{
+	const nctl::String filename = cacheFilename(tmxFilename);
+	if (nc::fs::isReadableFile(filename.data()) == false)
+		return false;
+
+	const nc::fs::FileDate cacheDate = nc::fs::lastModificationTime(filename.data());
+	if (isStale(nc::fs::lastModificationTime(tmxFilename), cacheDate))
+	{
+		LOGI_X("Map cache \"%s\" is not newer than the map", filename.data());
+		return false;
+	}
+
+	MappedFile cacheFile;
+	if (cacheFile.open(filename.data()) == false || cacheFile.size() < sizeof(Header))
+		return false;
+
+	Header header;
+	memcpy(&header, cacheFile.data(), sizeof(Header));
+	if (memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.endianness != EndiannessMarker)
+	{
+		LOGW_X("File \"%s\" is not a valid map cache", filename.data());
+		return false;
+	}
+	if (header.version != Version || header.tmxSize != static_cast<uint64_t>(nc::fs::fileSize(tmxFilename)))
+	{
+		LOGI_X("Map cache \"%s\" is outdated", filename.data());
+		return false;
+	}
+	if (header.payloadSize != cacheFile.size() - sizeof(Header) ||
+	    header.payloadHash != hashPayload(cacheFile.data() + sizeof(Header), cacheFile.size() - sizeof(Header)))
+	{
+		LOGW_X("Map cache \"%s\" is corrupted", filename.data());
+		return false;
+	}
+
+	Reader reader(cacheFile.data(), cacheFile.size(), sizeof(Header));
+	reader.strings(mapModel.strings());
+	serialize(reader, mapModel.map());
+	if (reader.isValid() == false || reader.isAtEnd() == false)
+	{
+		LOGW_X("Cannot read the map cache \"%s\"", filename.data());
+		return false;
+	}
+
+	// The cache is only valid if external tilesets have not changed since it was created
+	const nctl::String tmxDirName = nc::fs::dirName(tmxFilename);
+	nctl::String tsxDirName = tmxDirName;
+	for (unsigned int i = 0; i < mapModel.map().tileSets.size(); i++)
+	{
+		const MapModel::TileSet &tileSet = mapModel.map().tileSets[i];
+		if (tileSet.source == StringTable::EmptyId)
+			continue;
+
+		const nctl::String tsxFilePath = nc::fs::joinPath(tmxDirName, nctl::String(mapModel.string(tileSet.source)));
+		if (nc::fs::isReadableFile(tsxFilePath.data()) == false || isStale(nc::fs::lastModificationTime(tsxFilePath.data()), cacheDate))
+		{
+			LOGI_X("Map cache \"%s\" is not newer than tileset \"%s\"", filename.data(), tsxFilePath.data());
+			return false;
+		}
+		tsxDirName = nc::fs::dirName(tsxFilePath.data());
+	}
+
+	// Templates are applied to their instances when parsing, so the cache is also invalid if any of them has changed
+	const MapModel::Map &map = mapModel.map();
+	for (unsigned int i = 0; i < map.templates.size(); i++)
+	{
+		const nctl::String templatePath = nc::fs::joinPath(tmxDirName, nctl::String(mapModel.string(map.templates[i].source)));
+		if (nc::fs::isReadableFile(templatePath.data()) == false || isStale(nc::fs::lastModificationTime(templatePath.data()), cacheDate))
+		{
+			LOGI_X("Map cache \"%s\" is not newer than template \"%s\"", filename.data(), templatePath.data());
+			return false;
+		}
+	}
+	// A template that could not be loaded is not in the cache, it might be there now
+	for (unsigned int i = 0; i < map.objectGroups.size(); i++)
+	{
+		const MapModel::ObjectArray &objects = map.objectGroups[i].objects;
+		for (unsigned int j = 0; j < objects.size(); j++)
+		{
+			if (objects.details[j].templateFile != StringTable::EmptyId && objects.details[j].templateIndex < 0)
+			{
+				LOGI_X("Map cache \"%s\" has an unresolved template \"%s\"", filename.data(), mapModel.string(objects.details[j].templateFile));
+				return false;
+			}
+		}
+	}
+
+	mapModel.tmxDirName() = tmxDirName;
+	mapModel.tsxDirName() = tsxDirName;
+
+	return true;
+}
+
+bool MapCache::save(const MapModel &mapModel, const char *tmxFilename)
+{
+	if (mapModel.hasPendingLayers())
+	{
+		LOGW_X("Cannot save the cache of \"%s\" before all its layers are decoded", tmxFilename);
+		return false;
+	}
+	else if (mapModel.isPartial())
+	{
+		LOGW_X("Cannot save the cache of \"%s\" when only a region of it has been decoded", tmxFilename);
+		return false;
+	}
+
+	nctl::Array<unsigned char> buffer;
+	Writer writer(buffer);
+
+	Header header = {};
+	writer.bytes(&header, sizeof(Header));
+	// The writer never modifies the values it serializes
+	writer.strings(const_cast<StringTable &>(mapModel.strings()));
+	serialize(writer, const_cast<MapModel::Map &>(mapModel.map()));
+
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.endianness = EndiannessMarker;
+	header.tmxSize = static_cast<uint64_t>(nc::fs::fileSize(tmxFilename));
+	header.payloadSize = buffer.size() - sizeof(Header);
+	header.payloadHash = hashPayload(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+	memcpy(buffer.data(), &header, sizeof(Header));
+
+	const nctl::String filename = cacheFilename(tmxFilename);
+	nctl::UniquePtr<nc::IFile> file = nc::IFile::createFileHandle(filename.data());
+	file->open(nc::IFile::OpenMode::WRITE | nc::IFile::OpenMode::BINARY);
+	if (file->isOpened() == false)
+	{
+		LOGW_X("Cannot create the map cache \"%s\"", filename.data());
+		return false;
+	}
+
+	const unsigned long int bytesWritten = file->write(buffer.data(), buffer.size());
+	file->close();
+	if (bytesWritten != buffer.size())
+	{
+		LOGW_X("Cannot write the map cache \"%s\"", filename.data());
+		return false;
+	}
+
+	return true;
+}
@@ -14,7 +14,8 @@
 namespace {
 
 ImVec2 points[MapFactory::MaxOverlayPoints];
-nctl::Array<nctl::String> tileSetTextureFiles;
+/// The image sources of the loaded textures, equal sources are found by comparing their handles
+nctl::Array<MapModel::StringId> tileSetTextureSources;
 nctl::Array<unsigned int> tileSetTextureIndices;
 
 nc::Recti calculateTileRect(const MapModel::TileSet &tileSet, unsigned int column, unsigned int row)
@@ -24,10 +25,299 @@ nc::Recti calculateTileRect(const MapModel::TileSet &tileSet, unsigned int colum
 	                 tileSet.tileWidth, tileSet.tileHeight);
 }
 
-nc::Vector2f calculateTilePosition(const MapModel::Map &map, const MapModel::Layer &layer, const MapModel::TileSet &tileSet, unsigned int column, unsigned int row)
+nc::Vector2f calculateTilePosition(const MapModel::Map &map, const MapModel::DrawEntry &entry, const MapModel::Layer &layer, const MapModel::TileSet &tileSet, int column, int row)
 {
-	return nc::Vector2f(layer.offsetX + tileSet.tileOffset.x + (layer.x + column) * tileSet.tileWidth + tileSet.tileWidth * 0.5f - (tileSet.tileWidth * map.width * 0.5f),
-	                    layer.offsetY + tileSet.tileOffset.y - ((layer.y + row) * tileSet.tileHeight + tileSet.tileHeight * 0.5f - (tileSet.tileHeight * map.height * 0.5f)));
+	return nc::Vector2f(entry.offsetX + tileSet.tileOffset.x + (layer.x + column) * tileSet.tileWidth + tileSet.tileWidth * 0.5f - (tileSet.tileWidth * map.width * 0.5f),
+	                    entry.offsetY + tileSet.tileOffset.y - ((layer.y + row) * tileSet.tileHeight + tileSet.tileHeight * 0.5f - (tileSet.tileHeight * map.height * 0.5f)));
+}
+
+/// A rectangular grid of tile GIDs, either a whole layer or one of its chunks
+struct TileGrid
+{
+	const nctl::Array<unsigned int> &tileGids;
+	/// Horizontal position of the grid in tiles
+	int x;
+	/// Vertical position of the grid in tiles
+	int y;
+	int width;
+	int height;
+};
+
+void createTiles(const MapModel &mapModel, const MapFactory::Configuration &config, unsigned int drawEntryIdx, const TileGrid &grid, nc::SceneNode *layerParent, bool canUseMeshSprites)
+{
+	const MapModel::DrawEntry &entry = mapModel.map().drawList[drawEntryIdx];
+	const MapModel::Layer &layer = mapModel.map().layers[entry.index];
+	const nctl::Array<unsigned int> &tileGids = grid.tileGids;
+
+	nctl::Array<nc::MeshSprite::Vertex> vertices;
+	nctl::Array<unsigned short int> indices;
+	if (canUseMeshSprites)
+	{
+		vertices.setCapacity(tileGids.size() * 4 + grid.width * 2);
+		indices.setCapacity(tileGids.size() * 4 + grid.width * 2);
+	}
+
+	bool skippedPreviousGid = false;
+	bool skipNextGid = false;
+	int vertexIdx = 0;
+	for (unsigned int gidIdx = 0; gidIdx < tileGids.size(); gidIdx++)
+	{
+		// Check if this or next GID needs to be skipped
+		if (gidIdx + 1 < tileGids.size())
+			skipNextGid = (tileGids[gidIdx + 1] == 0);
+
+		const unsigned int preFlippingGid = tileGids[gidIdx];
+		if (preFlippingGid == 0)
+		{
+			skippedPreviousGid = true;
+			continue;
+		}
+
+		MapFactory::TileFlip tileFlip(preFlippingGid);
+		const unsigned int gid = tileFlip.gid;
+
+		unsigned int tileSetIdx = 0;
+		for (; tileSetIdx < mapModel.map().tileSets.size(); tileSetIdx++)
+		{
+			const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
+			if (tileSet.firstGid > gid)
+				break;
+		}
+		if (tileSetIdx > 0)
+			tileSetIdx--;
+
+		const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
+		const unsigned int tileSetRow = (gid - tileSet.firstGid) / tileSet.columns;
+		const unsigned int tileSetColumn = (gid - tileSet.firstGid) % tileSet.columns;
+		const int row = gidIdx / grid.width;
+		const int column = gidIdx % grid.width;
+
+		const MapModel::Tile *tile = nullptr;
+		for (unsigned int i = 0; i < tileSet.tiles.size(); i++)
+		{
+			if (gid - tileSet.firstGid == static_cast<unsigned int>(tileSet.tiles[i].id))
+			{
+				tile = &tileSet.tiles[i];
+				break;
+			}
+		}
+
+		if (tile && tile->frames.isEmpty() == false && config.animSprites)
+		{
+			nc::Texture *texture = (*config.textures)[tileSetTextureIndices[tileSetIdx]].get();
+			nctl::UniquePtr<nc::AnimatedSprite> animSprite = nctl::makeUnique<nc::AnimatedSprite>(layerParent, texture);
+			const nc::Vector2f position = calculateTilePosition(mapModel.map(), entry, layer, tileSet, grid.x + column, grid.y + row);
+			animSprite->setPosition(position);
+			animSprite->setAlphaF(entry.opacity);
+			//animSprite->setBlendingEnabled(layer.opacity < 1.0f ? true : false);
+			animSprite->setLayer(config.firstLayerDepth + drawEntryIdx);
+			animSprite->setFlippedX(tileFlip.isDiagonallyFlipped || tileFlip.isHorizontallyFlipped);
+			animSprite->setFlippedY(tileFlip.isDiagonallyFlipped || tileFlip.isVerticallyFlipped);
+
+			nc::RectAnimation anim(1.0f / 60.0f, nc::RectAnimation::LoopMode::ENABLED, nc::RectAnimation::RewindMode::FROM_START);
+			for (unsigned int frameIdx = 0; frameIdx < tile->frames.size(); frameIdx++)
+			{
+				const MapModel::Frame &frame = tile->frames[frameIdx];
+
+				const unsigned int frameTileSetRow = (gid - tileSet.firstGid + frame.tileId) / tileSet.columns;
+				const unsigned int frameTileSetColumn = (gid - tileSet.firstGid + frame.tileId) % tileSet.columns;
+
+				const nc::Recti frameTexRect = calculateTileRect(tileSet, frameTileSetColumn, frameTileSetRow);
+				anim.addRect(frameTexRect, frame.duration * 0.001f);
+			}
+			animSprite->addAnimation(anim);
+			animSprite->setPaused(false);
+			config.animSprites->pushBack(nctl::move(animSprite));
+		}
+		else if (canUseMeshSprites)
+		{
+			nc::Vector2f pos = calculateTilePosition(mapModel.map(), entry, layer, tileSet, grid.x + column, grid.y + row);
+			pos.x = (pos.x - tileSet.tileWidth * 0.5f) / float(grid.width * tileSet.tileWidth);
+			pos.y = (pos.y + tileSet.tileHeight * 0.5f) / float(grid.height * tileSet.tileHeight);
+			const float tileWidth = tileSet.tileWidth / float(grid.width * tileSet.tileWidth);
+			const float tileHeight = tileSet.tileHeight / float(grid.height * tileSet.tileHeight);
+
+			const nc::Recti texRect = calculateTileRect(tileSet, tileSetColumn, tileSetRow);
+			float u = texRect.x / float(tileSet.image.width);
+			float v = texRect.y / float(tileSet.image.height);
+			float du = texRect.w / float(tileSet.image.width);
+			float dv = texRect.h / float(tileSet.image.height);
+
+			if (tileFlip.isDiagonallyFlipped || tileFlip.isHorizontallyFlipped)
+			{
+				u += du;
+				du *= -1;
+			}
+			if (tileFlip.isDiagonallyFlipped || tileFlip.isVerticallyFlipped)
+			{
+				v += dv;
+				dv *= -1;
+			}
+
+			// Insert a degenerate vertex if previous tile was on the previous column or completely skipped
+			if ((gidIdx > 0 && column == 0) || skippedPreviousGid)
+			{
+				vertices.emplaceBack(pos.x, pos.y, u, v + dv);
+				indices.pushBack(vertexIdx++);
+				skippedPreviousGid = false;
+			}
+
+			vertices.emplaceBack(pos.x, pos.y, u, v + dv);
+			vertices.emplaceBack(pos.x, pos.y + tileHeight, u, v);
+			vertices.emplaceBack(pos.x + tileWidth, pos.y, u + du, v + dv);
+			vertices.emplaceBack(pos.x + tileWidth, pos.y + tileHeight, u + du, v);
+
+			indices.pushBack(vertexIdx++);
+			indices.pushBack(vertexIdx++);
+			indices.pushBack(vertexIdx++);
+			indices.pushBack(vertexIdx++);
+
+			// Insert a degenerate vertex if next tile is on the next column or going to be completely skipped
+			if ((gidIdx < tileGids.size() - 1 && column == grid.width - 1) || skipNextGid)
+			{
+				vertices.emplaceBack(pos.x + tileWidth, pos.y + tileHeight, u + du, v);
+				indices.pushBack(vertexIdx++);
+			}
+		}
+		else if (config.sprites)
+		{
+			const nc::Recti texRect = calculateTileRect(tileSet, tileSetColumn, tileSetRow);
+			nc::Texture *texture = (*config.textures)[tileSetTextureIndices[tileSetIdx]].get();
+			nctl::UniquePtr<nc::Sprite> sprite = nctl::makeUnique<nc::Sprite>(layerParent, texture);
+			sprite->setTexRect(texRect);
+			const nc::Vector2f position = calculateTilePosition(mapModel.map(), entry, layer, tileSet, grid.x + column, grid.y + row);
+			sprite->setPosition(position);
+			sprite->setAlphaF(entry.opacity);
+			//sprite->setBlendingEnabled(layer.opacity < 1.0f ? true : false);
+			sprite->setLayer(config.firstLayerDepth + drawEntryIdx);
+			sprite->setFlippedX(tileFlip.isDiagonallyFlipped || tileFlip.isHorizontallyFlipped);
+			sprite->setFlippedY(tileFlip.isDiagonallyFlipped || tileFlip.isVerticallyFlipped);
+			config.sprites->pushBack(nctl::move(sprite));
+		}
+	}
+
+	if (canUseMeshSprites)
+	{
+		nctl::UniquePtr<nc::MeshSprite> meshSprite = nctl::makeUnique<nc::MeshSprite>(config.parent, (*config.textures)[0].get());
+		meshSprite->setName(mapModel.string(layer.name));
+		meshSprite->setSize(grid.width * mapModel.map().tileSets[0].tileWidth, grid.height * mapModel.map().tileSets[0].tileHeight);
+		meshSprite->setPosition(0.0f, -mapModel.map().tileSets[0].tileHeight);
+		meshSprite->setAlphaF(entry.opacity);
+		//meshSprite->setBlendingEnabled(layer.opacity < 1.0f ? true : false);
+		meshSprite->setLayer(config.firstLayerDepth + drawEntryIdx);
+		meshSprite->copyVertices(vertices.size(), vertices.data());
+		meshSprite->copyIndices(indices.size(), indices.data());
+		config.meshSprites->pushBack(nctl::move(meshSprite));
+	}
+}
+
+/// Creates the mesh sprites or the sprites of a tile layer, returns false if the layer has no tiles
+bool createLayer(const MapModel &mapModel, const MapFactory::Configuration &config, unsigned int drawEntryIdx, bool canUseMeshSprites)
+{
+	const MapModel::DrawEntry &entry = mapModel.map().drawList[drawEntryIdx];
+	const MapModel::Layer &layer = mapModel.map().layers[entry.index];
+
+	const nctl::Array<unsigned int> &tileGids = layer.data.tileGids;
+	const bool hasChunks = (layer.chunks.isEmpty() == false);
+	if (tileGids.isEmpty() && hasChunks == false)
+	{
+		if (layer.data.string)
+			LOGE_X("Unsupported layer data compression for layer %u (\"%s\")", entry.index, mapModel.string(layer.name));
+		else if (mapModel.map().infinite || mapModel.isPartial())
+			return true;
+		else
+			LOGE_X("No tile GIDs for layer %u (\"%s\")", entry.index, mapModel.string(layer.name));
+		return false;
+	}
+
+	unsigned int numTiles = tileGids.size();
+	for (unsigned int chunkIdx = 0; chunkIdx < layer.chunks.size(); chunkIdx++)
+		numTiles += layer.chunks[chunkIdx].tileGids.size();
+
+	nc::SceneNode *layerParent = nullptr;
+	if (canUseMeshSprites == false && config.sprites)
+	{
+		config.sprites->setCapacity(config.sprites->capacity() + numTiles + 1);
+		config.sprites->pushBack(nctl::makeUnique<nc::SceneNode>(config.parent));
+		layerParent = config.sprites->back().get();
+		layerParent->setPosition(entry.offsetX, entry.offsetY);
+		layerParent->setName(mapModel.string(layer.name));
+		layerParent->setAlphaF(entry.opacity);
+	}
+
+	if (hasChunks)
+	{
+		// Geometry is only created for the chunks that have been painted, each of them with its own mesh sprite
+		for (unsigned int chunkIdx = 0; chunkIdx < layer.chunks.size(); chunkIdx++)
+		{
+			const MapModel::Chunk &chunk = layer.chunks[chunkIdx];
+			const TileGrid grid = { chunk.tileGids, chunk.x, chunk.y, chunk.width, chunk.height };
+			createTiles(mapModel, config, drawEntryIdx, grid, layerParent, canUseMeshSprites);
+		}
+	}
+	else
+	{
+		const TileGrid grid = { tileGids, 0, 0, layer.width, layer.height };
+		createTiles(mapModel, config, drawEntryIdx, grid, layerParent, canUseMeshSprites);
+	}
+
+	return true;
+}
+
+/// Creates the sprites of the tile objects of an object group
+void createObjects(const MapModel &mapModel, const MapFactory::Configuration &config, unsigned int drawEntryIdx)
+{
+	const MapModel::DrawEntry &entry = mapModel.map().drawList[drawEntryIdx];
+	const MapModel::ObjectGroup &objectGroup = mapModel.map().objectGroups[entry.index];
+	const MapModel::ObjectArray &objects = objectGroup.objects;
+	config.sprites->setCapacity(config.sprites->capacity() + objects.size() + 1);
+	config.sprites->pushBack(nctl::makeUnique<nc::SceneNode>(config.parent));
+	nc::SceneNode *objectsParent = config.sprites->back().get();
+	objectsParent->setName(mapModel.string(objectGroup.name));
+
+	for (unsigned int objectIdx = 0; objectIdx < objects.size(); objectIdx++)
+	{
+		if (objects.visible[objectIdx] == false)
+			continue;
+
+		if (objects.objectTypes[objectIdx] == MapModel::ObjectType::Tile)
+		{
+			const unsigned int preFlippingGid = objects.gids[objectIdx];
+			MapFactory::TileFlip tileFlip(preFlippingGid);
+			const unsigned int gid = tileFlip.gid;
+
+			unsigned int tileSetIdx = 0;
+			for (; tileSetIdx < mapModel.map().tileSets.size(); tileSetIdx++)
+			{
+				const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
+				if (tileSet.firstGid > gid)
+					break;
+			}
+			if (tileSetIdx > 0)
+				tileSetIdx--;
+
+			const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
+			const unsigned int tileSetRow = (gid - tileSet.firstGid) / tileSet.columns;
+			const unsigned int tileSetColumn = (gid - tileSet.firstGid) % tileSet.columns;
+
+			const nc::Recti texRect = calculateTileRect(tileSet, tileSetColumn, tileSetRow);
+			nc::Texture *texture = (*config.textures)[tileSetTextureIndices[tileSetIdx]].get();
+			nctl::UniquePtr<nc::Sprite> sprite = nctl::makeUnique<nc::Sprite>(objectsParent, texture);
+			sprite->setTexRect(texRect);
+			const nc::Vector2f &position = objects.positions[objectIdx];
+			const nc::Vector2f objectPos(entry.offsetX + position.x + tileSet.tileWidth * 0.5f - (tileSet.tileWidth * mapModel.map().width * 0.5f),
+			                             -entry.offsetY - position.y + tileSet.tileHeight * 0.5f + (tileSet.tileHeight * mapModel.map().height * 0.5f));
+			if (config.snapObjectsToPixel)
+				sprite->setPosition(roundf(objectPos.x), roundf(objectPos.y));
+			else
+				sprite->setPosition(objectPos);
+			sprite->setRotation(360.0f - objects.rotations[objectIdx]);
+			sprite->setLayer(config.firstLayerDepth + drawEntryIdx);
+			sprite->setFlippedX(tileFlip.isDiagonallyFlipped || tileFlip.isHorizontallyFlipped);
+			sprite->setFlippedY(tileFlip.isDiagonallyFlipped || tileFlip.isVerticallyFlipped);
+			config.sprites->pushBack(nctl::move(sprite));
+		}
+	}
 }
 
 ImVec2 transform(const ImVec2 &v, const nc::Matrix4x4f &m)
@@ -54,24 +344,23 @@ bool MapFactory::Configuration::check() const
 	return true;
 }
 
-bool MapFactory::instantiate(const MapModel &mapModel, const Configuration &config)
+bool MapFactory::instantiate(MapModel &mapModel, const Configuration &config)
 {
 	if (config.check() == false)
 		return false;
 
 	// Create textures for tile sets
-	tileSetTextureFiles.clear();
+	tileSetTextureSources.clear();
 	tileSetTextureIndices.clear();
 	const unsigned int firstTextureIndex = config.textures->size();
 	for (unsigned int tileSetIdx = 0; tileSetIdx < mapModel.map().tileSets.size(); tileSetIdx++)
 	{
 		const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
-		nctl::String tileSetImagePath = nc::fs::joinPath(mapModel.tsxDirName(), tileSet.image.source);
 
 		bool textureFound = false;
-		for (unsigned int i = 0; i < tileSetTextureFiles.size(); i++)
+		for (unsigned int i = 0; i < tileSetTextureSources.size(); i++)
 		{
-			if (tileSetTextureFiles[i] == tileSetImagePath)
+			if (tileSetTextureSources[i] == tileSet.image.source)
 			{
 				textureFound = true;
 				tileSetTextureIndices.pushBack(firstTextureIndex + i);
@@ -90,14 +379,15 @@ bool MapFactory::instantiate(const MapModel &mapModel, const Configuration &conf
 				texture->setMagFiltering(nc::Texture::Filtering::NEAREST);
 			}
 
+			const nctl::String tileSetImagePath = nc::fs::joinPath(mapModel.tsxDirName(), mapModel.string(tileSet.image.source));
 			const bool hasLoaded = texture->loadFromFile(tileSetImagePath.data());
 			if (hasLoaded == false)
 			{
-				LOGE_X("Cannot load image \"%s\" for tileset #%u (\"%s\")", tileSetImagePath.data(), tileSetIdx, tileSet.name);
+				LOGE_X("Cannot load image \"%s\" for tileset #%u (\"%s\")", tileSetImagePath.data(), tileSetIdx, mapModel.string(tileSet.name));
 				return false;
 			}
 			config.textures->pushBack(nctl::move(texture));
-			tileSetTextureFiles.pushBack(tileSetImagePath);
+			tileSetTextureSources.pushBack(tileSet.image.source);
 			tileSetTextureIndices.pushBack(config.textures->size() - 1);
 		}
 	}
@@ -112,276 +402,84 @@ bool MapFactory::instantiate(const MapModel &mapModel, const Configuration &conf
 	if (config.useMeshSprites && canUseMeshSprites == false)
 		LOGW("Mesh sprites have been disabled");
 
-	// Create sprites from layers
-	for (unsigned int layerIdx = 0; layerIdx < mapModel.map().layers.size(); layerIdx++)
+	const nctl::Array<MapModel::DrawEntry> &drawList = mapModel.map().drawList;
+	if (mapModel.hasPendingLayers())
 	{
-		const MapModel::Layer &layer = mapModel.map().layers[layerIdx];
-		if (layer.visible == false)
-			continue;
-
-		if (layer.data.encoding != MapModel::Encoding::CSV || layer.data.compression != MapModel::Compression::Uncompressed)
+		// Only the layers that are going to be drawn are decoded, all of them in parallel
+		nctl::Array<unsigned int> visibleLayers(mapModel.map().layers.size());
+		for (unsigned int drawEntryIdx = 0; drawEntryIdx < drawList.size(); drawEntryIdx++)
 		{
-			LOGE_X("Unsupported layer data encoding or compression for layer %u (\"%s\")", layerIdx, layer.name);
-			return false;
-		}
-
-		const nctl::Array<unsigned int> &tileGids = layer.data.tileGids;
-		if (tileGids.isEmpty())
-		{
-			LOGE_X("No tile GIDs for layer %u (\"%s\")", layerIdx, layer.name);
-			return false;
+			const MapModel::DrawEntry &entry = drawList[drawEntryIdx];
+			if (entry.type == MapModel::LayerType::TileLayer && entry.visible)
+				visibleLayers.pushBack(entry.index);
 		}
+		mapModel.decodeLayers(visibleLayers);
+	}
 
-		nc::SceneNode *layerParent = nullptr;
-		if (canUseMeshSprites == false && config.sprites)
-		{
-			config.sprites->setCapacity(config.sprites->capacity() + tileGids.size() + 1);
-			config.sprites->pushBack(nctl::makeUnique<nc::SceneNode>(config.parent));
-			layerParent = config.sprites->back().get();
-			layerParent->setPosition(layer.offsetX, layer.offsetY);
-			layerParent->setName(layer.name);
-			layerParent->setAlphaF(layer.opacity);
-		}
+	// Layers are created in draw order, each one on its own depth, so that tiles and objects are interleaved as in Tiled
+	for (unsigned int drawEntryIdx = 0; drawEntryIdx < drawList.size(); drawEntryIdx++)
+	{
+		const MapModel::DrawEntry &entry = drawList[drawEntryIdx];
+		if (entry.visible == false)
+			continue;
 
-		nctl::Array<nc::MeshSprite::Vertex> vertices;
-		nctl::Array<unsigned short int> indices;
-		if (canUseMeshSprites)
+		if (entry.type == MapModel::LayerType::TileLayer)
 		{
-			vertices.setCapacity(tileGids.size() * 4 + layer.width * 2);
-			indices.setCapacity(tileGids.size() * 4 + layer.width * 2);
+			if (createLayer(mapModel, config, drawEntryIdx, canUseMeshSprites) == false)
+				return false;
 		}
+		else if (entry.type == MapModel::LayerType::ObjectGroup && config.sprites)
+			createObjects(mapModel, config, drawEntryIdx);
+		// Not instantiating image layers
+	}
 
-		bool skippedPreviousGid = false;
-		bool skipNextGid = false;
-		int vertexIdx = 0;
-		for (unsigned int gidIdx = 0; gidIdx < tileGids.size(); gidIdx++)
-		{
-			// Check if this or next GID needs to be skipped
-			if (gidIdx + 1 < tileGids.size())
-				skipNextGid = (tileGids[gidIdx + 1] == 0);
-
-			const unsigned int preFlippingGid = tileGids[gidIdx];
-			if (preFlippingGid == 0)
-			{
-				skippedPreviousGid = true;
-				continue;
-			}
-
-			TileFlip tileFlip(preFlippingGid);
-			const unsigned int gid = tileFlip.gid;
-
-			unsigned int tileSetIdx = 0;
-			for (; tileSetIdx < mapModel.map().tileSets.size(); tileSetIdx++)
-			{
-				const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
-				if (tileSet.firstGid > gid)
-					break;
-			}
-			if (tileSetIdx > 0)
-				tileSetIdx--;
-
-			const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
-			const unsigned int tileSetRow = (gid - tileSet.firstGid) / tileSet.columns;
-			const unsigned int tileSetColumn = (gid - tileSet.firstGid) % tileSet.columns;
-			const unsigned int row = gidIdx / layer.width;
-			const unsigned int column = gidIdx % layer.width;
-
-			const MapModel::Tile *tile = nullptr;
-			for (unsigned int i = 0; i < tileSet.tiles.size(); i++)
-			{
-				if (gid - tileSet.firstGid == static_cast<unsigned int>(tileSet.tiles[i].id))
-				{
-					tile = &tileSet.tiles[i];
-					break;
-				}
-			}
-
-			if (tile && tile->frames.isEmpty() == false && config.animSprites)
-			{
-				nc::Texture *texture = (*config.textures)[tileSetTextureIndices[tileSetIdx]].get();
-				nctl::UniquePtr<nc::AnimatedSprite> animSprite = nctl::makeUnique<nc::AnimatedSprite>(layerParent, texture);
-				const nc::Vector2f position = calculateTilePosition(mapModel.map(), layer, tileSet, column, row);
-				animSprite->setPosition(position);
-				animSprite->setAlphaF(layer.opacity);
-				//animSprite->setBlendingEnabled(layer.opacity < 1.0f ? true : false);
-				animSprite->setLayer(config.firstLayerDepth + layerIdx);
-				animSprite->setFlippedX(tileFlip.isDiagonallyFlipped || tileFlip.isHorizontallyFlipped);
-				animSprite->setFlippedY(tileFlip.isDiagonallyFlipped || tileFlip.isVerticallyFlipped);
-
-				nc::RectAnimation anim(1.0f / 60.0f, nc::RectAnimation::LoopMode::ENABLED, nc::RectAnimation::RewindMode::FROM_START);
-				for (unsigned int frameIdx = 0; frameIdx < tile->frames.size(); frameIdx++)
-				{
-					const MapModel::Frame &frame = tile->frames[frameIdx];
-
-					const unsigned int frameTileSetRow = (gid - tileSet.firstGid + frame.tileId) / tileSet.columns;
-					const unsigned int frameTileSetColumn = (gid - tileSet.firstGid + frame.tileId) % tileSet.columns;
-
-					const nc::Recti frameTexRect = calculateTileRect(tileSet, frameTileSetColumn, frameTileSetRow);
-					anim.addRect(frameTexRect, frame.duration * 0.001f);
-				}
-				animSprite->addAnimation(anim);
-				animSprite->setPaused(false);
-				config.animSprites->pushBack(nctl::move(animSprite));
-			}
-			else if (canUseMeshSprites)
-			{
-				nc::Vector2f pos = calculateTilePosition(mapModel.map(), layer, tileSet, column, row);
-				pos.x = (pos.x - tileSet.tileWidth * 0.5f) / float(layer.width * tileSet.tileWidth);
-				pos.y = (pos.y + tileSet.tileHeight * 0.5f) / float(layer.height * tileSet.tileHeight);
-				const float tileWidth = tileSet.tileWidth / float(layer.width * tileSet.tileWidth);
-				const float tileHeight = tileSet.tileHeight / float(layer.height * tileSet.tileHeight);
-
-				const nc::Recti texRect = calculateTileRect(tileSet, tileSetColumn, tileSetRow);
-				float u = texRect.x / float(tileSet.image.width);
-				float v = texRect.y / float(tileSet.image.height);
-				float du = texRect.w / float(tileSet.image.width);
-				float dv = texRect.h / float(tileSet.image.height);
-
-				if (tileFlip.isDiagonallyFlipped || tileFlip.isHorizontallyFlipped)
-				{
-					u += du;
-					du *= -1;
-				}
-				if (tileFlip.isDiagonallyFlipped || tileFlip.isVerticallyFlipped)
-				{
-					v += dv;
-					dv *= -1;
-				}
-
-				// Insert a degenerate vertex if previous tile was on the previous column or completely skipped
-				if ((gidIdx > 0 && column == 0) || skippedPreviousGid)
-				{
-					vertices.emplaceBack(pos.x, pos.y, u, v + dv);
-					indices.pushBack(vertexIdx++);
-					skippedPreviousGid = false;
-				}
-
-				vertices.emplaceBack(pos.x, pos.y, u, v + dv);
-				vertices.emplaceBack(pos.x, pos.y + tileHeight, u, v);
-				vertices.emplaceBack(pos.x + tileWidth, pos.y, u + du, v + dv);
-				vertices.emplaceBack(pos.x + tileWidth, pos.y + tileHeight, u + du, v);
+	return true;
+}
 
-				indices.pushBack(vertexIdx++);
-				indices.pushBack(vertexIdx++);
-				indices.pushBack(vertexIdx++);
-				indices.pushBack(vertexIdx++);
+bool MapFactory::reloadTileSetImage(const MapModel &mapModel, const Configuration &config, unsigned int tileSetIdx)
+{
+	if (config.textures == nullptr || tileSetIdx >= tileSetTextureIndices.size() || tileSetIdx >= mapModel.map().tileSets.size())
+		return false;
 
-				// Insert a degenerate vertex if next tile is on the next column or going to be completely skipped
-				if ((gidIdx < tileGids.size() - 1 && column == static_cast<unsigned int>(layer.width - 1)) || skipNextGid)
-				{
-					vertices.emplaceBack(pos.x + tileWidth, pos.y + tileHeight, u + du, v);
-					indices.pushBack(vertexIdx++);
-				}
-			}
-			else if (config.sprites)
-			{
-				const nc::Recti texRect = calculateTileRect(tileSet, tileSetColumn, tileSetRow);
-				nc::Texture *texture = (*config.textures)[tileSetTextureIndices[tileSetIdx]].get();
-				nctl::UniquePtr<nc::Sprite> sprite = nctl::makeUnique<nc::Sprite>(layerParent, texture);
-				sprite->setTexRect(texRect);
-				const nc::Vector2f position = calculateTilePosition(mapModel.map(), layer, tileSet, column, row);
-				sprite->setPosition(position);
-				sprite->setAlphaF(layer.opacity);
-				//sprite->setBlendingEnabled(layer.opacity < 1.0f ? true : false);
-				sprite->setLayer(config.firstLayerDepth + layerIdx);
-				sprite->setFlippedX(tileFlip.isDiagonallyFlipped || tileFlip.isHorizontallyFlipped);
-				sprite->setFlippedY(tileFlip.isDiagonallyFlipped || tileFlip.isVerticallyFlipped);
-				config.sprites->pushBack(nctl::move(sprite));
-			}
-		}
+	const unsigned int textureIdx = tileSetTextureIndices[tileSetIdx];
+	if (textureIdx >= config.textures->size())
+		return false;
 
-		if (canUseMeshSprites)
-		{
-			nctl::UniquePtr<nc::MeshSprite> meshSprite = nctl::makeUnique<nc::MeshSprite>(config.parent, (*config.textures)[0].get());
-			meshSprite->setName(layer.name);
-			meshSprite->setSize(layer.width * mapModel.map().tileSets[0].tileWidth, layer.height * mapModel.map().tileSets[0].tileHeight);
-			meshSprite->setPosition(0.0f, -mapModel.map().tileSets[0].tileHeight);
-			meshSprite->setAlphaF(layer.opacity);
-			//meshSprite->setBlendingEnabled(layer.opacity < 1.0f ? true : false);
-			meshSprite->setLayer(config.firstLayerDepth + layerIdx);
-			meshSprite->copyVertices(vertices.size(), vertices.data());
-			meshSprite->copyIndices(indices.size(), indices.data());
-			config.meshSprites->pushBack(nctl::move(meshSprite));
-		}
+	// Texture rectangles and mesh sprite coordinates were computed from the image size of the tileset
+	const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
+	nc::Texture *texture = (*config.textures)[textureIdx].get();
+	const nctl::String tileSetImagePath = nc::fs::joinPath(mapModel.tsxDirName(), mapModel.string(tileSet.image.source));
+	if (texture->loadFromFile(tileSetImagePath.data()) == false)
+	{
+		LOGE_X("Cannot reload image \"%s\" for tileset #%u (\"%s\")", tileSetImagePath.data(), tileSetIdx, mapModel.string(tileSet.name));
+		return false;
 	}
-
-	if (config.sprites)
+	if ((tileSet.image.width > 0 && texture->width() != tileSet.image.width) ||
+	    (tileSet.image.height > 0 && texture->height() != tileSet.image.height))
 	{
-		// Create sprites from objects
-		for (unsigned int objectGroupIdx = 0; objectGroupIdx < mapModel.map().objectGroups.size(); objectGroupIdx++)
-		{
-			const MapModel::ObjectGroup &objectGroup = mapModel.map().objectGroups[objectGroupIdx];
-			if (objectGroup.visible == false)
-				continue;
-
-			config.sprites->setCapacity(config.sprites->capacity() + objectGroup.objects.size() + 1);
-			config.sprites->pushBack(nctl::makeUnique<nc::SceneNode>(config.parent));
-			nc::SceneNode *objectsParent = config.sprites->back().get();
-			objectsParent->setName(objectGroup.name);
-
-			for (unsigned int objectIdx = 0; objectIdx < objectGroup.objects.size(); objectIdx++)
-			{
-				const MapModel::Object &object = objectGroup.objects[objectIdx];
-				if (object.visible == false)
-					continue;
-
-				if (object.objectType == MapModel::ObjectType::Tile)
-				{
-					const unsigned int preFlippingGid = object.gid;
-					TileFlip tileFlip(preFlippingGid);
-					const unsigned int gid = tileFlip.gid;
-
-					unsigned int tileSetIdx = 0;
-					for (; tileSetIdx < mapModel.map().tileSets.size(); tileSetIdx++)
-					{
-						const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
-						if (tileSet.firstGid > gid)
-							break;
-					}
-					if (tileSetIdx > 0)
-						tileSetIdx--;
-
-					const MapModel::TileSet &tileSet = mapModel.map().tileSets[tileSetIdx];
-					const unsigned int tileSetRow = (gid - tileSet.firstGid) / tileSet.columns;
-					const unsigned int tileSetColumn = (gid - tileSet.firstGid) % tileSet.columns;
-
-					const nc::Recti texRect = calculateTileRect(tileSet, tileSetColumn, tileSetRow);
-					nc::Texture *texture = (*config.textures)[tileSetTextureIndices[tileSetIdx]].get();
-					nctl::UniquePtr<nc::Sprite> sprite = nctl::makeUnique<nc::Sprite>(objectsParent, texture);
-					sprite->setTexRect(texRect);
-					const nc::Vector2f objectPos(objectGroup.offsetX + object.x + tileSet.tileWidth * 0.5f - (tileSet.tileWidth * mapModel.map().width * 0.5f),
-					                             -objectGroup.offsetY - object.y + tileSet.tileHeight * 0.5f + (tileSet.tileHeight * mapModel.map().height * 0.5f));
-					if (config.snapObjectsToPixel)
-						sprite->setPosition(roundf(objectPos.x), roundf(objectPos.y));
-					else
-						sprite->setPosition(objectPos);
-					sprite->setRotation(360.0f - object.rotation);
-					sprite->setLayer(config.firstLayerDepth + mapModel.map().layers.size() + objectGroupIdx);
-					sprite->setFlippedX(tileFlip.isDiagonallyFlipped || tileFlip.isHorizontallyFlipped);
-					sprite->setFlippedY(tileFlip.isDiagonallyFlipped || tileFlip.isVerticallyFlipped);
-					config.sprites->pushBack(nctl::move(sprite));
-				}
-			}
-		}
+		LOGW_X("Image \"%s\" for tileset #%u has changed size", tileSetImagePath.data(), tileSetIdx);
+		return false;
 	}
 
 	return true;
 }
 
-bool MapFactory::drawObjectsWithImGui(const nc::Camera &camera, const MapModel &mapModel, unsigned int objectGroupIdx)
+bool MapFactory::drawObjectsWithImGui(const nc::Camera &camera, const MapModel &mapModel, unsigned int drawEntryIdx)
 {
-	if (objectGroupIdx > mapModel.map().objectGroups.size() - 1)
+	if (drawEntryIdx >= mapModel.map().drawList.size())
 		return false;
 
-	const MapModel::ObjectGroup &objectGroup = mapModel.map().objectGroups[objectGroupIdx];
-	if (objectGroup.visible == false)
+	const MapModel::DrawEntry &entry = mapModel.map().drawList[drawEntryIdx];
+	if (entry.type != MapModel::LayerType::ObjectGroup || entry.visible == false)
 		return false;
 
+	const MapModel::ObjectGroup &objectGroup = mapModel.map().objectGroups[entry.index];
+
+	const MapModel::ObjectArray &objects = objectGroup.objects;
 	bool hasObjectToDraw = false;
-	for (unsigned int objectIdx = 0; objectIdx < objectGroup.objects.size(); objectIdx++)
+	for (unsigned int objectIdx = 0; objectIdx < objects.size(); objectIdx++)
 	{
-		const MapModel::Object &object = objectGroup.objects[objectIdx];
-		if (object.visible && object.objectType != MapModel::ObjectType::Tile)
+		if (objects.visible[objectIdx] && objects.objectTypes[objectIdx] != MapModel::ObjectType::Tile)
 		{
 			hasObjectToDraw = true;
 			break;
@@ -408,64 +506,72 @@ bool MapFactory::drawObjectsWithImGui(const nc::Camera &camera, const MapModel &
 
 	const ImU32 color = nc::Color(255, 255, 255, 200).abgr();
 	const float thickness = 2.0f;
-	for (unsigned int objectIdx = 0; objectIdx < objectGroup.objects.size(); objectIdx++)
+	for (unsigned int objectIdx = 0; objectIdx < objects.size(); objectIdx++)
 	{
-		const MapModel::Object &object = objectGroup.objects[objectIdx];
-		if (object.visible == false)
+		if (objects.visible[objectIdx] == false)
 			continue;
 
-		const ImVec2 origin(objectGroup.offsetX + object.x, objectGroup.offsetY + object.y);
+		const MapModel::ObjectType objectType = objects.objectTypes[objectIdx];
+		const nc::Vector2f &size = objects.sizes[objectIdx];
+		const ImVec2 origin(entry.offsetX + objects.positions[objectIdx].x, entry.offsetY + objects.positions[objectIdx].y);
 
-		if (object.objectType == MapModel::ObjectType::Rectangle)
+		if (objectType == MapModel::ObjectType::Rectangle)
 		{
 			if (onlyTranslation)
 			{
 				const ImVec2 min = transform(ImVec2(origin.x, origin.y), matrix);
-				const ImVec2 max = transform(ImVec2(origin.x + object.width, origin.y + object.height), matrix);
+				const ImVec2 max = transform(ImVec2(origin.x + size.x, origin.y + size.y), matrix);
 				drawList->AddRect(min, max, color, 0.0f, ImDrawFlags_RoundCornersNone, thickness);
 			}
 			else
 			{
 				// Cannot use `ImDrawList::AddRect()` for a rotated rectangle
 				points[0] = transform(ImVec2(origin.x, origin.y), matrix);
-				points[1] = transform(ImVec2(origin.x + object.width, origin.y), matrix);
-				points[2] = transform(ImVec2(origin.x + object.width, origin.y + object.height), matrix);
-				points[3] = transform(ImVec2(origin.x, origin.y + object.height), matrix);
+				points[1] = transform(ImVec2(origin.x + size.x, origin.y), matrix);
+				points[2] = transform(ImVec2(origin.x + size.x, origin.y + size.y), matrix);
+				points[3] = transform(ImVec2(origin.x, origin.y + size.y), matrix);
 
 				drawList->AddPolyline(points, 4, color, true, thickness);
 			}
 		}
-		else if (object.objectType == MapModel::ObjectType::Ellipse)
+		else if (objectType == MapModel::ObjectType::Ellipse)
 		{
-			const ImVec2 transformed = transform(ImVec2(origin.x + object.width / 2, origin.y + object.height / 2), matrix);
-			const float radius = object.height * 0.5f * viewValues.scale;
+			const ImVec2 transformed = transform(ImVec2(origin.x + size.x / 2, origin.y + size.y / 2), matrix);
+			const float radius = size.y * 0.5f * viewValues.scale;
 			drawList->AddCircle(transformed, radius, color, 32, thickness);
 		}
-		else if (object.objectType == MapModel::ObjectType::Point)
+		else if (objectType == MapModel::ObjectType::Point)
 		{
 			const ImVec2 transformed = transform(origin, matrix);
 			drawList->AddCircleFilled(transformed, thickness * 2.0f, color);
 		}
-		else if (object.objectType == MapModel::ObjectType::Polygon ||
-		         object.objectType == MapModel::ObjectType::Polyline)
+		else if (objectType == MapModel::ObjectType::Polygon ||
+		         objectType == MapModel::ObjectType::Polyline)
 		{
-			for (unsigned int i = 0; i < object.points.size() && i < MaxOverlayPoints; i++)
+			const nc::Vector2f *objectPoints = objects.objectPoints(objectIdx, mapModel.map().templates);
+			const unsigned int numPoints = objects.numObjectPoints(objectIdx, mapModel.map().templates);
+			for (unsigned int i = 0; i < numPoints && i < MaxOverlayPoints; i++)
 			{
-				points[i] = transform(ImVec2(origin.x + object.points[i].x,
-				                             origin.y + object.points[i].y), matrix);
+				points[i] = transform(ImVec2(origin.x + objectPoints[i].x,
+				                             origin.y + objectPoints[i].y), matrix);
 			}
 
-			const bool closed = object.objectType == MapModel::ObjectType::Polygon;
+			const bool closed = objectType == MapModel::ObjectType::Polygon;
 			drawList->AddCircleFilled(points[0], thickness * 2.0f, color);
-			drawList->AddPolyline(points, object.points.size(), color, closed, thickness);
+			drawList->AddPolyline(points, numPoints, color, closed, thickness);
+		}
+		else if (objectType == MapModel::ObjectType::Text && onlyTranslation)
+		{
+			const MapModel::Text *text = objects.objectText(objectIdx, mapModel.map().templates);
+			drawList->AddText(transform(origin, matrix), text->color.abgr(), text->data);
 		}
-		else if (object.objectType == MapModel::ObjectType::Text && onlyTranslation)
-			drawList->AddText(transform(origin, matrix), object.text.color.abgr(), object.text.data);
 
-		if (object.name[0] != '\0')
+		// The name is part of the cold data and it is only read when it would be drawn
+		if (objectType != MapModel::ObjectType::Tile && objectType != MapModel::ObjectType::Text && onlyTranslation)
 		{
-			if (object.objectType != MapModel::ObjectType::Tile && object.objectType != MapModel::ObjectType::Text && onlyTranslation)
-				drawList->AddText(transform(ImVec2(origin.x, origin.y - ImGui::GetFontSize()), matrix), color, object.name);
+			const MapModel::StringId name = objects.details[objectIdx].name;
+			if (name != StringTable::EmptyId)
+				drawList->AddText(transform(ImVec2(origin.x, origin.y - ImGui::GetFontSize()), matrix), color, mapModel.string(name));
 		}
 	}
 
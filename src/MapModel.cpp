@@ -0,0 +1,349 @@
+#include "MapModel.h"
+#include "LayerDecoder.h"
+#include "MappedFile.h"
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+// The special members are defined here, where the decoder and the file are complete types
+MapModel::MapModel() = default;
+
+MapModel::~MapModel() = default;
+
+MapModel::MapModel(MapModel &&other) = default;
+
+MapModel &MapModel::operator=(MapModel &&other) = default;
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+void MapModel::reinternProperties(nctl::Array<Property> &properties, const StringTable &srcStrings, StringTable &destStrings)
+{
+	for (unsigned int i = 0; i < properties.size(); i++)
+	{
+		Property &property = properties[i];
+		property.name = destStrings.intern(srcStrings, property.name);
+		if (property.hasStringValue())
+			property.value.string = destStrings.intern(srcStrings, property.value.string);
+	}
+}
+
+unsigned int MapModel::Layer::createChunkIndices()
+{
+	if (chunks.isEmpty())
+	{
+		chunkIndices = nctl::UniquePtr<ChunkHashMap>();
+		return 0;
+	}
+
+	// The capacity is twice the number of chunks to keep the load factor of the hash map low
+	chunkIndices = nctl::makeUnique<ChunkHashMap>(chunks.size() * 2);
+	unsigned int numDuplicates = 0;
+	for (unsigned int i = 0; i < chunks.size(); i++)
+	{
+		const Chunk &chunk = chunks[i];
+		if (chunkIndices->insert(chunkKey(chunk.x, chunk.y), i) == false)
+			numDuplicates++;
+	}
+
+	return numDuplicates;
+}
+
+void MapModel::ObjectArray::setCapacity(unsigned int capacity)
+{
+	positions.setCapacity(capacity);
+	sizes.setCapacity(capacity);
+	rotations.setCapacity(capacity);
+	gids.setCapacity(capacity);
+	objectTypes.setCapacity(capacity);
+	visible.setCapacity(capacity);
+	details.setCapacity(capacity);
+}
+
+void MapModel::ObjectArray::append(const Object &object)
+{
+	positions.pushBack(nc::Vector2f(object.x, object.y));
+	sizes.pushBack(nc::Vector2f(object.width, object.height));
+	rotations.pushBack(object.rotation);
+	gids.pushBack(object.gid);
+	objectTypes.pushBack(object.objectType);
+	visible.pushBack(object.visible);
+
+	details.emplaceBack();
+	ObjectDetails &objectDetails = details.back();
+	objectDetails.id = object.id;
+	objectDetails.name = object.name;
+	objectDetails.type = object.type;
+	objectDetails.templateFile = object.templateFile;
+	objectDetails.overrides = object.overrides;
+
+	objectDetails.firstPoint = points.size();
+	objectDetails.numPoints = object.points.size();
+	for (unsigned int i = 0; i < object.points.size(); i++)
+		points.pushBack(object.points[i]);
+
+	if (object.objectType == ObjectType::Text)
+	{
+		objectDetails.textIndex = texts.size();
+		texts.pushBack(object.text);
+	}
+
+	objectDetails.firstProperty = properties.size();
+	objectDetails.numProperties = object.properties.size();
+	for (unsigned int i = 0; i < object.properties.size(); i++)
+		properties.pushBack(object.properties[i]);
+}
+
+void MapModel::ObjectArray::shrinkToFit()
+{
+	positions.shrinkToFit();
+	sizes.shrinkToFit();
+	rotations.shrinkToFit();
+	gids.shrinkToFit();
+	objectTypes.shrinkToFit();
+	visible.shrinkToFit();
+	details.shrinkToFit();
+	points.shrinkToFit();
+	texts.shrinkToFit();
+	properties.shrinkToFit();
+}
+
+bool MapModel::ObjectArray::isConsistent() const
+{
+	const unsigned int numObjects = objectTypes.size();
+	if (positions.size() != numObjects || sizes.size() != numObjects || rotations.size() != numObjects ||
+	    gids.size() != numObjects || visible.size() != numObjects || details.size() != numObjects)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < numObjects; i++)
+	{
+		const ObjectDetails &objectDetails = details[i];
+		if (objectDetails.firstPoint > points.size() || objectDetails.numPoints > points.size() - objectDetails.firstPoint)
+			return false;
+		if (objectDetails.textIndex >= static_cast<int>(texts.size()) ||
+		    (objectTypes[i] == ObjectType::Text && objectDetails.textIndex < 0 && hasTemplateShape(i) == false))
+		{
+			return false;
+		}
+		if (objectDetails.firstProperty > properties.size() || objectDetails.numProperties > properties.size() - objectDetails.firstProperty)
+			return false;
+	}
+
+	return true;
+}
+
+const nc::Vector2f *MapModel::ObjectArray::objectPoints(unsigned int index, const nctl::Array<ObjectTemplate> &templates) const
+{
+	if (hasTemplateShape(index))
+		return templates[details[index].templateIndex].object.points.data();
+	return points.data() + details[index].firstPoint;
+}
+
+unsigned int MapModel::ObjectArray::numObjectPoints(unsigned int index, const nctl::Array<ObjectTemplate> &templates) const
+{
+	if (hasTemplateShape(index))
+		return templates[details[index].templateIndex].object.points.size();
+	return details[index].numPoints;
+}
+
+const MapModel::Text *MapModel::ObjectArray::objectText(unsigned int index, const nctl::Array<ObjectTemplate> &templates) const
+{
+	if (objectTypes[index] != ObjectType::Text)
+		return nullptr;
+	else if (hasTemplateShape(index))
+		return &templates[details[index].templateIndex].object.text;
+	return &texts[details[index].textIndex];
+}
+
+void MapModel::Map::addDrawEntry(LayerType type, unsigned int index)
+{
+	drawList.emplaceBack();
+	drawList.back().type = type;
+	drawList.back().index = index;
+}
+
+void MapModel::Map::accumulateGroupValues()
+{
+	// Parents come before their children, the values of every group are accumulated in a single pass
+	nctl::Array<DrawEntry> groupValues(groups.size());
+	for (unsigned int i = 0; i < groups.size(); i++)
+	{
+		const Group &group = groups[i];
+		groupValues.emplaceBack();
+		DrawEntry &values = groupValues.back();
+		if (group.parentIndex >= 0)
+			values = groupValues[group.parentIndex];
+		values.offsetX += group.offsetX;
+		values.offsetY += group.offsetY;
+		values.opacity *= group.opacity;
+		values.visible = values.visible && group.visible;
+	}
+
+	for (unsigned int i = 0; i < drawList.size(); i++)
+	{
+		DrawEntry &entry = drawList[i];
+		int groupIndex = -1;
+		switch (entry.type)
+		{
+			case LayerType::TileLayer:
+			{
+				const Layer &layer = layers[entry.index];
+				entry.offsetX = layer.offsetX;
+				entry.offsetY = layer.offsetY;
+				entry.opacity = layer.opacity;
+				entry.visible = layer.visible;
+				groupIndex = layer.groupIndex;
+				break;
+			}
+			case LayerType::ObjectGroup:
+			{
+				const ObjectGroup &objectGroup = objectGroups[entry.index];
+				entry.offsetX = objectGroup.offsetX;
+				entry.offsetY = objectGroup.offsetY;
+				entry.opacity = objectGroup.opacity;
+				entry.visible = objectGroup.visible;
+				groupIndex = objectGroup.groupIndex;
+				break;
+			}
+			case LayerType::ImageLayer:
+			{
+				const ImageLayer &imageLayer = imageLayers[entry.index];
+				entry.offsetX = imageLayer.offsetX;
+				entry.offsetY = imageLayer.offsetY;
+				entry.opacity = imageLayer.opacity;
+				entry.visible = imageLayer.visible;
+				groupIndex = imageLayer.groupIndex;
+				break;
+			}
+		}
+
+		if (groupIndex >= 0)
+		{
+			const DrawEntry &values = groupValues[groupIndex];
+			entry.offsetX += values.offsetX;
+			entry.offsetY += values.offsetY;
+			entry.opacity *= values.opacity;
+			entry.visible = entry.visible && values.visible;
+		}
+	}
+}
+
+namespace {
+
+inline bool isValidGroupIndex(int groupIndex, unsigned int numGroups)
+{
+	return (groupIndex >= -1 && groupIndex < static_cast<int>(numGroups));
+}
+
+}
+
+bool MapModel::Map::hasValidDrawList() const
+{
+	for (unsigned int i = 0; i < groups.size(); i++)
+	{
+		// A parent always comes before its children
+		if (isValidGroupIndex(groups[i].parentIndex, i) == false)
+			return false;
+	}
+	for (unsigned int i = 0; i < layers.size(); i++)
+	{
+		if (isValidGroupIndex(layers[i].groupIndex, groups.size()) == false)
+			return false;
+	}
+	for (unsigned int i = 0; i < objectGroups.size(); i++)
+	{
+		if (isValidGroupIndex(objectGroups[i].groupIndex, groups.size()) == false)
+			return false;
+	}
+	for (unsigned int i = 0; i < imageLayers.size(); i++)
+	{
+		if (isValidGroupIndex(imageLayers[i].groupIndex, groups.size()) == false)
+			return false;
+	}
+
+	for (unsigned int i = 0; i < drawList.size(); i++)
+	{
+		const DrawEntry &entry = drawList[i];
+		unsigned int numLayers = 0;
+		switch (entry.type)
+		{
+			case LayerType::TileLayer: numLayers = layers.size(); break;
+			case LayerType::ObjectGroup: numLayers = objectGroups.size(); break;
+			case LayerType::ImageLayer: numLayers = imageLayers.size(); break;
+		}
+		if (entry.index >= numLayers)
+			return false;
+	}
+
+	return true;
+}
+
+void MapModel::setPendingLayers(nctl::UniquePtr<LayerDecoder> layerDecoder)
+{
+	layerDecoder_ = nctl::move(layerDecoder);
+	if (layerDecoder_ && layerDecoder_->numPendingLayers() == 0)
+		layerDecoder_ = nctl::UniquePtr<LayerDecoder>();
+}
+
+void MapModel::setSourceFile(nctl::UniquePtr<MappedFile> sourceFile)
+{
+	sourceFile_ = nctl::move(sourceFile);
+}
+
+bool MapModel::hasPendingLayers() const
+{
+	return (layerDecoder_ && layerDecoder_->numPendingLayers() > 0);
+}
+
+bool MapModel::isLayerPending(unsigned int layerIndex) const
+{
+	return (layerDecoder_ && layerDecoder_->isPending(layerIndex));
+}
+
+bool MapModel::decodeLayers(const nctl::Array<unsigned int> &layerIndices)
+{
+	if (layerDecoder_.get() == nullptr)
+		return true;
+
+	const bool allDecoded = layerDecoder_->decode(map_.layers, layerIndices);
+	// The strings are not needed anymore once every layer has been decoded
+	if (layerDecoder_->numPendingLayers() == 0)
+	{
+		layerDecoder_ = nctl::UniquePtr<LayerDecoder>();
+		sourceFile_ = nctl::UniquePtr<MappedFile>();
+	}
+	return allDecoded;
+}
+
+bool MapModel::decodeLayers()
+{
+	if (layerDecoder_.get() == nullptr)
+		return true;
+
+	const bool allDecoded = layerDecoder_->decode(map_.layers);
+	layerDecoder_ = nctl::UniquePtr<LayerDecoder>();
+	sourceFile_ = nctl::UniquePtr<MappedFile>();
+	return allDecoded;
+}
+
+bool MapModel::decodeRegion(const nc::Recti &rect, const nctl::Array<unsigned int> &layerIndices)
+{
+	if (layerDecoder_.get() == nullptr)
+		return true;
+
+	region_ = rect;
+	const bool allDecoded = layerDecoder_->decodeRegion(map_.layers, rect, layerIndices);
+	// The layers that have not been requested are not going to be decoded anymore, not even their chunks are kept
+	for (unsigned int i = 0; i < map_.layers.size(); i++)
+	{
+		if (layerDecoder_->isPending(i))
+			map_.layers[i].chunks.clear();
+	}
+	layerDecoder_ = nctl::UniquePtr<LayerDecoder>();
+	sourceFile_ = nctl::UniquePtr<MappedFile>();
+	return allDecoded;
+}
@@ -0,0 +1,98 @@
+#if defined(__linux__) && !defined(__ANDROID__)
+	#define WITH_MMAP
+#endif
+
+#ifdef WITH_MMAP
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#include <ncine/IFile.h>
+#include "MappedFile.h"
+
+namespace nc = ncine;
+
+MappedFile::MappedFile()
+    : data_(nullptr), size_(0), isMapped_(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const char *filename, bool canMap)
+{
+	close();
+
+	if (canMap && map(filename))
+		return true;
+	return read(filename);
+}
+
+void MappedFile::close()
+{
+#ifdef WITH_MMAP
+	if (isMapped_)
+		munmap(data_, size_);
+#endif
+
+	buffer_ = nctl::UniquePtr<unsigned char[]>();
+	data_ = nullptr;
+	size_ = 0;
+	isMapped_ = false;
+}
+
+bool MappedFile::map(const char *filename)
+{
+#ifdef WITH_MMAP
+	const int fd = ::open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || S_ISREG(fileStat.st_mode) == false || fileStat.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// A private mapping can be written by the in-situ parser without changing the file
+	void *address = mmap(nullptr, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after closing the descriptor
+	::close(fd);
+	if (address == MAP_FAILED)
+		return false;
+
+	madvise(address, fileStat.st_size, MADV_SEQUENTIAL);
+
+	data_ = static_cast<unsigned char *>(address);
+	size_ = static_cast<unsigned long int>(fileStat.st_size);
+	isMapped_ = true;
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool MappedFile::read(const char *filename)
+{
+	nctl::UniquePtr<nc::IFile> file = nc::IFile::createFileHandle(filename);
+	file->open(nc::IFile::OpenMode::READ);
+	if (file->isOpened() == false)
+	{
+		LOGE_X("Cannot open file: %s", filename);
+		return false;
+	}
+
+	size_ = file->size();
+	buffer_ = nctl::makeUnique<unsigned char[]>(size_);
+	file->read(buffer_.get(), size_);
+	file->close();
+
+	data_ = buffer_.get();
+	return true;
+}
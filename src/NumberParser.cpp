@@ -0,0 +1,189 @@
+#include <cstdint>
+#include <climits>
+
+#include "NumberParser.h"
+
+namespace {
+
+/// The digits of a mantissa that fit in 64 bits, the following ones are ignored
+const unsigned int MaxSignificantDigits = 19;
+/// The largest exponent that can still change the result, any larger one overflows or underflows a float
+const int MaxExponent = 400;
+
+/// The powers of ten that are exactly representable as a float
+const float FloatPowersOfTen[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+const int MaxExactFloatPower = 10;
+const uint64_t MaxExactFloatMantissa = uint64_t(1) << 24;
+
+/// The powers of ten that are exactly representable as a double
+const double DoublePowersOfTen[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+const int MaxExactDoublePower = 22;
+const uint64_t MaxExactDoubleMantissa = uint64_t(1) << 53;
+
+inline bool isDigit(char c)
+{
+	return (c >= '0' && c <= '9');
+}
+
+/// Returns the value of a digit in base 10 or 16, or a value not less than the base if the character is not a digit
+inline unsigned int digitValue(char c, unsigned int base)
+{
+	if (c >= '0' && c <= '9')
+		return static_cast<unsigned int>(c - '0');
+	else if (base == 16 && c >= 'a' && c <= 'f')
+		return static_cast<unsigned int>(c - 'a' + 10);
+	else if (base == 16 && c >= 'A' && c <= 'F')
+		return static_cast<unsigned int>(c - 'A' + 10);
+	return base;
+}
+
+/// Parses at most `maxDigits` digits of an unsigned number, saturating to the largest 64 bits value
+const char *parseDigits(const char *string, unsigned int base, unsigned int maxDigits, uint64_t &value)
+{
+	const char *buffer = string;
+	uint64_t number = 0;
+	for (unsigned int i = 0; i < maxDigits; i++)
+	{
+		const unsigned int digit = digitValue(*buffer, base);
+		if (digit >= base)
+			break;
+
+		number = (number > (UINT64_MAX - digit) / base) ? UINT64_MAX : number * base + digit;
+		buffer++;
+	}
+
+	if (buffer != string)
+		value = number;
+	return buffer;
+}
+
+/// Multiplies a mantissa by a power of ten, exactly if both fit in the mantissa of a double
+float scaleMantissa(uint64_t mantissa, int exponent)
+{
+	if (mantissa <= MaxExactFloatMantissa && exponent >= -MaxExactFloatPower && exponent <= MaxExactFloatPower)
+	{
+		const float result = static_cast<float>(mantissa);
+		return (exponent < 0) ? result / FloatPowersOfTen[-exponent] : result * FloatPowersOfTen[exponent];
+	}
+
+	double result = static_cast<double>(mantissa);
+	if (mantissa > MaxExactDoubleMantissa || exponent < -MaxExactDoublePower || exponent > MaxExactDoublePower)
+	{
+		// Large exponents are applied in steps, each one rounding the intermediate result
+		if (exponent > MaxExponent)
+			exponent = MaxExponent;
+		else if (exponent < -MaxExponent)
+			exponent = -MaxExponent;
+		for (; exponent > MaxExactDoublePower; exponent -= MaxExactDoublePower)
+			result *= DoublePowersOfTen[MaxExactDoublePower];
+		for (; exponent < -MaxExactDoublePower; exponent += MaxExactDoublePower)
+			result /= DoublePowersOfTen[MaxExactDoublePower];
+	}
+
+	result = (exponent < 0) ? result / DoublePowersOfTen[-exponent] : result * DoublePowersOfTen[exponent];
+	return static_cast<float>(result);
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+const char *NumberParser::parseInt(const char *string, int &value, int base)
+{
+	const bool isNegative = (*string == '-');
+	const char *buffer = (*string == '-' || *string == '+') ? string + 1 : string;
+
+	uint64_t magnitude = 0;
+	const char *end = parseDigits(buffer, static_cast<unsigned int>(base), UINT_MAX, magnitude);
+	if (end == buffer)
+		return string;
+
+	if (isNegative)
+		value = (magnitude >= uint64_t(INT_MAX) + 1) ? INT_MIN : -static_cast<int>(magnitude);
+	else
+		value = (magnitude > uint64_t(INT_MAX)) ? INT_MAX : static_cast<int>(magnitude);
+	return end;
+}
+
+const char *NumberParser::parseUint(const char *string, unsigned int &value, int base)
+{
+	uint64_t number = 0;
+	const char *end = parseDigits(string, static_cast<unsigned int>(base), UINT_MAX, number);
+	if (end != string)
+		value = (number > uint64_t(UINT_MAX)) ? UINT_MAX : static_cast<unsigned int>(number);
+	return end;
+}
+
+const char *NumberParser::parseHex(const char *string, unsigned int maxDigits, unsigned int &value)
+{
+	uint64_t number = 0;
+	const char *end = parseDigits(string, 16, maxDigits, number);
+	if (end != string)
+		value = (number > uint64_t(UINT_MAX)) ? UINT_MAX : static_cast<unsigned int>(number);
+	return end;
+}
+
+const char *NumberParser::parseFloat(const char *string, float &value)
+{
+	const bool isNegative = (*string == '-');
+	const char *buffer = (*string == '-' || *string == '+') ? string + 1 : string;
+
+	// The significant digits are accumulated in an integer, the position of the dot goes into the exponent
+	uint64_t mantissa = 0;
+	unsigned int numSignificantDigits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+
+	for (; isDigit(*buffer); buffer++)
+	{
+		hasDigits = true;
+		if (numSignificantDigits < MaxSignificantDigits)
+		{
+			mantissa = mantissa * 10 + static_cast<unsigned int>(*buffer - '0');
+			if (mantissa > 0)
+				numSignificantDigits++;
+		}
+		else
+			exponent++;
+	}
+
+	if (*buffer == '.')
+	{
+		buffer++;
+		for (; isDigit(*buffer); buffer++)
+		{
+			hasDigits = true;
+			if (numSignificantDigits < MaxSignificantDigits)
+			{
+				mantissa = mantissa * 10 + static_cast<unsigned int>(*buffer - '0');
+				if (mantissa > 0)
+					numSignificantDigits++;
+				exponent--;
+			}
+		}
+	}
+
+	if (hasDigits == false)
+		return string;
+
+	// The exponent is only consumed if it has at least one digit
+	if (*buffer == 'e' || *buffer == 'E')
+	{
+		int exponentValue = 0;
+		const char *exponentEnd = parseInt(buffer + 1, exponentValue);
+		if (exponentEnd != buffer + 1)
+		{
+			exponent += (exponentValue > MaxExponent) ? MaxExponent : ((exponentValue < -MaxExponent) ? -MaxExponent : exponentValue);
+			buffer = exponentEnd;
+		}
+	}
+
+	const float result = (mantissa == 0) ? 0.0f : scaleMantissa(mantissa, exponent);
+	value = isNegative ? -result : result;
+	return buffer;
+}
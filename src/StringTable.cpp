@@ -0,0 +1,148 @@
+#include <cstring> // for `strlen()`, `memcmp()` and `memcpy()`
+
+#include "StringTable.h"
+
+namespace {
+
+const unsigned int InitialNumSlots = 64;
+
+}
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+StringTable::StringTable()
+{
+	clear();
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+StringTable::Id StringTable::intern(const char *string)
+{
+	return intern(string, strlen(string));
+}
+
+StringTable::Id StringTable::intern(const char *string, unsigned int length)
+{
+	if (length == 0)
+		return EmptyId;
+
+	unsigned int slotIndex = findSlot(string, length);
+	if (slots_[slotIndex] != 0)
+		return slots_[slotIndex] - 1;
+
+	// The index is kept at most half full, so that probe sequences stay short
+	if ((offsets_.size() + 1) * 2 > slots_.size())
+	{
+		rehash(slots_.size() * 2);
+		slotIndex = findSlot(string, length);
+	}
+
+	const unsigned int offset = chars_.size();
+	if (offset + length + 1 > chars_.capacity())
+	{
+		const unsigned int newCapacity = chars_.capacity() * 2;
+		chars_.setCapacity(newCapacity > offset + length + 1 ? newCapacity : offset + length + 1);
+	}
+	chars_.setSize(offset + length + 1);
+	memcpy(chars_.data() + offset, string, length);
+	chars_[offset + length] = '\0';
+
+	const Id id = offsets_.size();
+	offsets_.pushBack(offset);
+	slots_[slotIndex] = id + 1;
+
+	return id;
+}
+
+StringTable::Id StringTable::find(const char *string) const
+{
+	const unsigned int length = strlen(string);
+	if (length == 0)
+		return EmptyId;
+
+	const unsigned int slotIndex = findSlot(string, length);
+	return (slots_[slotIndex] != 0) ? slots_[slotIndex] - 1 : EmptyId;
+}
+
+const char *StringTable::string(Id id) const
+{
+	if (id >= offsets_.size())
+		return chars_.data();
+	return chars_.data() + offsets_[id];
+}
+
+unsigned int StringTable::length(Id id) const
+{
+	if (id == EmptyId || id >= offsets_.size())
+		return 0;
+
+	const unsigned int end = (id + 1 < offsets_.size()) ? offsets_[id + 1] : chars_.size();
+	return end - offsets_[id] - 1;
+}
+
+void StringTable::clear()
+{
+	chars_.clear();
+	chars_.pushBack('\0');
+	offsets_.clear();
+	offsets_.pushBack(0);
+
+	slots_.clear();
+	slots_.setSize(InitialNumSlots);
+	for (unsigned int i = 0; i < slots_.size(); i++)
+		slots_[i] = 0;
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+/// Returns the slot that contains the string or the empty slot where it should be inserted
+unsigned int StringTable::findSlot(const char *string, unsigned int length) const
+{
+	const unsigned int mask = slots_.size() - 1;
+	unsigned int slotIndex = hash(string, length) & mask;
+	while (slots_[slotIndex] != 0)
+	{
+		const Id id = slots_[slotIndex] - 1;
+		if (this->length(id) == length && memcmp(chars_.data() + offsets_[id], string, length) == 0)
+			break;
+		slotIndex = (slotIndex + 1) & mask;
+	}
+
+	return slotIndex;
+}
+
+void StringTable::rehash(unsigned int numSlots)
+{
+	slots_.clear();
+	slots_.setSize(numSlots);
+	for (unsigned int i = 0; i < slots_.size(); i++)
+		slots_[i] = 0;
+
+	const unsigned int mask = numSlots - 1;
+	for (Id id = 1; id < offsets_.size(); id++)
+	{
+		unsigned int slotIndex = hash(chars_.data() + offsets_[id], length(id)) & mask;
+		while (slots_[slotIndex] != 0)
+			slotIndex = (slotIndex + 1) & mask;
+		slots_[slotIndex] = id + 1;
+	}
+}
+
+/// FNV-1a hash of the characters of a string
+uint32_t StringTable::hash(const char *string, unsigned int length)
+{
+	uint32_t hash = 0x811c9dc5;
+	for (unsigned int i = 0; i < length; i++)
+	{
+		hash ^= static_cast<unsigned char>(string[i]);
+		hash *= 0x01000193;
+	}
+	return hash;
+}
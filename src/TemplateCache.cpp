@@ -0,0 +1,230 @@
+#include <nctl/HashMap.h>
+#include <nctl/UniquePtr.h>
+#include <ncine/FileSystem.h>
+
+#include "TemplateCache.h"
+#include "FileUtils.h"
+
+namespace {
+
+struct CacheEntry
+{
+	nc::fs::FileDate date = {};
+	long int size = 0;
+	MapModel::ObjectTemplate objectTemplate;
+	StringTable strings;
+};
+
+using CacheHashMap = nctl::HashMap<nctl::String, CacheEntry, nctl::FNV1aHashFuncContainer<nctl::String>>;
+
+nctl::UniquePtr<CacheHashMap> cache;
+unsigned int numCacheHits = 0;
+unsigned int numCacheMisses = 0;
+
+/// The flipping flags in the highest bits of a GID
+const unsigned int GidFlagsMask = 0xf0000000;
+
+/// Marks a template file that has been referenced but could not be loaded
+const int InvalidTemplate = -2;
+
+/// Copies a template from one string table to another, except for the `source` field
+void copyTemplateContent(MapModel::ObjectTemplate &dest, StringTable &destStrings, const MapModel::ObjectTemplate &src, const StringTable &srcStrings)
+{
+	const MapModel::StringId source = dest.source;
+
+	dest = src;
+
+	dest.source = source;
+	dest.tileSetSource = destStrings.intern(srcStrings, src.tileSetSource);
+	MapModel::Object &object = dest.object;
+	object.name = destStrings.intern(srcStrings, object.name);
+	object.type = destStrings.intern(srcStrings, object.type);
+	object.templateFile = StringTable::EmptyId;
+	object.text.fontFamily = destStrings.intern(srcStrings, object.text.fontFamily);
+	MapModel::reinternProperties(object.properties, srcStrings, destStrings);
+}
+
+/// Converts the GID of a tile template from its own tileset to the same tileset in the map
+void remapTemplateGid(MapModel::ObjectTemplate &objectTemplate, const char *templatePath, const MapModel &mapModel)
+{
+	MapModel::Object &object = objectTemplate.object;
+	if (object.objectType != MapModel::ObjectType::Tile || objectTemplate.tileSetSource == StringTable::EmptyId)
+		return;
+
+	const nctl::String templateDirName = nc::fs::dirName(templatePath);
+	const nctl::String tileSetPath = FileUtils::cacheKey(nc::fs::joinPath(templateDirName, nctl::String(mapModel.string(objectTemplate.tileSetSource))).data());
+
+	const nctl::Array<MapModel::TileSet> &tileSets = mapModel.map().tileSets;
+	for (unsigned int i = 0; i < tileSets.size(); i++)
+	{
+		const MapModel::TileSet &tileSet = tileSets[i];
+		if (tileSet.source == StringTable::EmptyId)
+			continue;
+
+		const nctl::String mapTileSetPath = FileUtils::cacheKey(nc::fs::joinPath(mapModel.tmxDirName(), nctl::String(mapModel.string(tileSet.source))).data());
+		if (mapTileSetPath == tileSetPath)
+		{
+			const unsigned int flags = object.gid & GidFlagsMask;
+			object.gid = ((object.gid & ~GidFlagsMask) - objectTemplate.tileSetFirstGid + tileSet.firstGid) | flags;
+			return;
+		}
+	}
+
+	LOGW_X("The tileset \"%s\" of template \"%s\" is not used by the map", mapModel.string(objectTemplate.tileSetSource), templatePath);
+}
+
+/// Copies the fields of a template that have not been overridden by an instance
+void applyTemplate(MapModel::ObjectArray &objects, unsigned int index, const MapModel::Object &object)
+{
+	using Override = MapModel::ObjectOverride;
+
+	MapModel::ObjectDetails &details = objects.details[index];
+	const unsigned char overrides = details.overrides;
+	if ((overrides & Override::Name) == 0)
+		details.name = object.name;
+	if ((overrides & Override::Type) == 0)
+		details.type = object.type;
+	if ((overrides & Override::Width) == 0)
+		objects.sizes[index].x = object.width;
+	if ((overrides & Override::Height) == 0)
+		objects.sizes[index].y = object.height;
+	if ((overrides & Override::Rotation) == 0)
+		objects.rotations[index] = object.rotation;
+	if ((overrides & Override::Visible) == 0)
+		objects.visible[index] = object.visible;
+
+	// An instance without a shape element or a GID has the shape of its template, its points and text are not copied
+	if (objects.objectTypes[index] == MapModel::ObjectType::Rectangle && (overrides & Override::Gid) == 0)
+	{
+		objects.objectTypes[index] = object.objectType;
+		objects.gids[index] = object.gid;
+	}
+	else
+		details.overrides |= Override::Shape;
+}
+
+}
+
+bool TemplateCache::resolve(MapModel &mapModel, ParseFunction parseFunction)
+{
+	MapModel::Map &map = mapModel.map();
+	StringTable &strings = mapModel.strings();
+
+	// Template files are referenced by string handle, every one of them is looked up and loaded only once
+	nctl::Array<int> templateIndices;
+	templateIndices.setSize(strings.size());
+	for (unsigned int i = 0; i < templateIndices.size(); i++)
+		templateIndices[i] = -1;
+
+	bool allLoaded = true;
+	for (unsigned int groupIdx = 0; groupIdx < map.objectGroups.size(); groupIdx++)
+	{
+		MapModel::ObjectArray &objects = map.objectGroups[groupIdx].objects;
+		bool hasInstances = false;
+		for (unsigned int objectIdx = 0; objectIdx < objects.size(); objectIdx++)
+		{
+			MapModel::ObjectDetails &details = objects.details[objectIdx];
+			if (details.templateFile == StringTable::EmptyId)
+				continue;
+
+			int &templateIndex = templateIndices[details.templateFile];
+			if (templateIndex == -1)
+			{
+				const nctl::String templatePath = nc::fs::joinPath(mapModel.tmxDirName(), nctl::String(strings.string(details.templateFile)));
+				MapModel::ObjectTemplate objectTemplate;
+				objectTemplate.source = details.templateFile;
+				if (retrieve(templatePath.data(), objectTemplate, strings) == false)
+				{
+					// The template is parsed with its own string table, the same one that is stored in the cache
+					MapModel::ObjectTemplate parsedTemplate;
+					StringTable parsedStrings;
+					if (parseFunction(templatePath.data(), parsedTemplate, parsedStrings))
+					{
+						copyTemplateContent(objectTemplate, strings, parsedTemplate, parsedStrings);
+						insert(templatePath.data(), parsedTemplate, parsedStrings);
+					}
+					else
+					{
+						LOGE_X("Cannot load template \"%s\"", templatePath.data());
+						templateIndex = InvalidTemplate;
+						allLoaded = false;
+						continue;
+					}
+				}
+
+				remapTemplateGid(objectTemplate, templatePath.data(), mapModel);
+				map.templates.pushBack(nctl::move(objectTemplate));
+				templateIndex = map.templates.size() - 1;
+			}
+			else if (templateIndex == InvalidTemplate)
+				continue;
+
+			details.templateIndex = templateIndex;
+			applyTemplate(objects, objectIdx, map.templates[templateIndex].object);
+			hasInstances = true;
+		}
+
+		if (hasInstances)
+			objects.shrinkToFit();
+	}
+
+	return allLoaded;
+}
+
+bool TemplateCache::retrieve(const char *filename, MapModel::ObjectTemplate &objectTemplate, StringTable &strings)
+{
+	const CacheEntry *entry = cache ? cache->find(FileUtils::cacheKey(filename)) : nullptr;
+	if (entry == nullptr || entry->size != nc::fs::fileSize(filename) ||
+	    FileUtils::isSameDate(entry->date, nc::fs::lastModificationTime(filename)) == false)
+	{
+		numCacheMisses++;
+		return false;
+	}
+
+	copyTemplateContent(objectTemplate, strings, entry->objectTemplate, entry->strings);
+	numCacheHits++;
+	return true;
+}
+
+void TemplateCache::insert(const char *filename, const MapModel::ObjectTemplate &objectTemplate, const StringTable &strings)
+{
+	if (cache.get() == nullptr)
+		cache = nctl::makeUnique<CacheHashMap>(Capacity * 2);
+
+	const nctl::String key = FileUtils::cacheKey(filename);
+	CacheEntry *entry = cache->find(key);
+	if (entry == nullptr)
+	{
+		if (cache->size() >= Capacity)
+			cache->clear();
+		cache->insert(key, CacheEntry());
+		entry = cache->find(key);
+	}
+
+	entry->date = nc::fs::lastModificationTime(filename);
+	entry->size = nc::fs::fileSize(filename);
+	// The entry only keeps the strings of its template
+	entry->strings.clear();
+	copyTemplateContent(entry->objectTemplate, entry->strings, objectTemplate, strings);
+}
+
+void TemplateCache::clear()
+{
+	if (cache)
+		cache->clear();
+}
+
+unsigned int TemplateCache::size()
+{
+	return cache ? cache->size() : 0;
+}
+
+unsigned int TemplateCache::numHits()
+{
+	return numCacheHits;
+}
+
+unsigned int TemplateCache::numMisses()
+{
+	return numCacheMisses;
+}
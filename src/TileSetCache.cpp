@@ -0,0 +1,197 @@
+#include <nctl/HashMap.h>
+#include <nctl/UniquePtr.h>
+#include <ncine/FileSystem.h>
+
+#include "TileSetCache.h"
+#include "FileUtils.h"
+#include "WorkerPool.h"
+#include "MappedFile.h"
+
+namespace {
+
+struct CacheEntry
+{
+	nc::fs::FileDate date = {};
+	long int size = 0;
+	MapModel::TileSet tileSet;
+	StringTable strings;
+};
+
+using CacheHashMap = nctl::HashMap<nctl::String, CacheEntry, nctl::FNV1aHashFuncContainer<nctl::String>>;
+
+/// Created on first use so that it is allocated after the engine has been initialized
+nctl::UniquePtr<CacheHashMap> cache;
+unsigned int numCacheHits = 0;
+unsigned int numCacheMisses = 0;
+
+/// Copies a tileset from one string table to another, except for the `firstGid` and `source` fields
+void copyTileSetContent(MapModel::TileSet &dest, StringTable &destStrings, const MapModel::TileSet &src, const StringTable &srcStrings)
+{
+	const unsigned int firstGid = dest.firstGid;
+	const MapModel::StringId source = dest.source;
+
+	dest = src;
+
+	dest.firstGid = firstGid;
+	dest.source = source;
+	dest.name = destStrings.intern(srcStrings, src.name);
+	dest.image.source = destStrings.intern(srcStrings, src.image.source);
+	for (unsigned int i = 0; i < dest.terrainTypes.size(); i++)
+	{
+		MapModel::Terrain &terrain = dest.terrainTypes[i];
+		terrain.name = destStrings.intern(srcStrings, terrain.name);
+		MapModel::reinternProperties(terrain.properties, srcStrings, destStrings);
+	}
+	for (unsigned int i = 0; i < dest.tiles.size(); i++)
+		MapModel::reinternProperties(dest.tiles[i].properties, srcStrings, destStrings);
+	MapModel::reinternProperties(dest.properties, srcStrings, destStrings);
+}
+
+/// The capacity of the error string of a job, as it is formatted by a worker thread without allocating
+const unsigned int MaxErrorLength = 256;
+
+/// An external tileset that has to be parsed from a TSX file
+struct TsxJob
+{
+	TsxJob()
+	    : tileSetIndex(0), hasLoaded(false), error(MaxErrorLength) {}
+
+	unsigned int tileSetIndex;
+	nctl::String filePath;
+	/// Opened by the calling thread, as opening a file might log
+	nctl::UniquePtr<MappedFile> file;
+	/// The tileset is parsed with its own string table, as the one of the map cannot be shared between threads
+	MapModel::TileSet tileSet;
+	StringTable strings;
+	bool hasLoaded;
+	/// Filled by the worker thread if the file cannot be parsed, logged by the calling thread
+	nctl::String error;
+};
+
+struct TsxJobsData
+{
+	nctl::Array<TsxJob> *jobs;
+	TileSetCache::ParseFunction parseFunction;
+};
+
+/// Parses the contents of a TSX file, it only writes to its own job
+void loadTsxJob(unsigned int jobIndex, void *userData)
+{
+	TsxJobsData &data = *static_cast<TsxJobsData *>(userData);
+	TsxJob &job = (*data.jobs)[jobIndex];
+	job.hasLoaded = data.parseFunction(job.filePath.data(), job.file->data(), job.file->size(), job.tileSet, job.strings, job.error);
+}
+
+}
+
+bool TileSetCache::loadExternal(nctl::Array<MapModel::TileSet> &tileSets, StringTable &strings, const nctl::String &tmxDirName, nctl::String &tsxDirName, ParseFunction parseFunction)
+{
+	bool allLoaded = true;
+	nctl::Array<TsxJob> tsxJobs;
+	for (unsigned int i = 0; i < tileSets.size(); i++)
+	{
+		MapModel::TileSet &tileSet = tileSets[i];
+		if (tileSet.source == StringTable::EmptyId)
+			continue;
+
+		nctl::String tsxFilePath = nc::fs::joinPath(tmxDirName, nctl::String(strings.string(tileSet.source)));
+		tsxDirName = nc::fs::dirName(tsxFilePath.data());
+		if (retrieve(tsxFilePath.data(), tileSet, strings) == false)
+		{
+			nctl::UniquePtr<MappedFile> tsxFile = nctl::makeUnique<MappedFile>();
+			if (tsxFile->open(tsxFilePath.data()) == false)
+			{
+				allLoaded = false;
+				continue;
+			}
+
+			tsxJobs.emplaceBack();
+			TsxJob &job = tsxJobs.back();
+			job.tileSetIndex = i;
+			job.filePath = nctl::move(tsxFilePath);
+			job.file = nctl::move(tsxFile);
+		}
+	}
+
+	TsxJobsData jobsData;
+	jobsData.jobs = &tsxJobs;
+	jobsData.parseFunction = parseFunction;
+	WorkerPool::run(tsxJobs.size(), loadTsxJob, &jobsData);
+
+	// The cache, the string table of the map and the logger are only accessed by the calling thread, in tileset order
+	for (unsigned int i = 0; i < tsxJobs.size(); i++)
+	{
+		const TsxJob &job = tsxJobs[i];
+		if (job.hasLoaded)
+		{
+			copyTileSetContent(tileSets[job.tileSetIndex], strings, job.tileSet, job.strings);
+			insert(job.filePath.data(), job.tileSet, job.strings);
+		}
+		else
+		{
+			LOGE_X("Cannot parse the external tileset \"%s\": %s", job.filePath.data(), job.error.data());
+			allLoaded = false;
+		}
+	}
+
+	return allLoaded;
+}
+
+bool TileSetCache::retrieve(const char *filename, MapModel::TileSet &tileSet, StringTable &strings)
+{
+	const CacheEntry *entry = cache ? cache->find(FileUtils::cacheKey(filename)) : nullptr;
+	if (entry == nullptr || entry->size != nc::fs::fileSize(filename) ||
+	    FileUtils::isSameDate(entry->date, nc::fs::lastModificationTime(filename)) == false)
+	{
+		numCacheMisses++;
+		return false;
+	}
+
+	copyTileSetContent(tileSet, strings, entry->tileSet, entry->strings);
+	numCacheHits++;
+	return true;
+}
+
+void TileSetCache::insert(const char *filename, const MapModel::TileSet &tileSet, const StringTable &strings)
+{
+	// The hash map has twice the capacity of the cache to keep its load factor low
+	if (cache.get() == nullptr)
+		cache = nctl::makeUnique<CacheHashMap>(Capacity * 2);
+
+	const nctl::String key = FileUtils::cacheKey(filename);
+	CacheEntry *entry = cache->find(key);
+	if (entry == nullptr)
+	{
+		if (cache->size() >= Capacity)
+			cache->clear();
+		cache->insert(key, CacheEntry());
+		entry = cache->find(key);
+	}
+
+	entry->date = nc::fs::lastModificationTime(filename);
+	entry->size = nc::fs::fileSize(filename);
+	// The entry only keeps the strings of its tileset
+	entry->strings.clear();
+	copyTileSetContent(entry->tileSet, entry->strings, tileSet, strings);
+}
+
+void TileSetCache::clear()
+{
+	if (cache)
+		cache->clear();
+}
+
+unsigned int TileSetCache::size()
+{
+	return cache ? cache->size() : 0;
+}
+
+unsigned int TileSetCache::numHits()
+{
+	return numCacheHits;
+}
+
+unsigned int TileSetCache::numMisses()
+{
+	return numCacheMisses;
+}
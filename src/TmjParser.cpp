@@ -0,0 +1,550 @@
+#include <cstring> // for `strcmp()`
+#include <nctl/CString.h>
+#include <ncine/FileSystem.h>
+
+#include "TmjParser.h"
+#include "TmxStreamParser.h"
+#include "JsonStreamReader.h"
+#include "TmxAttributes.h"
+#include "LayerDecoder.h"
+#include "TileSetCache.h"
+#include "TemplateCache.h"
+#include "MappedFile.h"
+
+namespace {
+
+using Type = JsonStreamReader::Type;
+
+inline bool equals(const char *first, const char *second)
+{
+	return strcmp(first, second) == 0;
+}
+
+inline bool isScalar(Type type)
+{
+	return (type == Type::String || type == Type::Number || type == Type::Boolean);
+}
+
+/// Advances to the next element of an array if it is an object, skipping any other value
+bool nextObjectElement(JsonStreamReader &reader)
+{
+	while (reader.nextElement())
+	{
+		const Type type = reader.readValue();
+		if (type == Type::Object)
+			return true;
+		else if (reader.skip(type) == false)
+			return false;
+	}
+	return false;
+}
+
+/// Applies all the scalar members of an opened object, skipping the others
+template <class T>
+void applyMembers(T &model, JsonStreamReader &reader, bool (*applyFunction)(T &, const char *, const char *))
+{
+	while (reader.nextKey())
+	{
+		const Type type = reader.readValue();
+		if (isScalar(type))
+			applyFunction(model, reader.key(), reader.value());
+		else
+			reader.skip(type);
+	}
+}
+
+void parseProperties(JsonStreamReader &reader, StringTable &strings, nctl::Array<MapModel::Property> &properties)
+{
+	while (nextObjectElement(reader))
+	{
+		properties.emplaceBack();
+		MapModel::Property &property = properties.back();
+
+		const char *value = nullptr;
+		while (reader.nextKey())
+		{
+			const Type type = reader.readValue();
+			if (isScalar(type) == false)
+				reader.skip(type); // Not parsing class properties
+			else if (equals(reader.key(), "value"))
+				value = reader.value();
+			else
+				TmxAttributes::applyProperty(property, strings, reader.key(), reader.value());
+		}
+
+		// The value is applied last as it depends on the type
+		if (value != nullptr)
+			TmxAttributes::applyPropertyValue(property, strings, value);
+	}
+}
+
+void parsePoints(JsonStreamReader &reader, nctl::Array<nc::Vector2f> &points)
+{
+	while (nextObjectElement(reader))
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		while (reader.nextKey())
+		{
+			const Type type = reader.readValue();
+			if (type == Type::Number && equals(reader.key(), "x"))
+				x = TmxAttributes::toFloat(reader.value());
+			else if (type == Type::Number && equals(reader.key(), "y"))
+				y = TmxAttributes::toFloat(reader.value());
+			else
+				reader.skip(type);
+		}
+		points.emplaceBack(x, y);
+	}
+}
+
+void parseText(JsonStreamReader &reader, StringTable &strings, MapModel::Text &text)
+{
+	text.data[0] = '\0';
+	while (reader.nextKey())
+	{
+		const Type type = reader.readValue();
+		if (type == Type::String && equals(reader.key(), "text"))
+			nctl::strncpy(text.data, reader.value(), MapModel::Text::MaxDataLength - 1);
+		else if (isScalar(type))
+			TmxAttributes::applyText(text, strings, reader.key(), reader.value());
+		else
+			reader.skip(type);
+	}
+}
+
+void parseObject(JsonStreamReader &reader, StringTable &strings, MapModel::Object &object)
+{
+	// Objects without a `gid` member are rectangles unless they have a shape member
+	object.objectType = MapModel::ObjectType::Rectangle;
+
+	while (reader.nextKey())
+	{
+		const char *key = reader.key();
+		const Type type = reader.readValue();
+		if (type == Type::Array && (equals(key, "polygon") || equals(key, "polyline")))
+		{
+			object.objectType = equals(key, "polygon") ? MapModel::ObjectType::Polygon : MapModel::ObjectType::Polyline;
+			parsePoints(reader, object.points);
+		}
+		else if (type == Type::Object && equals(key, "text"))
+		{
+			object.objectType = MapModel::ObjectType::Text;
+			parseText(reader, strings, object.text);
+		}
+		else if (type == Type::Array && equals(key, "properties"))
+			parseProperties(reader, strings, object.properties);
+		else if (type == Type::Boolean && equals(key, "ellipse"))
+		{
+			if (TmxAttributes::toBool(reader.value()))
+				object.objectType = MapModel::ObjectType::Ellipse;
+		}
+		else if (type == Type::Boolean && equals(key, "point"))
+		{
+			if (TmxAttributes::toBool(reader.value()))
+				object.objectType = MapModel::ObjectType::Point;
+		}
+		else if (isScalar(type))
+		{
+			// Since Tiled 1.9 the type of an object is called class
+			TmxAttributes::applyObject(object, strings, equals(key, "class") ? "type" : key, reader.value());
+		}
+		else
+			reader.skip(type);
+	}
+}
+
+/// The data of a layer or of a chunk, decoded once the whole map has been read
+struct PendingData
+{
+	const char *string = nullptr;
+	bool isArray = false;
+};
+
+/// Reads the data member of a layer or of a chunk, an array of GIDs or an encoded string
+void readData(JsonStreamReader &reader, Type type, PendingData &pendingData)
+{
+	if (type == Type::String)
+	{
+		pendingData.string = reader.value();
+		pendingData.isArray = false;
+	}
+	else if (type == Type::Array && reader.readNumberArray())
+	{
+		pendingData.string = reader.value();
+		pendingData.isArray = true;
+	}
+	else
+		reader.skip(type);
+}
+
+void parseChunks(JsonStreamReader &reader, MapModel::Layer &layer, nctl::Array<PendingData> &chunksData)
+{
+	while (nextObjectElement(reader))
+	{
+		layer.chunks.emplaceBack();
+		MapModel::Chunk &chunk = layer.chunks.back();
+		chunksData.emplaceBack();
+
+		while (reader.nextKey())
+		{
+			const char *key = reader.key();
+			const Type type = reader.readValue();
+			if (equals(key, "data"))
+				readData(reader, type, chunksData.back());
+			else if (isScalar(type))
+				TmxAttributes::applyChunk(chunk, key, reader.value());
+			else
+				reader.skip(type);
+		}
+	}
+}
+
+/// The type of a layer is only known at the end of its object, as keys are usually sorted alphabetically
+void parseLayer(JsonStreamReader &reader, StringTable &strings, MapModel::Map &map, int groupIndex, LayerDecoder &layerDecoder)
+{
+	MapModel::Layer layer;
+	MapModel::ObjectGroup objectGroup;
+	MapModel::ImageLayer imageLayer;
+	MapModel::Group group;
+	// The group is added before its children, so that it comes before them in the array
+	int childGroupIndex = -1;
+	nctl::Array<MapModel::Property> properties;
+	PendingData pendingData;
+	nctl::Array<PendingData> chunksData;
+	const char *layerType = "";
+
+	while (reader.nextKey())
+	{
+		const char *key = reader.key();
+		const Type type = reader.readValue();
+		if (equals(key, "data"))
+			readData(reader, type, pendingData);
+		else if (type == Type::Array && equals(key, "chunks"))
+			parseChunks(reader, layer, chunksData);
+		else if (type == Type::Array && equals(key, "objects"))
+		{
+			while (nextObjectElement(reader))
+			{
+				MapModel::Object object;
+				parseObject(reader, strings, object);
+				objectGroup.objects.append(object);
+			}
+			objectGroup.objects.shrinkToFit();
+		}
+		else if (type == Type::Array && equals(key, "layers"))
+		{
+			map.groups.emplaceBack();
+			childGroupIndex = map.groups.size() - 1;
+			while (nextObjectElement(reader))
+				parseLayer(reader, strings, map, childGroupIndex, layerDecoder);
+		}
+		else if (type == Type::Array && equals(key, "properties"))
+			parseProperties(reader, strings, properties);
+		else if (type == Type::String && equals(key, "type"))
+			layerType = reader.value();
+		else if (type == Type::String && equals(key, "image"))
+			TmxAttributes::applyImage(imageLayer.image, strings, "source", reader.value());
+		else if (type == Type::String && equals(key, "transparentcolor"))
+			TmxAttributes::applyImage(imageLayer.image, strings, "trans", reader.value());
+		else if (isScalar(type))
+		{
+			const char *value = reader.value();
+			TmxAttributes::applyLayer(layer, strings, key, value);
+			TmxAttributes::applyData(layer.data, key, value);
+			TmxAttributes::applyObjectGroup(objectGroup, strings, key, value);
+			TmxAttributes::applyImageLayer(imageLayer, strings, key, value);
+			TmxAttributes::applyGroup(group, strings, key, value);
+		}
+		else
+			reader.skip(type);
+	}
+
+	if (equals(layerType, "tilelayer"))
+	{
+		// The encoding member is optional, the type of the data is enough to know it
+		const bool isArray = chunksData.isEmpty() ? pendingData.isArray : chunksData[0].isArray;
+		layer.data.encoding = isArray ? MapModel::Encoding::CSV : MapModel::Encoding::Base64;
+		layer.properties = nctl::move(properties);
+		layer.groupIndex = groupIndex;
+		map.layers.pushBack(nctl::move(layer));
+
+		const unsigned int layerIndex = map.layers.size() - 1;
+		map.addDrawEntry(MapModel::LayerType::TileLayer, layerIndex);
+		for (unsigned int i = 0; i < chunksData.size(); i++)
+			layerDecoder.addChunk(layerIndex, chunksData[i].string ? chunksData[i].string : "");
+		if (chunksData.isEmpty() && pendingData.string != nullptr)
+			layerDecoder.addLayer(layerIndex, pendingData.string);
+	}
+	else if (equals(layerType, "objectgroup"))
+	{
+		objectGroup.properties = nctl::move(properties);
+		objectGroup.groupIndex = groupIndex;
+		map.objectGroups.pushBack(nctl::move(objectGroup));
+		map.addDrawEntry(MapModel::LayerType::ObjectGroup, map.objectGroups.size() - 1);
+	}
+	else if (equals(layerType, "imagelayer"))
+	{
+		imageLayer.properties = nctl::move(properties);
+		imageLayer.groupIndex = groupIndex;
+		map.imageLayers.pushBack(nctl::move(imageLayer));
+		map.addDrawEntry(MapModel::LayerType::ImageLayer, map.imageLayers.size() - 1);
+	}
+	else if (equals(layerType, "group"))
+	{
+		// A group without the layers member has no children
+		if (childGroupIndex < 0)
+		{
+			map.groups.emplaceBack();
+			childGroupIndex = map.groups.size() - 1;
+		}
+		group.properties = nctl::move(properties);
+		group.parentIndex = groupIndex;
+		map.groups[childGroupIndex] = nctl::move(group);
+	}
+}
+
+void parseTile(JsonStreamReader &reader, StringTable &strings, MapModel::Tile &tile)
+{
+	while (reader.nextKey())
+	{
+		const char *key = reader.key();
+		const Type type = reader.readValue();
+		if (type == Type::Array && equals(key, "animation"))
+		{
+			while (nextObjectElement(reader))
+			{
+				tile.frames.emplaceBack();
+				applyMembers(tile.frames.back(), reader, TmxAttributes::applyFrame);
+			}
+		}
+		else if (type == Type::Array && equals(key, "terrain"))
+		{
+			// The same comma separated list of the XML attribute
+			if (reader.readNumberArray())
+				TmxAttributes::applyTile(tile, key, reader.value());
+			else
+				reader.skip(type);
+		}
+		else if (type == Type::Array && equals(key, "properties"))
+			parseProperties(reader, strings, tile.properties);
+		else if (isScalar(type))
+			TmxAttributes::applyTile(tile, key, reader.value());
+		else
+			reader.skip(type); // Not parsing the image and the object group of a tile
+	}
+}
+
+void parseTileSetContent(JsonStreamReader &reader, StringTable &strings, MapModel::TileSet &tileSet)
+{
+	while (reader.nextKey())
+	{
+		const char *key = reader.key();
+		const Type type = reader.readValue();
+		if (type == Type::Object && equals(key, "tileoffset"))
+			applyMembers(tileSet.tileOffset, reader, TmxAttributes::applyTileOffset);
+		else if (type == Type::Object && equals(key, "grid"))
+			applyMembers(tileSet.grid, reader, TmxAttributes::applyGrid);
+		else if (type == Type::Array && equals(key, "terrains"))
+		{
+			while (nextObjectElement(reader))
+			{
+				tileSet.terrainTypes.emplaceBack();
+				MapModel::Terrain &terrain = tileSet.terrainTypes.back();
+				while (reader.nextKey())
+				{
+					const Type memberType = reader.readValue();
+					if (memberType == Type::Array && equals(reader.key(), "properties"))
+						parseProperties(reader, strings, terrain.properties);
+					else if (isScalar(memberType))
+						TmxAttributes::applyTerrain(terrain, strings, reader.key(), reader.value());
+					else
+						reader.skip(memberType);
+				}
+			}
+		}
+		else if (type == Type::Array && equals(key, "tiles"))
+		{
+			while (nextObjectElement(reader))
+			{
+				tileSet.tiles.emplaceBack();
+				parseTile(reader, strings, tileSet.tiles.back());
+			}
+		}
+		else if (type == Type::Array && equals(key, "properties"))
+			parseProperties(reader, strings, tileSet.properties);
+		else if (type == Type::String && equals(key, "image"))
+			TmxAttributes::applyImage(tileSet.image, strings, "source", reader.value());
+		else if (type == Type::Number && equals(key, "imagewidth"))
+			TmxAttributes::applyImage(tileSet.image, strings, "width", reader.value());
+		else if (type == Type::Number && equals(key, "imageheight"))
+			TmxAttributes::applyImage(tileSet.image, strings, "height", reader.value());
+		else if (type == Type::String && equals(key, "transparentcolor"))
+			TmxAttributes::applyImage(tileSet.image, strings, "trans", reader.value());
+		else if (isScalar(type))
+			TmxAttributes::applyTileSet(tileSet, strings, key, reader.value());
+		else
+			reader.skip(type); // Not parsing Wang sets
+	}
+}
+
+void parseMap(JsonStreamReader &reader, StringTable &strings, MapModel::Map &map, LayerDecoder &layerDecoder)
+{
+	while (reader.nextKey())
+	{
+		const char *key = reader.key();
+		const Type type = reader.readValue();
+		if (type == Type::Array && equals(key, "tilesets"))
+		{
+			while (nextObjectElement(reader))
+			{
+				map.tileSets.emplaceBack();
+				// The object of an external tileset only has the `firstgid` and `source` members
+				parseTileSetContent(reader, strings, map.tileSets.back());
+			}
+		}
+		else if (type == Type::Array && equals(key, "layers"))
+		{
+			while (nextObjectElement(reader))
+				parseLayer(reader, strings, map, -1, layerDecoder);
+		}
+		else if (type == Type::Array && equals(key, "properties"))
+			parseProperties(reader, strings, map.properties);
+		else if (isScalar(type))
+			TmxAttributes::applyMap(map, key, reader.value());
+		else
+			reader.skip(type); // Not parsing editor settings
+	}
+
+	map.accumulateGroupValues();
+}
+
+void parseTemplate(JsonStreamReader &reader, StringTable &strings, MapModel::ObjectTemplate &objectTemplate)
+{
+	while (reader.nextKey())
+	{
+		const char *key = reader.key();
+		const Type type = reader.readValue();
+		if (type == Type::Object && equals(key, "tileset"))
+		{
+			// The tileset of a template is always external
+			MapModel::TileSet tileSet;
+			parseTileSetContent(reader, strings, tileSet);
+			objectTemplate.tileSetSource = tileSet.source;
+			objectTemplate.tileSetFirstGid = tileSet.firstGid;
+		}
+		else if (type == Type::Object && equals(key, "object"))
+			parseObject(reader, strings, objectTemplate.object);
+		else
+			reader.skip(type);
+	}
+}
+
+bool checkErrors(const JsonStreamReader &reader)
+{
+	if (reader.errorDescription() != nullptr)
+	{
+		LOGE_X("Error description: %s", reader.errorDescription());
+		LOGE_X("Error offset: %lu", reader.errorOffset());
+		return false;
+	}
+	return true;
+}
+
+/// Describes a parsing error in a string instead of logging it, for the functions that run on worker threads
+bool checkErrors(const JsonStreamReader &reader, nctl::String &error)
+{
+	if (reader.errorDescription() != nullptr)
+	{
+		error.format("%s at offset %lu", reader.errorDescription(), reader.errorOffset());
+		return false;
+	}
+	return true;
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+bool TmjParser::loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize, bool lazyDecoding)
+{
+	JsonStreamReader reader(reinterpret_cast<char *>(bufferPtr), bufferSize);
+	if (reader.readValue() != Type::Object)
+	{
+		checkErrors(reader);
+		return false;
+	}
+
+	MapModel::Map &map = mapModel.map();
+	LayerDecoder layerDecoder;
+	parseMap(reader, mapModel.strings(), map, layerDecoder);
+	if (checkErrors(reader) == false)
+		return false;
+
+	if (lazyDecoding)
+		mapModel.setPendingLayers(nctl::makeUnique<LayerDecoder>(nctl::move(layerDecoder)));
+	else
+		layerDecoder.decode(map.layers);
+
+	// External tilesets that are not in the cache are loaded in parallel once the map has been read
+	TileSetCache::loadExternal(map.tileSets, mapModel.strings(), mapModel.tmxDirName(), mapModel.tsxDirName(), loadTileSetFromMemory);
+	TemplateCache::resolve(mapModel, loadTemplateFile);
+
+	return true;
+}
+
+bool TmjParser::loadFromFile(MapModel &mapModel, const char *filename, bool lazyDecoding)
+{
+	// A file whose contents outlive the parsing is read instead of being mapped
+	nctl::UniquePtr<MappedFile> jsonFile = nctl::makeUnique<MappedFile>();
+	const bool hasLoaded = jsonFile->open(filename, lazyDecoding == false);
+	if (hasLoaded == false)
+		return false;
+
+	mapModel.tmxDirName() = nc::fs::dirName(filename);
+
+	const bool hasParsed = loadFromMemory(mapModel, jsonFile->data(), jsonFile->size(), lazyDecoding);
+	if (hasParsed && mapModel.hasPendingLayers())
+		mapModel.setSourceFile(nctl::move(jsonFile));
+	return hasParsed;
+}
+
+bool TmjParser::loadTileSetFromMemory(const char *filename, unsigned char *bufferPtr, unsigned long int bufferSize, MapModel::TileSet &tileSet, StringTable &strings, nctl::String &error)
+{
+	if (nc::fs::hasExtension(filename, "tsx"))
+		return TmxStreamParser::loadTileSetFromMemory(filename, bufferPtr, bufferSize, tileSet, strings, error);
+
+	JsonStreamReader reader(reinterpret_cast<char *>(bufferPtr), bufferSize);
+	if (reader.readValue() != Type::Object)
+	{
+		if (checkErrors(reader, error))
+			error = "The root value is not an object";
+		return false;
+	}
+
+	parseTileSetContent(reader, strings, tileSet);
+	return checkErrors(reader, error);
+}
+
+bool TmjParser::loadTemplateFile(const char *filename, MapModel::ObjectTemplate &objectTemplate, StringTable &strings)
+{
+	if (nc::fs::hasExtension(filename, "tx"))
+		return TmxStreamParser::loadTemplateFile(filename, objectTemplate, strings);
+
+	MappedFile jsonFile;
+	const bool hasLoaded = jsonFile.open(filename);
+	if (hasLoaded == false)
+		return false;
+
+	JsonStreamReader reader(reinterpret_cast<char *>(jsonFile.data()), jsonFile.size());
+	if (reader.readValue() != Type::Object)
+	{
+		checkErrors(reader);
+		return false;
+	}
+
+	parseTemplate(reader, strings, objectTemplate);
+	return checkErrors(reader);
+}
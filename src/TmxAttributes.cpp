@@ -0,0 +1,940 @@
+#include <cstring> // for `strcmp()`, `strncmp()` and `strlen()`
+#include <climits>
+#include <nctl/CString.h>
+
+#include "TmxAttributes.h"
+#include "NumberParser.h"
+
+namespace {
+
+/// The identifiers of all the attribute names known to the parsers
+enum class Attribute : unsigned char
+{
+	Unknown,
+	BackgroundColor,
+	Bold,
+	Color,
+	Columns,
+	Compression,
+	CompressionLevel,
+	DrawOrder,
+	Duration,
+	Encoding,
+	FirstGid,
+	FontFamily,
+	Format,
+	Gid,
+	HAlign,
+	Height,
+	HexSideLength,
+	Id,
+	Infinite,
+	Italic,
+	Kerning,
+	Margin,
+	Name,
+	NextLayerId,
+	NextObjectId,
+	ObjectAlignment,
+	OffsetX,
+	OffsetY,
+	Opacity,
+	Orientation,
+	PixelSize,
+	Probability,
+	RenderOrder,
+	Rotation,
+	Source,
+	Spacing,
+	StaggerAxis,
+	StaggerIndex,
+	Strikeout,
+	Template,
+	Terrain,
+	Tile,
+	TileCount,
+	TiledVersion,
+	TileHeight,
+	TileId,
+	TileWidth,
+	TintColor,
+	Trans,
+	Type,
+	Underline,
+	VAlign,
+	Version,
+	Visible,
+	Width,
+	Wrap,
+	X,
+	Y,
+
+	Count
+};
+
+/// The names of the attributes, in the same order as the `Attribute` enumeration
+const char *const AttributeNames[static_cast<unsigned int>(Attribute::Count)] = {
+	nullptr,
+	"backgroundcolor", "bold", "color", "columns", "compression", "compressionlevel",
+	"draworder", "duration", "encoding", "firstgid", "fontfamily", "format",
+	"gid", "halign", "height", "hexsidelength", "id", "infinite",
+	"italic", "kerning", "margin", "name", "nextlayerid", "nextobjectid",
+	"objectalignment", "offsetx", "offsety", "opacity", "orientation", "pixelsize",
+	"probability", "renderorder", "rotation", "source", "spacing", "staggeraxis",
+	"staggerindex", "strikeout", "template", "terrain", "tile", "tilecount",
+	"tiledversion", "tileheight", "tileid", "tilewidth", "tintcolor", "trans",
+	"type", "underline", "valign", "version", "visible", "width",
+	"wrap", "x", "y",
+};
+
+const unsigned int MaxAttributeNameLength = 16; // "compressionlevel"
+const unsigned int HashTableSize = 256;
+
+/// Hashes the length and three characters of an attribute name
+inline unsigned int hashName(const unsigned char *name, unsigned int length)
+{
+	return (length * 2 + name[0] * 5 + name[length - 1] * 9 + name[length / 2]) & (HashTableSize - 1);
+}
+
+/// The perfect hash table of attribute names, empty slots contain `Attribute::Unknown`
+unsigned char AttributeHashTable[HashTableSize];
+
+/// Fills the hash table from `AttributeNames` during static initialization
+/*! A new name that falls in the slot of another one requires changing `hashName()`. */
+struct AttributeHashTableBuilder
+{
+	AttributeHashTableBuilder()
+	{
+		for (unsigned int i = 1; i < static_cast<unsigned int>(Attribute::Count); i++)
+		{
+			const unsigned int length = static_cast<unsigned int>(strlen(AttributeNames[i]));
+			FATAL_ASSERT_MSG_X(length <= MaxAttributeNameLength, "The attribute name \"%s\" is too long", AttributeNames[i]);
+			const unsigned int slot = hashName(reinterpret_cast<const unsigned char *>(AttributeNames[i]), length);
+			FATAL_ASSERT_MSG_X(AttributeHashTable[slot] == 0, "The attribute names \"%s\" and \"%s\" have the same hash",
+			                   AttributeNames[AttributeHashTable[slot]], AttributeNames[i]);
+			AttributeHashTable[slot] = static_cast<unsigned char>(i);
+		}
+	}
+};
+
+const AttributeHashTableBuilder attributeHashTableBuilder;
+
+/// Returns the identifier of an attribute name with a single hash table probe and a string comparison
+Attribute lookup(const char *name)
+{
+	unsigned int length = 0;
+	while (name[length] != '\0')
+	{
+		if (++length > MaxAttributeNameLength)
+			return Attribute::Unknown;
+	}
+	if (length == 0)
+		return Attribute::Unknown;
+
+	const unsigned char index = AttributeHashTable[hashName(reinterpret_cast<const unsigned char *>(name), length)];
+	if (index != 0 && strcmp(AttributeNames[index], name) == 0)
+		return static_cast<Attribute>(index);
+	return Attribute::Unknown;
+}
+
+inline bool startsWith(const char *string, const char *prefix)
+{
+	return strncmp(string, prefix, strlen(prefix)) == 0;
+}
+
+inline bool isSpace(char c)
+{
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+}
+
+inline const char *skipSpaces(const char *string)
+{
+	while (isSpace(*string))
+		string++;
+	return string;
+}
+
+unsigned int parseIntColor(const char *value)
+{
+	// In the #AARRGGBB or #RRGGBB forms
+	unsigned int hexColor = 0;
+	if (value[0] == '#')
+		NumberParser::parseHex(value + 1, 8, hexColor);
+	return hexColor;
+}
+
+void parseColor(nc::Color &color, const char *value)
+{
+	// In the #AARRGGBB or #RRGGBB forms
+	if (value[0] == '#')
+	{
+		unsigned int hexColor = 0;
+		NumberParser::parseHex(value + 1, 8, hexColor);
+		color.set(hexColor);
+	}
+}
+
+bool parseTileTerrain(int terrain[4], const char *string)
+{
+	// Any of the four comma separated values can be empty, leaving that corner without a terrain
+	const char *buffer = string;
+	for (unsigned int terrainIdx = 0; terrainIdx < 4 && *buffer != '\0'; terrainIdx++)
+	{
+		buffer = NumberParser::parseInt(skipSpaces(buffer), terrain[terrainIdx]);
+		while (*buffer != ',' && *buffer != '\0')
+			buffer++;
+		if (*buffer == ',')
+			buffer++;
+	}
+
+	return true;
+}
+
+/// Skips the whitespace, the sign and the `0x` prefix of an integer, returning the start of its digits
+const char *skipIntPrefix(const char *value, bool &isNegative, int &base)
+{
+	value = skipSpaces(value);
+	isNegative = (*value == '-');
+	if (*value == '-' || *value == '+')
+		value++;
+
+	base = 10;
+	if (value[0] == '0' && (value[1] == 'x' || value[1] == 'X'))
+	{
+		base = 16;
+		value += 2;
+	}
+	return value;
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+bool TmxAttributes::applyMap(MapModel::Map &map, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Version:
+			nctl::strncpy(map.version, value, MapModel::Map::MaxVersionLength - 1);
+			break;
+		case Attribute::TiledVersion:
+			nctl::strncpy(map.tiledVersion, value, MapModel::Map::MaxVersionLength - 1);
+			break;
+		case Attribute::Orientation:
+			if (startsWith(value, "orthogonal"))
+				map.orientation = MapModel::Orientation::Orthogonal;
+			else if (startsWith(value, "isometric"))
+				map.orientation = MapModel::Orientation::Isometric;
+			else if (startsWith(value, "staggered"))
+				map.orientation = MapModel::Orientation::Staggered;
+			else if (startsWith(value, "hexagonal"))
+				map.orientation = MapModel::Orientation::Hexagonal;
+			break;
+		case Attribute::RenderOrder:
+			if (startsWith(value, "right-down"))
+				map.renderOrder = MapModel::RenderOrder::Right_Down;
+			else if (startsWith(value, "right-up"))
+				map.renderOrder = MapModel::RenderOrder::Right_Up;
+			else if (startsWith(value, "left-down"))
+				map.renderOrder = MapModel::RenderOrder::Left_Down;
+			else if (startsWith(value, "left-up"))
+				map.renderOrder = MapModel::RenderOrder::Left_Up;
+			break;
+		case Attribute::CompressionLevel:
+			map.compressionLevel = toInt(value);
+			break;
+		case Attribute::Width:
+			map.width = toInt(value);
+			break;
+		case Attribute::Height:
+			map.height = toInt(value);
+			break;
+		case Attribute::TileWidth:
+			map.tileWidth = toInt(value);
+			break;
+		case Attribute::TileHeight:
+			map.tileHeight = toInt(value);
+			break;
+		case Attribute::HexSideLength:
+			map.hexSideLength = toInt(value);
+			break;
+		case Attribute::StaggerAxis:
+			if (startsWith(value, "x"))
+				map.staggerAxis = MapModel::StaggerAxis::X;
+			else if (startsWith(value, "y"))
+				map.staggerAxis = MapModel::StaggerAxis::Y;
+			break;
+		case Attribute::StaggerIndex:
+			if (startsWith(value, "even"))
+				map.staggerIndex = MapModel::StaggerIndex::Even;
+			else if (startsWith(value, "odd"))
+				map.staggerIndex = MapModel::StaggerIndex::Odd;
+			break;
+		case Attribute::BackgroundColor:
+			parseColor(map.backgroundColor, value);
+			break;
+		case Attribute::NextLayerId:
+			map.nextLayerId = toInt(value);
+			break;
+		case Attribute::NextObjectId:
+			map.nextObjectId = toInt(value);
+			break;
+		case Attribute::Infinite:
+			map.infinite = toBool(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyTileSet(MapModel::TileSet &tileSet, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::FirstGid:
+			tileSet.firstGid = toUint(value);
+			break;
+		case Attribute::Source:
+			tileSet.source = strings.intern(value);
+			break;
+		case Attribute::Name:
+			tileSet.name = strings.intern(value);
+			break;
+		case Attribute::TileWidth:
+			tileSet.tileWidth = toInt(value);
+			break;
+		case Attribute::TileHeight:
+			tileSet.tileHeight = toInt(value);
+			break;
+		case Attribute::Spacing:
+			tileSet.spacing = toInt(value);
+			break;
+		case Attribute::Margin:
+			tileSet.margin = toInt(value);
+			break;
+		case Attribute::TileCount:
+			tileSet.tileCount = toInt(value);
+			break;
+		case Attribute::Columns:
+			tileSet.columns = toInt(value);
+			break;
+		case Attribute::ObjectAlignment:
+			// Longer values are checked first as they share a prefix with shorter ones
+			if (startsWith(value, "unspecified"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::Unspecified;
+			else if (startsWith(value, "topleft"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::TopLeft;
+			else if (startsWith(value, "topright"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::TopRight;
+			else if (startsWith(value, "top"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::Top;
+			else if (startsWith(value, "left"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::Left;
+			else if (startsWith(value, "center"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::Center;
+			else if (startsWith(value, "right"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::Right;
+			else if (startsWith(value, "bottomleft"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::BottomLeft;
+			else if (startsWith(value, "bottomright"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::BottomRight;
+			else if (startsWith(value, "bottom"))
+				tileSet.objectAlignment = MapModel::ObjectAlignment::Bottom;
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyImage(MapModel::Image &image, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Format:
+			nctl::strncpy(image.format, value, MapModel::Image::MaxFormatLength - 1);
+			break;
+		case Attribute::Source:
+			image.source = strings.intern(value);
+			break;
+		case Attribute::Trans:
+		{
+			// In the #RRGGBB or RRGGBB forms, can't use the `parseColor` function in this case
+			unsigned int hexColor = 0;
+			NumberParser::parseHex((value[0] == '#') ? value + 1 : value, 6, hexColor);
+			image.trans.set(hexColor);
+			image.hasTransparency = true;
+			break;
+		}
+		case Attribute::Width:
+			image.width = toInt(value);
+			break;
+		case Attribute::Height:
+			image.height = toInt(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyTileOffset(MapModel::TileOffset &tileOffset, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::X:
+			tileOffset.x = toFloat(value);
+			break;
+		case Attribute::Y:
+			tileOffset.y = toFloat(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyGrid(MapModel::Grid &grid, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Orientation:
+			if (startsWith(value, "orthogonal"))
+				grid.orientation = MapModel::GridOrientation::Orthogonal;
+			else if (startsWith(value, "isometric"))
+				grid.orientation = MapModel::GridOrientation::Isometric;
+			break;
+		case Attribute::Width:
+			grid.width = toInt(value);
+			break;
+		case Attribute::Height:
+			grid.height = toInt(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyTerrain(MapModel::Terrain &terrain, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Name:
+			terrain.name = strings.intern(value);
+			break;
+		case Attribute::Tile:
+			terrain.tile = toInt(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyTile(MapModel::Tile &tile, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Id:
+			tile.id = toInt(value);
+			break;
+		case Attribute::Type:
+			tile.type = toInt(value);
+			break;
+		case Attribute::Terrain:
+			parseTileTerrain(tile.terrain, value);
+			break;
+		case Attribute::Probability:
+			tile.probability = toFloat(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyFrame(MapModel::Frame &frame, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::TileId:
+			frame.tileId = toInt(value);
+			break;
+		case Attribute::Duration:
+			frame.duration = toInt(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyLayer(MapModel::Layer &layer, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Id:
+			layer.id = toInt(value);
+			break;
+		case Attribute::Name:
+			layer.name = strings.intern(value);
+			break;
+		case Attribute::X:
+			layer.x = toInt(value);
+			break;
+		case Attribute::Y:
+			layer.y = toInt(value);
+			break;
+		case Attribute::Width:
+			layer.width = toInt(value);
+			break;
+		case Attribute::Height:
+			layer.height = toInt(value);
+			break;
+		case Attribute::Opacity:
+			layer.opacity = toFloat(value);
+			break;
+		case Attribute::Visible:
+			layer.visible = toBool(value);
+			break;
+		case Attribute::TintColor:
+			parseColor(layer.tintColor, value);
+			break;
+		case Attribute::OffsetX:
+			layer.offsetX = toFloat(value);
+			break;
+		case Attribute::OffsetY:
+			layer.offsetY = toFloat(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyData(MapModel::Data &data, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Encoding:
+			if (startsWith(value, "base64"))
+				data.encoding = MapModel::Encoding::Base64;
+			else if (startsWith(value, "csv"))
+				data.encoding = MapModel::Encoding::CSV;
+			break;
+		case Attribute::Compression:
+			if (startsWith(value, "gzip"))
+				data.compression = MapModel::Compression::gzip;
+			else if (startsWith(value, "zlib"))
+				data.compression = MapModel::Compression::zlib;
+			else if (startsWith(value, "zstd"))
+				data.compression = MapModel::Compression::zstd;
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyChunk(MapModel::Chunk &chunk, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::X:
+			chunk.x = toInt(value);
+			break;
+		case Attribute::Y:
+			chunk.y = toInt(value);
+			break;
+		case Attribute::Width:
+			chunk.width = toInt(value);
+			break;
+		case Attribute::Height:
+			chunk.height = toInt(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyObjectGroup(MapModel::ObjectGroup &objectGroup, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Id:
+			objectGroup.id = toInt(value);
+			break;
+		case Attribute::Name:
+			objectGroup.name = strings.intern(value);
+			break;
+		case Attribute::Color:
+			parseColor(objectGroup.color, value);
+			break;
+		case Attribute::X:
+			objectGroup.x = toInt(value);
+			break;
+		case Attribute::Y:
+			objectGroup.y = toInt(value);
+			break;
+		case Attribute::Width:
+			objectGroup.width = toInt(value);
+			break;
+		case Attribute::Height:
+			objectGroup.height = toInt(value);
+			break;
+		case Attribute::Opacity:
+			objectGroup.opacity = toFloat(value);
+			break;
+		case Attribute::Visible:
+			objectGroup.visible = toBool(value);
+			break;
+		case Attribute::TintColor:
+			parseColor(objectGroup.tintColor, value);
+			break;
+		case Attribute::OffsetX:
+			objectGroup.offsetX = toFloat(value);
+			break;
+		case Attribute::OffsetY:
+			objectGroup.offsetY = toFloat(value);
+			break;
+		case Attribute::DrawOrder:
+			if (startsWith(value, "index"))
+				objectGroup.drawOrder = MapModel::DrawOrder::Index;
+			else if (startsWith(value, "topdown"))
+				objectGroup.drawOrder = MapModel::DrawOrder::TopDown;
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyObject(MapModel::Object &object, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Id:
+			object.id = toInt(value);
+			break;
+		case Attribute::Name:
+			object.name = strings.intern(value);
+			object.overrides |= MapModel::ObjectOverride::Name;
+			break;
+		case Attribute::Type:
+			object.type = strings.intern(value);
+			object.overrides |= MapModel::ObjectOverride::Type;
+			break;
+		case Attribute::X:
+			object.x = toFloat(value);
+			break;
+		case Attribute::Y:
+			object.y = toFloat(value);
+			break;
+		case Attribute::Width:
+			object.width = toFloat(value);
+			object.overrides |= MapModel::ObjectOverride::Width;
+			break;
+		case Attribute::Height:
+			object.height = toFloat(value);
+			object.overrides |= MapModel::ObjectOverride::Height;
+			break;
+		case Attribute::Rotation:
+			object.rotation = toFloat(value);
+			object.overrides |= MapModel::ObjectOverride::Rotation;
+			break;
+		case Attribute::Gid:
+			object.gid = toUint(value); // unsigned to make flipping work
+			object.objectType = MapModel::ObjectType::Tile;
+			object.overrides |= MapModel::ObjectOverride::Gid;
+			break;
+		case Attribute::Visible:
+			object.visible = toBool(value);
+			object.overrides |= MapModel::ObjectOverride::Visible;
+			break;
+		case Attribute::Template:
+			object.templateFile = strings.intern(value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyText(MapModel::Text &text, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::FontFamily:
+			text.fontFamily = strings.intern(value);
+			break;
+		case Attribute::PixelSize:
+			text.pixelSize = toInt(value);
+			break;
+		case Attribute::Wrap:
+			text.wrap = toBool(value);
+			break;
+		case Attribute::Color:
+			parseColor(text.color, value);
+			break;
+		case Attribute::Bold:
+			text.bold = toBool(value);
+			break;
+		case Attribute::Italic:
+			text.italic = toBool(value);
+			break;
+		case Attribute::Underline:
+			text.underline = toBool(value);
+			break;
+		case Attribute::Strikeout:
+			text.strikeout = toBool(value);
+			break;
+		case Attribute::Kerning:
+			text.kerning = toBool(value);
+			break;
+		case Attribute::HAlign:
+			if (startsWith(value, "left"))
+				text.hAlign = MapModel::HorizontalAlign::Left;
+			else if (startsWith(value, "center"))
+				text.hAlign = MapModel::HorizontalAlign::Center;
+			else if (startsWith(value, "right"))
+				text.hAlign = MapModel::HorizontalAlign::Right;
+			else if (startsWith(value, "justify"))
+				text.hAlign = MapModel::HorizontalAlign::Justify;
+			break;
+		case Attribute::VAlign:
+			if (startsWith(value, "top"))
+				text.vAlign = MapModel::VerticalAlign::Top;
+			else if (startsWith(value, "center"))
+				text.vAlign = MapModel::VerticalAlign::Center;
+			else if (startsWith(value, "bottom"))
+				text.vAlign = MapModel::VerticalAlign::Bottom;
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyImageLayer(MapModel::ImageLayer &imageLayer, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Id:
+			imageLayer.id = toInt(value);
+			break;
+		case Attribute::Name:
+			imageLayer.name = strings.intern(value);
+			break;
+		case Attribute::OffsetX:
+			imageLayer.offsetX = toFloat(value);
+			break;
+		case Attribute::OffsetY:
+			imageLayer.offsetY = toFloat(value);
+			break;
+		case Attribute::X:
+			imageLayer.x = toInt(value);
+			break;
+		case Attribute::Y:
+			imageLayer.y = toInt(value);
+			break;
+		case Attribute::Opacity:
+			imageLayer.opacity = toFloat(value);
+			break;
+		case Attribute::Visible:
+			imageLayer.visible = toBool(value);
+			break;
+		case Attribute::TintColor:
+			parseColor(imageLayer.tintColor, value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyGroup(MapModel::Group &group, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Id:
+			group.id = toInt(value);
+			break;
+		case Attribute::Name:
+			group.name = strings.intern(value);
+			break;
+		case Attribute::OffsetX:
+			group.offsetX = toFloat(value);
+			break;
+		case Attribute::OffsetY:
+			group.offsetY = toFloat(value);
+			break;
+		case Attribute::Opacity:
+			group.opacity = toFloat(value);
+			break;
+		case Attribute::Visible:
+			group.visible = toBool(value);
+			break;
+		case Attribute::TintColor:
+			parseColor(group.tintColor, value);
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool TmxAttributes::applyProperty(MapModel::Property &property, StringTable &strings, const char *name, const char *value)
+{
+	switch (lookup(name))
+	{
+		case Attribute::Name:
+			property.name = strings.intern(value);
+			break;
+		case Attribute::Type:
+			if (startsWith(value, "string"))
+				property.type = MapModel::PropertyType::StringType;
+			else if (startsWith(value, "int"))
+				property.type = MapModel::PropertyType::IntType;
+			else if (startsWith(value, "float"))
+				property.type = MapModel::PropertyType::FloatType;
+			else if (startsWith(value, "bool"))
+				property.type = MapModel::PropertyType::BoolType;
+			else if (startsWith(value, "color"))
+				property.type = MapModel::PropertyType::ColorType;
+			else if (startsWith(value, "file"))
+				property.type = MapModel::PropertyType::FileType;
+			else if (startsWith(value, "object"))
+				property.type = MapModel::PropertyType::ObjectType;
+			break;
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+void TmxAttributes::applyPropertyValue(MapModel::Property &property, StringTable &strings, const char *value)
+{
+	switch (property.type)
+	{
+		case MapModel::PropertyType::StringType:
+			property.value.string = strings.intern(value);
+			break;
+		case MapModel::PropertyType::IntType:
+			property.value.intValue = toInt(value);
+			break;
+		case MapModel::PropertyType::FloatType:
+			property.value.floatValue = toFloat(value);
+			break;
+		case MapModel::PropertyType::BoolType:
+			property.value.boolValue = toBool(value);
+			break;
+		case MapModel::PropertyType::ColorType:
+			property.value.color = parseIntColor(value);
+			break;
+		case MapModel::PropertyType::FileType:
+			property.value.string = strings.intern(value);
+			break;
+		case MapModel::PropertyType::ObjectType:
+			property.value.object = toInt(value);
+			break;
+	}
+}
+
+bool TmxAttributes::parsePolyPoints(const char *string, nctl::Array<nc::Vector2f> &points)
+{
+	// Points are parsed in a single pass, the array grows as needed and is shrunk at the end
+	const char *buffer = skipSpaces(string);
+	while (*buffer != '\0')
+	{
+		float x = 0.0f;
+		const char *end = NumberParser::parseFloat(buffer, x);
+		if (end == buffer || *end != ',')
+		{
+			LOGE_X("Parsing list of points failed at byte %u", static_cast<unsigned int>(end - string));
+			return false;
+		}
+
+		buffer = end + 1;
+		float y = 0.0f;
+		end = NumberParser::parseFloat(buffer, y);
+		if (end == buffer || (*end != '\0' && isSpace(*end) == false))
+		{
+			LOGE_X("Parsing list of points failed at byte %u", static_cast<unsigned int>(end - string));
+			return false;
+		}
+
+		points.emplaceBack(x, y);
+		buffer = skipSpaces(end);
+	}
+
+	if (points.isEmpty())
+	{
+		LOGE_X("There are no elements in the list of points");
+		return false;
+	}
+	points.shrinkToFit();
+
+	return true;
+}
+
+int TmxAttributes::toInt(const char *value)
+{
+	bool isNegative = false;
+	int base = 10;
+	const char *digits = skipIntPrefix(value, isNegative, base);
+
+	unsigned int magnitude = 0;
+	NumberParser::parseUint(digits, magnitude, base);
+	if (isNegative)
+		return (magnitude > static_cast<unsigned int>(INT_MAX)) ? INT_MIN : -static_cast<int>(magnitude);
+	return (magnitude > static_cast<unsigned int>(INT_MAX)) ? INT_MAX : static_cast<int>(magnitude);
+}
+
+unsigned int TmxAttributes::toUint(const char *value)
+{
+	bool isNegative = false;
+	int base = 10;
+	const char *digits = skipIntPrefix(value, isNegative, base);
+	if (isNegative)
+		return 0;
+
+	unsigned int number = 0;
+	NumberParser::parseUint(digits, number, base);
+	return number;
+}
+
+float TmxAttributes::toFloat(const char *value)
+{
+	float number = 0.0f;
+	NumberParser::parseFloat(skipSpaces(value), number);
+	return number;
+}
+
+bool TmxAttributes::toBool(const char *value)
+{
+	const char first = value[0];
+	return (first == '1' || first == 't' || first == 'T' || first == 'y' || first == 'Y');
+}
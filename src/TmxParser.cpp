@@ -1,719 +1,311 @@
-#include <cstring> // for `strncmp()`
-#include <cstdio> // for `sscanf()`
+#include <cstring> // for `strcmp()`
 #include "pugixml.hpp"
 #include <nctl/CString.h>
-#include <ncine/IFile.h>
 #include <ncine/FileSystem.h>
 
 #include "TmxParser.h"
+#include "TmxStreamParser.h"
 #include "MapModel.h"
+#include "TmxAttributes.h"
+#include "LayerDecoder.h"
+#include "TileSetCache.h"
+#include "TemplateCache.h"
+#include "MappedFile.h"
 
 namespace {
 
-bool loadFile(const char *filename, nctl::UniquePtr<unsigned char[]> &fileBuffer, long int &fileSize)
+/// The file is parsed in place, it should stay open as long as the document is used
+bool loadXmlFile(const char *filename, pugi::xml_document &document, MappedFile &xmlFile)
 {
-	nctl::UniquePtr<nc::IFile> file = nc::IFile::createFileHandle(filename);
-	file->open(nc::IFile::OpenMode::READ);
-	if (file->isOpened() == false)
-	{
-		LOGE_X("Cannot open file: %s", filename);
-		return false;
-	}
-
-	fileSize = file->size();
-	fileBuffer = nctl::makeUnique<unsigned char[]>(fileSize);
-	file->read(fileBuffer.get(), fileSize);
-	file->close();
-	return true;
-}
-
-bool loadXmlFile(const char *filename, pugi::xml_document &document)
-{
-	long int xmlFileSize = 0;
-	nctl::UniquePtr<unsigned char[]> xmlFileBuffer;
-	const bool hasLoaded = loadFile(filename, xmlFileBuffer, xmlFileSize);
+	const bool hasLoaded = xmlFile.open(filename);
 	if (hasLoaded == false)
 		return false;
 
-	pugi::xml_parse_result result = document.load_buffer_inplace(xmlFileBuffer.get(), xmlFileSize);
+	pugi::xml_parse_result result = document.load_buffer_inplace(xmlFile.data(), xmlFile.size());
 
 	if (result == false)
 	{
 		LOGE_X("Error description: %s", result.description());
-		LOGE_X("Error offset: %s (error at [...%ul])", result.offset, xmlFileBuffer.get() + result.offset);
+		LOGE_X("Error offset: %s (error at [...%ul])", result.offset, xmlFile.data() + result.offset);
 		return false;
 	}
 
 	return true;
 }
 
-unsigned int parseIntColor(pugi::xml_attribute colorAttr)
+template <class T>
+void applyAttributes(T &model, pugi::xml_node node, bool (*applyFunction)(T &, const char *, const char *))
 {
-	unsigned int hexColor = 0;
-	if (colorAttr.empty() == false)
-	{
-		// In the #AARRGGBB or #RRGGBB forms
-		const char *value = colorAttr.value();
-		if (value[0] == '#')
-			sscanf(value, "#%8x", &hexColor);
-	}
-	return hexColor;
+	for (pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute())
+		applyFunction(model, attr.name(), attr.value());
+}
+
+template <class T>
+void applyAttributes(T &model, StringTable &strings, pugi::xml_node node, bool (*applyFunction)(T &, StringTable &, const char *, const char *))
+{
+	for (pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute())
+		applyFunction(model, strings, attr.name(), attr.value());
 }
 
-bool parseColor(nc::Color &color, pugi::xml_attribute colorAttr)
+/// Collects the sibling nodes with the same name in a single traversal of the document
+/*! The model arrays can then be allocated with their exact capacity without walking the siblings twice.
+ *  Short lists of nodes are stored on the stack, longer ones are moved to the heap. */
+class SiblingNodes
 {
-	if (colorAttr.empty() == false)
+  public:
+	SiblingNodes(pugi::xml_node firstNode, const char *name)
+	    : size_(0)
 	{
-		// In the #AARRGGBB or #RRGGBB forms
-		const char *value = colorAttr.value();
-		if (value[0] == '#')
+		for (pugi::xml_node node = firstNode; node; node = node.next_sibling(name))
 		{
-			unsigned int hexColor = 0;
-			sscanf(value, "#%8x", &hexColor);
-			color.set(hexColor);
+			if (size_ < LocalCapacity)
+				localNodes_[size_] = node;
+			else
+			{
+				if (size_ == LocalCapacity)
+				{
+					heapNodes_.setCapacity(LocalCapacity * 2);
+					for (unsigned int i = 0; i < LocalCapacity; i++)
+						heapNodes_.pushBack(localNodes_[i]);
+				}
+				heapNodes_.pushBack(node);
+			}
+			size_++;
 		}
-		return true;
 	}
-	return false;
-}
 
-bool parseProperties(nctl::Array<MapModel::Property> &properties, pugi::xml_node propertiesNode)
+	inline unsigned int size() const { return size_; }
+	inline pugi::xml_node operator[](unsigned int index) const { return (size_ <= LocalCapacity) ? localNodes_[index] : heapNodes_[index]; }
+
+  private:
+	static const unsigned int LocalCapacity = 32;
+
+	unsigned int size_;
+	pugi::xml_node localNodes_[LocalCapacity];
+	nctl::Array<pugi::xml_node> heapNodes_;
+};
+
+bool parseProperties(nctl::Array<MapModel::Property> &properties, StringTable &strings, pugi::xml_node propertiesNode)
 {
 	if (propertiesNode.empty())
 		return false;
 
 	pugi::xml_node firstPropertyNode = propertiesNode.child("property");
 
-	unsigned int numProperties = 0;
-	for (pugi::xml_node propertyNode = firstPropertyNode; propertyNode; propertyNode = propertyNode.next_sibling("property"))
-		numProperties++;
-	if (numProperties == 0)
+	const SiblingNodes propertyNodes(firstPropertyNode, "property");
+	if (propertyNodes.size() == 0)
 		return false;
-	properties.setCapacity(numProperties);
+	properties.setCapacity(propertyNodes.size());
 
-	for (pugi::xml_node propertyNode = firstPropertyNode; propertyNode; propertyNode = propertyNode.next_sibling("property"))
+	for (unsigned int i = 0; i < propertyNodes.size(); i++)
 	{
+		pugi::xml_node propertyNode = propertyNodes[i];
 		properties.emplaceBack();
 		MapModel::Property &property = properties.back();
 
-		pugi::xml_attribute nameAttr = propertyNode.attribute("name");
-		if (nameAttr.empty() == false)
-			nctl::strncpy(property.name, nameAttr.value(), MapModel::MaxNameLength - 1);
-
-		pugi::xml_attribute typeAttr = propertyNode.attribute("type");
-		if (typeAttr.empty() == false)
-		{
-			const char *value = typeAttr.value();
-			if (strncmp(value, "string", strlen("string")) == 0)
-				property.type = MapModel::PropertyType::StringType;
-			else if (strncmp(value, "int", strlen("int")) == 0)
-				property.type = MapModel::PropertyType::IntType;
-			else if (strncmp(value, "float", strlen("float")) == 0)
-				property.type = MapModel::PropertyType::FloatType;
-			else if (strncmp(value, "bool", strlen("bool")) == 0)
-				property.type = MapModel::PropertyType::BoolType;
-			else if (strncmp(value, "color", strlen("color")) == 0)
-				property.type = MapModel::PropertyType::ColorType;
-			else if (strncmp(value, "file", strlen("file")) == 0)
-				property.type = MapModel::PropertyType::FileType;
-			else if (strncmp(value, "object", strlen("object")) == 0)
-				property.type = MapModel::PropertyType::ObjectType;
-		}
+		applyAttributes(property, strings, propertyNode, TmxAttributes::applyProperty);
 
+		// The value is applied last as it depends on the type
 		pugi::xml_attribute valueAttr = propertyNode.attribute("value");
 		if (valueAttr.empty() == false)
-		{
-			switch (property.type)
-			{
-				case MapModel::PropertyType::StringType:
-					nctl::strncpy(property.string, valueAttr.value(), MapModel::Property::MaxStringLength - 1);
-					break;
-				case MapModel::PropertyType::IntType:
-					property.value.intValue = valueAttr.as_int();
-					break;
-				case MapModel::PropertyType::FloatType:
-					property.value.floatValue = valueAttr.as_float();
-					break;
-				case MapModel::PropertyType::BoolType:
-					property.value.boolValue = valueAttr.as_bool();
-					break;
-				case MapModel::PropertyType::ColorType:
-					property.value.color = parseIntColor(valueAttr);
-					break;
-				case MapModel::PropertyType::FileType:
-					nctl::strncpy(property.string, valueAttr.value(), MapModel::Property::MaxStringLength - 1);
-					break;
-				case MapModel::PropertyType::ObjectType:
-					property.value.object = valueAttr.as_int();
-					break;
-			}
-		}
+			TmxAttributes::applyPropertyValue(property, strings, valueAttr.value());
 	}
 
 	return true;
 }
 
-bool parseTextObject(MapModel::Text &text, pugi::xml_node textNode)
+bool parseTextObject(MapModel::Text &text, StringTable &strings, pugi::xml_node textNode)
 {
 	text.data[0] = '\0';
 	nctl::strncpy(text.data, textNode.child_value(), MapModel::Text::MaxDataLength - 1);
 
-	pugi::xml_attribute fontFamilyAttr = textNode.attribute("fontfamily");
-	if (fontFamilyAttr.empty() == false)
-		nctl::strncpy(text.fontFamily, fontFamilyAttr.value(), MapModel::MaxNameLength - 1);
-
-	pugi::xml_attribute pixelSizeAttr = textNode.attribute("pixelsize");
-	if (pixelSizeAttr.empty() == false)
-		text.pixelSize = pixelSizeAttr.as_int();
-
-	pugi::xml_attribute wrapAttr = textNode.attribute("wrap");
-	if (wrapAttr.empty() == false)
-		text.wrap = wrapAttr.as_bool();
-
-	parseColor(text.color, textNode.attribute("color"));
+	applyAttributes(text, strings, textNode, TmxAttributes::applyText);
 
-	pugi::xml_attribute boldAttr = textNode.attribute("bold");
-	if (boldAttr.empty() == false)
-		text.bold = boldAttr.as_bool();
-
-	pugi::xml_attribute italicAttr = textNode.attribute("italic");
-	if (italicAttr.empty() == false)
-		text.italic = italicAttr.as_bool();
+	return true;
+}
 
-	pugi::xml_attribute underlineAttr = textNode.attribute("underline");
-	if (underlineAttr.empty() == false)
-		text.underline = underlineAttr.as_bool();
+bool parseObjectNode(MapModel::Object &object, StringTable &strings, pugi::xml_node objectNode)
+{
+	if (objectNode.empty())
+		return false;
 
-	pugi::xml_attribute strikeoutAttr = textNode.attribute("strikeout");
-	if (strikeoutAttr.empty() == false)
-		text.strikeout = strikeoutAttr.as_bool();
+	// Objects without a `gid` attribute are rectangles unless they have a shape element
+	object.objectType = MapModel::ObjectType::Rectangle;
+	applyAttributes(object, strings, objectNode, TmxAttributes::applyObject);
 
-	pugi::xml_attribute kerningAttr = textNode.attribute("kerning");
-	if (kerningAttr.empty() == false)
-		text.kerning = kerningAttr.as_bool();
+	pugi::xml_node ellipseNode = objectNode.child("ellipse");
+	if (ellipseNode.empty() == false)
+		object.objectType = MapModel::ObjectType::Ellipse;
 
-	pugi::xml_attribute hAlignAttr = textNode.attribute("halign");
-	if (hAlignAttr.empty() == false)
-	{
-		const char *value = hAlignAttr.value();
-		if (strncmp(value, "left", strlen("left")) == 0)
-			text.hAlign = MapModel::HorizontalAlign::Left;
-		else if (strncmp(value, "center", strlen("center")) == 0)
-			text.hAlign = MapModel::HorizontalAlign::Center;
-		else if (strncmp(value, "right", strlen("right")) == 0)
-			text.hAlign = MapModel::HorizontalAlign::Right;
-		else if (strncmp(value, "justify", strlen("justify")) == 0)
-			text.hAlign = MapModel::HorizontalAlign::Justify;
-	}
+	pugi::xml_node pointNode = objectNode.child("point");
+	if (pointNode.empty() == false)
+		object.objectType = MapModel::ObjectType::Point;
 
-	pugi::xml_attribute vAlignAttr = textNode.attribute("valign");
-	if (vAlignAttr.empty() == false)
+	pugi::xml_node polygonNode = objectNode.child("polygon");
+	if (polygonNode.empty() == false)
 	{
-		const char *value = vAlignAttr.value();
-		if (strncmp(value, "top", strlen("top")) == 0)
-			text.vAlign = MapModel::VerticalAlign::Top;
-		else if (strncmp(value, "center", strlen("center")) == 0)
-			text.vAlign = MapModel::VerticalAlign::Center;
-		else if (strncmp(value, "bottom", strlen("bottom")) == 0)
-			text.vAlign = MapModel::VerticalAlign::Bottom;
+		object.objectType = MapModel::ObjectType::Polygon;
+		pugi::xml_attribute pointsAttr = polygonNode.attribute("points");
+		TmxAttributes::parsePolyPoints(pointsAttr.value(), object.points);
 	}
 
-	return true;
-}
-
-bool parsePolyPoints(const char *string, nctl::Array<nc::Vector2i> &points)
-{
-	// Count elements
-	const char *buffer = string;
-	unsigned int numElements = 0;
-	while (*buffer != '\0')
+	pugi::xml_node polylineNode = objectNode.child("polyline");
+	if (polylineNode.empty() == false)
 	{
-		while (*buffer != ',' && *buffer != '\0')
-			buffer++;
-		if (*buffer == ',')
-		{
-			numElements++;
-			buffer++;
-		}
+		object.objectType = MapModel::ObjectType::Polyline;
+		pugi::xml_attribute pointsAttr = polylineNode.attribute("points");
+		TmxAttributes::parsePolyPoints(pointsAttr.value(), object.points);
 	}
 
-	if (numElements > 0)
-		LOGI_X("There are %u elements in the list of points", numElements);
-	else
+	pugi::xml_node textNode = objectNode.child("text");
+	if (textNode.empty() == false)
 	{
-		LOGE_X("There are no elements in the list of points");
-		return false;
+		object.objectType = MapModel::ObjectType::Text;
+		parseTextObject(object.text, strings, textNode);
 	}
 
-	points.setCapacity(numElements);
-
-	// Parse elements
-	buffer = string;
-	while (*buffer != '\0')
-	{
-		const char *begin = buffer;
-		while (*begin == ' ' || *begin == '\t' || *begin == '\n')
-			begin++;
-		const char *comma = begin;
-		while (*comma != ' ' && *comma != '\t' && *comma != '\n' && *comma != '\0' && *comma != ',')
-			comma++;
-		const char *end = comma + 1;
-		while (*end != ' ' && *end != '\t' && *end != '\n' && *end != '\0' && *end != ',')
-			end++;
-
-		int x = 0;
-		const int xMatched = sscanf(begin, "%d", &x);
-		if (xMatched != 1)
-		{
-			LOGE_X("Parsing list of points failed at byte %u", begin - string);
-			return false;
-		}
-		int y = 0;
-		const int yMatched = sscanf(comma + 1, "%d", &y);
-		if (yMatched != 1)
-		{
-			LOGE_X("Parsing list of points failed at byte %u", comma + 1 - string);
-			return false;
-		}
-
-		points.emplaceBack(x, y);
-		buffer = end;
-	}
+	parseProperties(object.properties, strings, objectNode.child("properties"));
 
 	return true;
 }
 
-bool parseObjectNodes(MapModel::ObjectGroup &objectGroup, pugi::xml_node firstObjectNode)
+bool parseObjectNodes(MapModel::ObjectGroup &objectGroup, StringTable &strings, pugi::xml_node firstObjectNode)
 {
-	unsigned int numObjects = 0;
-	for (pugi::xml_node objectNode = firstObjectNode; objectNode; objectNode = objectNode.next_sibling("object"))
-		numObjects++;
-	if (numObjects == 0)
+	const SiblingNodes objectNodes(firstObjectNode, "object");
+	if (objectNodes.size() == 0)
 		return false;
-	objectGroup.objects.setCapacity(numObjects);
+	objectGroup.objects.setCapacity(objectNodes.size());
 
-	for (pugi::xml_node objectNode = firstObjectNode; objectNode; objectNode = objectNode.next_sibling("object"))
+	for (unsigned int i = 0; i < objectNodes.size(); i++)
 	{
-		objectGroup.objects.emplaceBack();
-		MapModel::Object &object = objectGroup.objects.back();
-
-		pugi::xml_attribute idAttr = objectNode.attribute("id");
-		if (idAttr.empty() == false)
-			object.id = idAttr.as_int();
-
-		pugi::xml_attribute nameAttr = objectNode.attribute("name");
-		if (nameAttr.empty() == false)
-			nctl::strncpy(object.name, nameAttr.value(), MapModel::MaxNameLength - 1);
-
-		pugi::xml_attribute typeAttr = objectNode.attribute("type");
-		if (typeAttr.empty() == false)
-			nctl::strncpy(object.type, typeAttr.value(), MapModel::Object::MaxTypeLength - 1);
-
-		pugi::xml_attribute xAttr = objectNode.attribute("x");
-		if (xAttr.empty() == false)
-			object.x = xAttr.as_float();
-
-		pugi::xml_attribute yAttr = objectNode.attribute("y");
-		if (yAttr.empty() == false)
-			object.y = yAttr.as_float();
-
-		pugi::xml_attribute widthAttr = objectNode.attribute("width");
-		if (widthAttr.empty() == false)
-			object.width = widthAttr.as_float();
-
-		pugi::xml_attribute heightAttr = objectNode.attribute("height");
-		if (heightAttr.empty() == false)
-			object.height = heightAttr.as_float();
-
-		pugi::xml_attribute rotationAttr = objectNode.attribute("rotation");
-		if (rotationAttr.empty() == false)
-			object.rotation = rotationAttr.as_float();
-
-		pugi::xml_attribute gidAttr = objectNode.attribute("gid");
-		if (gidAttr.empty() == false)
-		{
-			object.gid = gidAttr.as_uint(); // unsigned to make flipping work
-			object.objectType = MapModel::ObjectType::Tile;
-		}
-		else
-			object.objectType = MapModel::ObjectType::Rectangle;
-
-		pugi::xml_attribute visibleAttr = objectNode.attribute("visible");
-		if (visibleAttr.empty() == false)
-			object.visible = visibleAttr.as_bool();
-
-		pugi::xml_attribute templateAttr = objectNode.attribute("template");
-		object.templateFile[0] = '\0';
-		if (templateAttr.empty() == false)
-			nctl::strncpy(object.templateFile, templateAttr.value(), MapModel::MaxSourceLength - 1);
-
-		pugi::xml_node ellipseNode = objectNode.child("ellipse");
-		if (ellipseNode.empty() == false)
-			object.objectType = MapModel::ObjectType::Ellipse;
-
-		pugi::xml_node pointNode = objectNode.child("point");
-		if (pointNode.empty() == false)
-			object.objectType = MapModel::ObjectType::Point;
-
-		pugi::xml_node polygonNode = objectNode.child("polygon");
-		if (polygonNode.empty() == false)
-		{
-			object.objectType = MapModel::ObjectType::Polygon;
-			pugi::xml_attribute pointsAttr = polygonNode.attribute("points");
-			parsePolyPoints(pointsAttr.value(), object.points);
-		}
-
-		pugi::xml_node polylineNode = objectNode.child("polyline");
-		if (polylineNode.empty() == false)
-		{
-			object.objectType = MapModel::ObjectType::Polyline;
-			pugi::xml_attribute pointsAttr = polylineNode.attribute("points");
-			parsePolyPoints(pointsAttr.value(), object.points);
-		}
-
-		pugi::xml_node textNode = objectNode.child("text");
-		if (textNode.empty() == false)
-		{
-			object.objectType = MapModel::ObjectType::Text;
-			parseTextObject(object.text, textNode);
-		}
-
-		parseProperties(object.properties, objectNode.child("properties"));
+		MapModel::Object object;
+		parseObjectNode(object, strings, objectNodes[i]);
+		objectGroup.objects.append(object);
 	}
+	objectGroup.objects.shrinkToFit();
 
 	return true;
 }
 
-bool parseObjectGroupNodes(nctl::Array<MapModel::ObjectGroup> &objectGroups, pugi::xml_node firstObjectGroupNode)
+bool parseObjectGroupNode(MapModel::ObjectGroup &objectGroup, StringTable &strings, pugi::xml_node objectGroupNode)
 {
-	unsigned int numObjectGroups = 0;
-	for (pugi::xml_node objectGroupNode = firstObjectGroupNode; objectGroupNode; objectGroupNode = objectGroupNode.next_sibling("objectgroup"))
-		numObjectGroups++;
-	if (numObjectGroups == 0)
-		return false;
-	objectGroups.setCapacity(numObjectGroups);
-
-	for (pugi::xml_node objectGroupNode = firstObjectGroupNode; objectGroupNode; objectGroupNode = objectGroupNode.next_sibling("objectgroup"))
-	{
-		objectGroups.emplaceBack();
-		MapModel::ObjectGroup &objectGroup = objectGroups.back();
-
-		pugi::xml_attribute idAttr = objectGroupNode.attribute("id");
-		if (idAttr.empty() == false)
-			objectGroup.id = idAttr.as_int();
-
-		pugi::xml_attribute nameAttr = objectGroupNode.attribute("name");
-		if (nameAttr.empty() == false)
-			nctl::strncpy(objectGroup.name, nameAttr.value(), MapModel::MaxNameLength - 1);
+	applyAttributes(objectGroup, strings, objectGroupNode, TmxAttributes::applyObjectGroup);
 
-		parseColor(objectGroup.color, objectGroupNode.attribute("color"));
+	pugi::xml_node firstObjectNode = objectGroupNode.child("object");
+	if (firstObjectNode.empty() == false)
+		parseObjectNodes(objectGroup, strings, firstObjectNode);
 
-		pugi::xml_attribute xAttr = objectGroupNode.attribute("x");
-		if (xAttr.empty() == false)
-			objectGroup.x = xAttr.as_int();
-
-		pugi::xml_attribute yAttr = objectGroupNode.attribute("y");
-		if (yAttr.empty() == false)
-			objectGroup.y = yAttr.as_int();
-
-		pugi::xml_attribute widthAttr = objectGroupNode.attribute("width");
-		if (widthAttr.empty() == false)
-			objectGroup.width = widthAttr.as_int();
-
-		pugi::xml_attribute heightAttr = objectGroupNode.attribute("height");
-		if (heightAttr.empty() == false)
-			objectGroup.height = heightAttr.as_int();
-
-		pugi::xml_attribute opacityAttr = objectGroupNode.attribute("opacity");
-		if (opacityAttr.empty() == false)
-			objectGroup.opacity = opacityAttr.as_float();
-
-		pugi::xml_attribute visibleAttr = objectGroupNode.attribute("visible");
-		if (visibleAttr.empty() == false)
-			objectGroup.visible = visibleAttr.as_bool();
-
-		parseColor(objectGroup.tintColor, objectGroupNode.attribute("tintcolor"));
-
-		pugi::xml_attribute offsetXAttr = objectGroupNode.attribute("offsetx");
-		if (offsetXAttr.empty() == false)
-			objectGroup.offsetX = offsetXAttr.as_float();
-
-		pugi::xml_attribute offsetYAttr = objectGroupNode.attribute("offsety");
-		if (offsetYAttr.empty() == false)
-			objectGroup.offsetY = offsetYAttr.as_float();
-
-		pugi::xml_attribute drawOrderAttr = objectGroupNode.attribute("draworder");
-		if (drawOrderAttr.empty() == false)
-		{
-			const char *value = drawOrderAttr.value();
-			if (strncmp(value, "index", strlen("index")) == 0)
-				objectGroup.drawOrder = MapModel::DrawOrder::Index;
-			else if (strncmp(value, "topdown", strlen("topdown")) == 0)
-				objectGroup.drawOrder = MapModel::DrawOrder::TopDown;
-		}
-
-		pugi::xml_node firstObjectNode = objectGroupNode.child("object");
-		if (firstObjectNode.empty() == false)
-			parseObjectNodes(objectGroup, firstObjectNode);
-
-		parseProperties(objectGroup.properties, objectGroupNode.child("properties"));
-	}
+	parseProperties(objectGroup.properties, strings, objectGroupNode.child("properties"));
 
 	return true;
 }
 
-bool parseImageNode(MapModel::Image &image, pugi::xml_node imageNode)
+bool parseImageNode(MapModel::Image &image, StringTable &strings, pugi::xml_node imageNode)
 {
 	if (imageNode.empty())
 		return false;
 
-	pugi::xml_attribute formatAttr = imageNode.attribute("format");
-	if (formatAttr.empty() == false)
-		nctl::strncpy(image.format, formatAttr.value(), MapModel::Image::MaxFormatLength - 1);
-
-	pugi::xml_attribute sourceAttr = imageNode.attribute("source");
-	if (sourceAttr.empty() == false)
-		nctl::strncpy(image.source, sourceAttr.value(), MapModel::MaxSourceLength - 1);
-
-	// Can't use the `parseColor` function in this case
-	pugi::xml_attribute transAttr = imageNode.attribute("trans");
-	if (transAttr.empty() == false)
-	{
-		// In the #RRGGBB or RRGGBB forms
-		const char *value = transAttr.value();
-		unsigned int hexColor = 0;
-		if (value[0] == '#')
-			sscanf(value, "#%6x", &hexColor);
-		else
-			sscanf(value, "%6x", &hexColor);
-		image.trans.set(hexColor);
-		image.hasTransparency = true;
-	}
-
-	pugi::xml_attribute widthAttr = imageNode.attribute("width");
-	if (widthAttr.empty() == false)
-		image.width = widthAttr.as_int();
-
-	pugi::xml_attribute heightAttr = imageNode.attribute("height");
-	if (heightAttr.empty() == false)
-		image.height = heightAttr.as_int();
+	applyAttributes(image, strings, imageNode, TmxAttributes::applyImage);
 
 	return true;
 }
 
-bool parseImageLayerNodes(nctl::Array<MapModel::ImageLayer> &imageLayers, pugi::xml_node firstImageLayerNode)
+bool parseImageLayerNode(MapModel::ImageLayer &imageLayer, StringTable &strings, pugi::xml_node imageLayerNode)
 {
-	unsigned int numImageLayers = 0;
-	for (pugi::xml_node imageLayerNode = firstImageLayerNode; imageLayerNode; imageLayerNode = imageLayerNode.next_sibling("imagelayer"))
-		numImageLayers++;
-	if (numImageLayers == 0)
-		return false;
-	imageLayers.setCapacity(numImageLayers);
-
-	for (pugi::xml_node imageLayerNode = firstImageLayerNode; imageLayerNode; imageLayerNode = imageLayerNode.next_sibling("imagelayer"))
-	{
-		imageLayers.emplaceBack();
-		MapModel::ImageLayer &imageLayer = imageLayers.back();
-
-		pugi::xml_attribute idAttr = imageLayerNode.attribute("id");
-		if (idAttr.empty() == false)
-			imageLayer.id = idAttr.as_int();
-
-		pugi::xml_attribute nameAttr = imageLayerNode.attribute("name");
-		if (nameAttr.empty() == false)
-			nctl::strncpy(imageLayer.name, nameAttr.value(), MapModel::MaxNameLength - 1);
-
-		pugi::xml_attribute offsetXAttr = imageLayerNode.attribute("offsetx");
-		if (offsetXAttr.empty() == false)
-			imageLayer.offsetX = offsetXAttr.as_float();
-
-		pugi::xml_attribute offsetYAttr = imageLayerNode.attribute("offsety");
-		if (offsetYAttr.empty() == false)
-			imageLayer.offsetY = offsetYAttr.as_float();
-
-		pugi::xml_attribute xAttr = imageLayerNode.attribute("x");
-		if (xAttr.empty() == false)
-			imageLayer.x = xAttr.as_int();
-
-		pugi::xml_attribute yAttr = imageLayerNode.attribute("y");
-		if (yAttr.empty() == false)
-			imageLayer.y = yAttr.as_int();
-
-		pugi::xml_attribute opacityAttr = imageLayerNode.attribute("opacity");
-		if (opacityAttr.empty() == false)
-			imageLayer.opacity = opacityAttr.as_float();
-
-		pugi::xml_attribute visibleAttr = imageLayerNode.attribute("visible");
-		if (visibleAttr.empty() == false)
-			imageLayer.visible = visibleAttr.as_bool();
-
-		parseColor(imageLayer.tintColor, imageLayerNode.attribute("tintcolor"));
+	applyAttributes(imageLayer, strings, imageLayerNode, TmxAttributes::applyImageLayer);
 
-		parseImageNode(imageLayer.image, imageLayerNode.child("image"));
-		parseProperties(imageLayer.properties, imageLayerNode.child("properties"));
-	}
+	parseImageNode(imageLayer.image, strings, imageLayerNode.child("image"));
+	parseProperties(imageLayer.properties, strings, imageLayerNode.child("properties"));
 
 	return true;
 }
 
-bool parseCSVLayerData(const char *string, nctl::Array<unsigned int> &array)
+bool parseChunkNodes(MapModel::Layer &layer, unsigned int layerIndex, pugi::xml_node firstChunkNode, LayerDecoder &layerDecoder)
 {
-	// Count elements
-	const char *buffer = string;
-	unsigned int numElements = 0;
-	while (*buffer != '\0')
-	{
-		while (*buffer != ',' && *buffer != '\0')
-			buffer++;
-		if (*buffer == ',')
-		{
-			numElements++;
-			buffer++;
-		}
-	}
-
-	if (numElements > 0)
-		LOGI_X("There are %u elements in the CSV layer data", numElements);
-	else
-	{
-		LOGE_X("There are no elements in the CSV layer data");
+	const SiblingNodes chunkNodes(firstChunkNode, "chunk");
+	if (chunkNodes.size() == 0)
 		return false;
-	}
-
-	array.setCapacity(numElements);
+	layer.chunks.setCapacity(chunkNodes.size());
 
-	// Parse elements
-	buffer = string;
-	while (*buffer != '\0')
+	for (unsigned int i = 0; i < chunkNodes.size(); i++)
 	{
-		const char *begin = buffer;
-		while (*begin == ' ' || *begin == '\t' || *begin == '\n')
-			begin++;
-		const char *end = begin;
-		while (*end != ' ' && *end != '\t' && *end != '\n' && *end != '\0' && *end != ',')
-			end++;
-
-		unsigned int value = 0;
-		const int matched = sscanf(begin, "%u", &value);
-		if (matched != 1)
-		{
-			LOGE_X("CSV layer data parsing failed at byte %u", begin - string);
-			return false;
-		}
-		array.pushBack(value);
+		pugi::xml_node chunkNode = chunkNodes[i];
+		layer.chunks.emplaceBack();
+		MapModel::Chunk &chunk = layer.chunks.back();
 
-		buffer = end;
-		while (*buffer != ',' && *buffer != '\0')
-			buffer++;
-		if (*buffer == ',')
-			buffer++;
+		applyAttributes(chunk, chunkNode, TmxAttributes::applyChunk);
+		layerDecoder.addChunk(layerIndex, chunkNode.child_value());
 	}
 
 	return true;
 }
 
-bool parseDataNode(MapModel::Data &data, pugi::xml_node dataNode)
+bool parseDataNode(MapModel::Layer &layer, unsigned int layerIndex, pugi::xml_node dataNode, LayerDecoder &layerDecoder)
 {
 	if (dataNode.empty())
 		return false;
 
-	pugi::xml_attribute encodingAttr = dataNode.attribute("encoding");
-	if (encodingAttr.empty() == false)
-	{
-		const char *value = encodingAttr.value();
-		if (strncmp(value, "base64", strlen("base64")) == 0)
-			data.encoding = MapModel::Encoding::Base64;
-		else if (strncmp(value, "csv", strlen("csv")) == 0)
-			data.encoding = MapModel::Encoding::CSV;
-	}
-
-	pugi::xml_attribute compressionAttr = dataNode.attribute("compression");
-	if (compressionAttr.empty() == false)
-	{
-		const char *value = compressionAttr.value();
-		if (strncmp(value, "gzip", strlen("gzip")) == 0)
-			data.compression = MapModel::Compression::gzip;
-		else if (strncmp(value, "zlib", strlen("zlib")) == 0)
-			data.compression = MapModel::Compression::zlib;
-		else if (strncmp(value, "zstd", strlen("zstd")) == 0)
-			data.compression = MapModel::Compression::zstd;
-	}
+	MapModel::Data &data = layer.data;
+	applyAttributes(data, dataNode, TmxAttributes::applyData);
 
-	if (data.encoding != MapModel::Encoding::CSV || data.compression != MapModel::Compression::Uncompressed)
-	{
-		const unsigned int stringLength = nctl::strnlen(dataNode.child_value(), MapModel::Data::MaxDataLength);
-		data.string = nctl::makeUnique<char[]>(stringLength + 1);
-		memcpy(data.string.get(), dataNode.child_value(), stringLength);
-		data.string[stringLength] = '\0';
-	}
-	else
-	{
-		const bool hasParsed = parseCSVLayerData(dataNode.child_value(), data.tileGids);
-		return hasParsed;
-	}
+	// The data is decoded after all layers have been parsed
+	pugi::xml_node firstChunkNode = dataNode.child("chunk");
+	if (firstChunkNode.empty() == false)
+		return parseChunkNodes(layer, layerIndex, firstChunkNode, layerDecoder);
 
+	layerDecoder.addLayer(layerIndex, dataNode.child_value());
 	return true;
 }
 
-bool parseLayerNodes(nctl::Array<MapModel::Layer> &layers, pugi::xml_node firstLayerNode)
+bool parseLayerNode(MapModel::Layer &layer, unsigned int layerIndex, StringTable &strings, pugi::xml_node layerNode, LayerDecoder &layerDecoder)
 {
-	unsigned int numLayers = 0;
-	for (pugi::xml_node layerNode = firstLayerNode; layerNode; layerNode = layerNode.next_sibling("layer"))
-		numLayers++;
-	if (numLayers == 0)
-		return false;
-	layers.setCapacity(numLayers);
-
-	for (pugi::xml_node layerNode = firstLayerNode; layerNode; layerNode = layerNode.next_sibling("layer"))
-	{
-		layers.emplaceBack();
-		MapModel::Layer &layer = layers.back();
-
-		pugi::xml_attribute idAttr = layerNode.attribute("id");
-		if (idAttr.empty() == false)
-			layer.id = idAttr.as_int();
-
-		pugi::xml_attribute nameAttr = layerNode.attribute("name");
-		if (nameAttr.empty() == false)
-			nctl::strncpy(layer.name, nameAttr.value(), MapModel::MaxNameLength - 1);
-
-		pugi::xml_attribute xAttr = layerNode.attribute("x");
-		if (xAttr.empty() == false)
-			layer.x = xAttr.as_int();
-
-		pugi::xml_attribute yAttr = layerNode.attribute("y");
-		if (yAttr.empty() == false)
-			layer.y = yAttr.as_int();
-
-		pugi::xml_attribute widthAttr = layerNode.attribute("width");
-		if (widthAttr.empty() == false)
-			layer.width = widthAttr.as_int();
-
-		pugi::xml_attribute heightAttr = layerNode.attribute("height");
-		if (heightAttr.empty() == false)
-			layer.height = heightAttr.as_int();
-
-		pugi::xml_attribute opacityAttr = layerNode.attribute("opacity");
-		if (opacityAttr.empty() == false)
-			layer.opacity = opacityAttr.as_float();
-
-		pugi::xml_attribute visibleAttr = layerNode.attribute("visible");
-		if (visibleAttr.empty() == false)
-			layer.visible = visibleAttr.as_bool();
+	applyAttributes(layer, strings, layerNode, TmxAttributes::applyLayer);
 
-		parseColor(layer.tintColor, layerNode.attribute("tintcolor"));
+	parseDataNode(layer, layerIndex, layerNode.child("data"), layerDecoder);
 
-		pugi::xml_attribute offsetXAttr = layerNode.attribute("offsetx");
-		if (offsetXAttr.empty() == false)
-			layer.offsetX = offsetXAttr.as_float();
+	parseProperties(layer.properties, strings, layerNode.child("properties"));
 
-		pugi::xml_attribute offsetYAttr = layerNode.attribute("offsety");
-		if (offsetYAttr.empty() == false)
-			layer.offsetY = offsetYAttr.as_float();
-
-		parseDataNode(layer.data, layerNode.child("data"));
+	return true;
+}
 
-		parseProperties(layer.properties, layerNode.child("properties"));
+/// Parses the layers and the groups that are children of a node in document order, which is also the draw order
+bool parseLayerTree(MapModel::Map &map, StringTable &strings, pugi::xml_node parentNode, int groupIndex, LayerDecoder &layerDecoder)
+{
+	for (pugi::xml_node node = parentNode.first_child(); node; node = node.next_sibling())
+	{
+		const char *name = node.name();
+		if (strcmp(name, "layer") == 0)
+		{
+			map.layers.emplaceBack();
+			map.layers.back().groupIndex = groupIndex;
+			map.addDrawEntry(MapModel::LayerType::TileLayer, map.layers.size() - 1);
+			parseLayerNode(map.layers.back(), map.layers.size() - 1, strings, node, layerDecoder);
+		}
+		else if (strcmp(name, "objectgroup") == 0)
+		{
+			map.objectGroups.emplaceBack();
+			map.objectGroups.back().groupIndex = groupIndex;
+			map.addDrawEntry(MapModel::LayerType::ObjectGroup, map.objectGroups.size() - 1);
+			parseObjectGroupNode(map.objectGroups.back(), strings, node);
+		}
+		else if (strcmp(name, "imagelayer") == 0)
+		{
+			map.imageLayers.emplaceBack();
+			map.imageLayers.back().groupIndex = groupIndex;
+			map.addDrawEntry(MapModel::LayerType::ImageLayer, map.imageLayers.size() - 1);
+			parseImageLayerNode(map.imageLayers.back(), strings, node);
+		}
+		else if (strcmp(name, "group") == 0)
+		{
+			// The group is referenced by index as nested groups can reallocate the array
+			map.groups.emplaceBack();
+			const int childGroupIndex = map.groups.size() - 1;
+			map.groups[childGroupIndex].parentIndex = groupIndex;
+			applyAttributes(map.groups[childGroupIndex], strings, node, TmxAttributes::applyGroup);
+
+			parseLayerTree(map, strings, node, childGroupIndex, layerDecoder);
+			parseProperties(map.groups[childGroupIndex].properties, strings, node.child("properties"));
+		}
 	}
 
 	return true;
@@ -724,13 +316,7 @@ bool parseTileOffsetNode(MapModel::TileOffset &tileOffset, pugi::xml_node tileOf
 	if (tileOffsetNode.empty())
 		return false;
 
-	pugi::xml_attribute xAttr = tileOffsetNode.attribute("x");
-	if (xAttr.empty() == false)
-		tileOffset.x = xAttr.as_float();
-
-	pugi::xml_attribute yAttr = tileOffsetNode.attribute("y");
-	if (yAttr.empty() == false)
-		tileOffset.y = yAttr.as_float();
+	applyAttributes(tileOffset, tileOffsetNode, TmxAttributes::applyTileOffset);
 
 	return true;
 }
@@ -740,78 +326,32 @@ bool parseGridNode(MapModel::Grid &grid, pugi::xml_node gridNode)
 	if (gridNode.empty())
 		return false;
 
-	pugi::xml_attribute orientationAttr = gridNode.attribute("orientation");
-	if (orientationAttr.empty() == false)
-	{
-		const char *value = orientationAttr.value();
-		if (strncmp(value, "orthogonal", strlen("orthogonal")) == 0)
-			grid.orientation = MapModel::GridOrientation::Orthogonal;
-		else if (strncmp(value, "isometric", strlen("isometric")) == 0)
-			grid.orientation = MapModel::GridOrientation::Isometric;
-	}
-
-	pugi::xml_attribute widthAttr = gridNode.attribute("width");
-	if (widthAttr.empty() == false)
-		grid.width = widthAttr.as_int();
-
-	pugi::xml_attribute heightAttr = gridNode.attribute("height");
-	if (heightAttr.empty() == false)
-		grid.height = heightAttr.as_int();
+	applyAttributes(grid, gridNode, TmxAttributes::applyGrid);
 
 	return true;
 }
 
-bool parseTerrainTypesNode(nctl::Array<MapModel::Terrain> &terrainTypes, pugi::xml_node terrainTypesNode)
+bool parseTerrainTypesNode(nctl::Array<MapModel::Terrain> &terrainTypes, StringTable &strings, pugi::xml_node terrainTypesNode)
 {
 	if (terrainTypesNode.empty())
 		return false;
 
 	pugi::xml_node firstTerrainNode = terrainTypesNode.child("terrain");
 
-	unsigned int numTerrains = 0;
-	for (pugi::xml_node terrainNode = firstTerrainNode; terrainNode; terrainNode = terrainNode.next_sibling("terrain"))
-		numTerrains++;
-	if (numTerrains == 0)
+	const SiblingNodes terrainNodes(firstTerrainNode, "terrain");
+	if (terrainNodes.size() == 0)
 		return false;
-	terrainTypes.setCapacity(numTerrains);
+	terrainTypes.setCapacity(terrainNodes.size());
 
-	for (pugi::xml_node terrainNode = firstTerrainNode; terrainNode; terrainNode = terrainNode.next_sibling("terrain"))
+	for (unsigned int i = 0; i < terrainNodes.size(); i++)
 	{
+		pugi::xml_node terrainNode = terrainNodes[i];
 		terrainTypes.emplaceBack();
 		MapModel::Terrain &terrain = terrainTypes.back();
 
-		pugi::xml_attribute nameAttr = terrainNode.attribute("name");
-		if (nameAttr.empty() == false)
-			nctl::strncpy(terrain.name, nameAttr.value(), MapModel::MaxNameLength - 1);
-
-		pugi::xml_attribute tileAttr = terrainNode.attribute("tile");
-		if (tileAttr.empty() == false)
-			terrain.tile = tileAttr.as_int();
-
-		parseProperties(terrain.properties, terrainNode.child("properties"));
-	}
-
-	return true;
-}
-
-bool parseTileTerrain(int terrain[4], const char *string)
-{
-	const char *buffer = string;
-
-	int terrainIdx = 0;
-	while (*buffer != '\0' && terrainIdx < 4)
-	{
-		while (*buffer == ',' || *buffer == ' ' || *buffer == '\t' || *buffer == '\n')
-			buffer++;
-
-		int value = 0;
-		const int matched = sscanf(buffer, "%d", &value);
-		if (matched == 1)
-			terrain[terrainIdx] = value;
-		terrainIdx++;
+		applyAttributes(terrain, strings, terrainNode, TmxAttributes::applyTerrain);
 
-		while (*buffer != ',' && *buffer != '\0')
-			buffer++;
+		parseProperties(terrain.properties, strings, terrainNode.child("properties"));
 	}
 
 	return true;
@@ -819,65 +359,43 @@ bool parseTileTerrain(int terrain[4], const char *string)
 
 bool parseFrameNodes(nctl::Array<MapModel::Frame> &frames, pugi::xml_node firstFrameNode)
 {
-	unsigned int numFrames = 0;
-	for (pugi::xml_node frameNode = firstFrameNode; frameNode; frameNode = frameNode.next_sibling("frame"))
-		numFrames++;
-	if (numFrames == 0)
+	const SiblingNodes frameNodes(firstFrameNode, "frame");
+	if (frameNodes.size() == 0)
 		return false;
-	frames.setCapacity(numFrames);
+	frames.setCapacity(frameNodes.size());
 
-	for (pugi::xml_node frameNode = firstFrameNode; frameNode; frameNode = frameNode.next_sibling("frame"))
+	for (unsigned int i = 0; i < frameNodes.size(); i++)
 	{
+		pugi::xml_node frameNode = frameNodes[i];
 		frames.emplaceBack();
 		MapModel::Frame &frame = frames.back();
 
-		pugi::xml_attribute tileIdAttr = frameNode.attribute("tileid");
-		if (tileIdAttr.empty() == false)
-			frame.tileId = tileIdAttr.as_int();
-
-		pugi::xml_attribute durationAttr = frameNode.attribute("duration");
-		if (durationAttr.empty() == false)
-			frame.duration = durationAttr.as_int();
+		applyAttributes(frame, frameNode, TmxAttributes::applyFrame);
 	}
 
 	return true;
 }
 
-bool parseTileNodes(nctl::Array<MapModel::Tile> &tiles, pugi::xml_node firstTileNode)
+bool parseTileNodes(nctl::Array<MapModel::Tile> &tiles, StringTable &strings, pugi::xml_node firstTileNode)
 {
-	unsigned int numTiles = 0;
-	for (pugi::xml_node tileNode = firstTileNode; tileNode; tileNode = tileNode.next_sibling("tile"))
-		numTiles++;
-	if (numTiles == 0)
+	const SiblingNodes tileNodes(firstTileNode, "tile");
+	if (tileNodes.size() == 0)
 		return false;
-	tiles.setCapacity(numTiles);
+	tiles.setCapacity(tileNodes.size());
 
-	for (pugi::xml_node tileNode = firstTileNode; tileNode; tileNode = tileNode.next_sibling("tile"))
+	for (unsigned int i = 0; i < tileNodes.size(); i++)
 	{
+		pugi::xml_node tileNode = tileNodes[i];
 		tiles.emplaceBack();
 		MapModel::Tile &tile = tiles.back();
 
-		pugi::xml_attribute idAttr = tileNode.attribute("id");
-		if (idAttr.empty() == false)
-			tile.id = idAttr.as_int();
-
-		pugi::xml_attribute typeAttr = tileNode.attribute("type");
-		if (typeAttr.empty() == false)
-			tile.type = typeAttr.as_int();
-
-		pugi::xml_attribute terrainAttr = tileNode.attribute("terrain");
-		if (terrainAttr.empty() == false)
-			parseTileTerrain(tile.terrain, terrainAttr.value());
-
-		pugi::xml_attribute probabilityAttr = tileNode.attribute("probability");
-		if (probabilityAttr.empty() == false)
-			tile.probability = probabilityAttr.as_float();
+		applyAttributes(tile, tileNode, TmxAttributes::applyTile);
 
 		pugi::xml_node animationNode = tileNode.child("animation");
 		if (animationNode.empty() == false)
 			parseFrameNodes(tile.frames, animationNode.child("frame"));
 
-		parseProperties(tile.properties, tileNode.child("properties"));
+		parseProperties(tile.properties, strings, tileNode.child("properties"));
 
 		// Not parsing <image>, <objectgroup>
 	}
@@ -885,230 +403,116 @@ bool parseTileNodes(nctl::Array<MapModel::Tile> &tiles, pugi::xml_node firstTile
 	return true;
 }
 
-bool parseTileSetNodes(nctl::Array<MapModel::TileSet> &tileSets, pugi::xml_node firstTileSetNode, const nctl::String &tmxDirName, nctl::String &tsxDirName)
+bool parseTileSetContent(MapModel::TileSet &tileSet, StringTable &strings, pugi::xml_node tileSetNode)
 {
-	unsigned int numTileSets = 0;
-	for (pugi::xml_node tileSetNode = firstTileSetNode; tileSetNode; tileSetNode = tileSetNode.next_sibling("tileset"))
-		numTileSets++;
-	if (numTileSets == 0)
+	if (tileSetNode.empty())
 		return false;
-	tileSets.setCapacity(numTileSets);
-
-	for (pugi::xml_node tileSetNode = firstTileSetNode; tileSetNode; tileSetNode = tileSetNode.next_sibling("tileset"))
-	{
-		tileSets.emplaceBack();
-		MapModel::TileSet &tileSet = tileSets.back();
-
-		pugi::xml_attribute firstGidAttr = tileSetNode.attribute("firstgid");
-		if (firstGidAttr.empty() == false)
-			tileSet.firstGid = firstGidAttr.as_uint();
-
-		bool hasSource = false;
-		pugi::xml_attribute sourceAttr = tileSetNode.attribute("source");
-		if (sourceAttr.empty() == false)
-		{
-			nctl::strncpy(tileSet.source, sourceAttr.value(), MapModel::MaxSourceLength - 1);
-			if (tileSet.source[0] != '\0')
-				hasSource = true;
-		}
-
-		pugi::xml_node tileSetExtNode = tileSetNode;
-		if (hasSource)
-		{
-			const nctl::String tsxFilePath = nc::fs::joinPath(tmxDirName, nctl::String(tileSet.source));
-
-			pugi::xml_document tsxFile;
-			const bool result = loadXmlFile(tsxFilePath.data(), tsxFile);
-			if (result == false)
-				return false;
-
-			tsxDirName = nc::fs::dirName(tsxFilePath.data());
-			tileSetExtNode = tsxFile.child("tileset");
-		}
-
-		pugi::xml_attribute nameAttr = tileSetExtNode.attribute("name");
-		if (nameAttr.empty() == false)
-			nctl::strncpy(tileSet.name, nameAttr.value(), MapModel::MaxNameLength - 1);
-
-		pugi::xml_attribute tileWidthAttr = tileSetExtNode.attribute("tilewidth");
-		if (tileWidthAttr.empty() == false)
-			tileSet.tileWidth = tileWidthAttr.as_int();
-
-		pugi::xml_attribute tileHeightAttr = tileSetExtNode.attribute("tileheight");
-		if (tileHeightAttr.empty() == false)
-			tileSet.tileHeight = tileHeightAttr.as_int();
 
-		pugi::xml_attribute spacingAttr = tileSetExtNode.attribute("spacing");
-		if (spacingAttr.empty() == false)
-			tileSet.spacing = spacingAttr.as_int();
+	applyAttributes(tileSet, strings, tileSetNode, TmxAttributes::applyTileSet);
 
-		pugi::xml_attribute marginAttr = tileSetExtNode.attribute("margin");
-		if (marginAttr.empty() == false)
-			tileSet.margin = marginAttr.as_int();
+	parseImageNode(tileSet.image, strings, tileSetNode.child("image"));
+	parseTileOffsetNode(tileSet.tileOffset, tileSetNode.child("tileoffset"));
+	parseGridNode(tileSet.grid, tileSetNode.child("grid"));
+	parseTerrainTypesNode(tileSet.terrainTypes, strings, tileSetNode.child("terraintypes"));
+	parseTileNodes(tileSet.tiles, strings, tileSetNode.child("tile"));
+	parseProperties(tileSet.properties, strings, tileSetNode.child("properties"));
 
-		pugi::xml_attribute tileCountAttr = tileSetExtNode.attribute("tilecount");
-		if (tileCountAttr.empty() == false)
-			tileSet.tileCount = tileCountAttr.as_int();
-
-		pugi::xml_attribute columnsAttr = tileSetExtNode.attribute("columns");
-		if (columnsAttr.empty() == false)
-			tileSet.columns = columnsAttr.as_int();
-
-		pugi::xml_attribute objectAlignmentAttr = tileSetExtNode.attribute("objectalignment");
-		if (objectAlignmentAttr.empty() == false)
-		{
-			const char *value = objectAlignmentAttr.value();
-			if (strncmp(value, "unspecified", strlen("unspecified")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::Unspecified;
-			else if (strncmp(value, "topleft", strlen("topleft")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::TopLeft;
-			else if (strncmp(value, "top", strlen("top")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::Top;
-			else if (strncmp(value, "topright", strlen("topright")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::TopRight;
-			else if (strncmp(value, "left", strlen("left")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::Left;
-			else if (strncmp(value, "center", strlen("center")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::Center;
-			else if (strncmp(value, "right", strlen("right")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::Right;
-			else if (strncmp(value, "bottomleft", strlen("bottomleft")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::BottomLeft;
-			else if (strncmp(value, "bottom", strlen("bottom")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::Bottom;
-			else if (strncmp(value, "bottomright", strlen("bottomright")) == 0)
-				tileSet.objectAlignment = MapModel::ObjectAlignment::BottomRight;
-		}
-
-		parseImageNode(tileSet.image, tileSetExtNode.child("image"));
-		parseTileOffsetNode(tileSet.tileOffset, tileSetExtNode.child("tileoffset"));
-		parseGridNode(tileSet.grid, tileSetExtNode.child("grid"));
-		parseTerrainTypesNode(tileSet.terrainTypes, tileSetExtNode.child("terrainTypes"));
-		parseTileNodes(tileSet.tiles, tileSetExtNode.child("tile"));
-		parseProperties(tileSet.properties, tileSetExtNode.child("properties"));
-
-		// Not parsing <wangsets>
-	}
+	// Not parsing <wangsets>
 
 	return true;
 }
 
-bool parseMapNode(MapModel &mapModel, pugi::xml_node mapNode)
+/// Parses the contents of a TSX file on a worker thread, describing a failure instead of logging it
+bool loadTsxFromMemory(const char *filename, unsigned char *bufferPtr, unsigned long int bufferSize, MapModel::TileSet &tileSet, StringTable &strings, nctl::String &error)
 {
-	if (mapNode.empty())
-		return false;
-
-	MapModel::Map &map = mapModel.map();
-
-	pugi::xml_attribute versionAttr = mapNode.attribute("version");
-	if (versionAttr.empty() == false)
-		nctl::strncpy(map.version, versionAttr.value(), MapModel::Map::MaxVersionLength - 1);
-
-	pugi::xml_attribute tiledversionAttr = mapNode.attribute("tiledversion");
-	if (tiledversionAttr.empty() == false)
-		nctl::strncpy(map.tiledVersion, tiledversionAttr.value(), MapModel::Map::MaxVersionLength - 1);
-
-	pugi::xml_attribute orientationAttr = mapNode.attribute("orientation");
-	if (orientationAttr.empty() == false)
+	pugi::xml_document tsxDocument;
+	pugi::xml_parse_result result = tsxDocument.load_buffer_inplace(bufferPtr, bufferSize);
+	if (result == false)
 	{
-		const char *value = orientationAttr.value();
-		if (strncmp(value, "orthogonal", strlen("orthogonal")) == 0)
-			map.orientation = MapModel::Orientation::Orthogonal;
-		else if (strncmp(value, "isometric", strlen("isometric")) == 0)
-			map.orientation = MapModel::Orientation::Isometric;
-		else if (strncmp(value, "staggered", strlen("staggered")) == 0)
-			map.orientation = MapModel::Orientation::Staggered;
-		else if (strncmp(value, "hexagonal", strlen("hexagonal")) == 0)
-			map.orientation = MapModel::Orientation::Hexagonal;
+		error.format("%s at offset %ld", result.description(), static_cast<long int>(result.offset));
+		return false;
 	}
 
-	pugi::xml_attribute renderOrderAttr = mapNode.attribute("renderorder");
-	if (renderOrderAttr.empty() == false)
+	if (parseTileSetContent(tileSet, strings, tsxDocument.child("tileset")) == false)
 	{
-		const char *value = renderOrderAttr.value();
-		if (strncmp(value, "right-down", strlen("right-down")) == 0)
-			map.renderOrder = MapModel::RenderOrder::Right_Down;
-		else if (strncmp(value, "right-up", strlen("right-up")) == 0)
-			map.renderOrder = MapModel::RenderOrder::Right_Up;
-		else if (strncmp(value, "left-down", strlen("left-down")) == 0)
-			map.renderOrder = MapModel::RenderOrder::Left_Down;
-		else if (strncmp(value, "left-up", strlen("left-up")) == 0)
-			map.renderOrder = MapModel::RenderOrder::Left_Up;
+		error = "There is no <tileset> element";
+		return false;
 	}
+	return true;
+}
 
-	pugi::xml_attribute compressionLevelAttr = mapNode.attribute("compressionlevel");
-	if (compressionLevelAttr.empty() == false)
-		map.compressionLevel = compressionLevelAttr.as_int();
-
-	pugi::xml_attribute widthAttr = mapNode.attribute("width");
-	if (widthAttr.empty() == false)
-		map.width = widthAttr.as_int();
-
-	pugi::xml_attribute heightAttr = mapNode.attribute("height");
-	if (heightAttr.empty() == false)
-		map.height = heightAttr.as_int();
-
-	pugi::xml_attribute tileWidthAttr = mapNode.attribute("tilewidth");
-	if (tileWidthAttr.empty() == false)
-		map.tileWidth = tileWidthAttr.as_int();
-
-	pugi::xml_attribute tileHeightAttr = mapNode.attribute("tileheight");
-	if (tileHeightAttr.empty() == false)
-		map.tileHeight = tileHeightAttr.as_int();
-
-	pugi::xml_attribute hexSideLengthAttr = mapNode.attribute("hexsidelength");
-	if (hexSideLengthAttr.empty() == false)
-		map.hexSideLength = hexSideLengthAttr.as_int();
-
-	pugi::xml_attribute staggerAxisAttr = mapNode.attribute("staggeraxis");
-	if (staggerAxisAttr.empty() == false)
-	{
-		const char *value = staggerAxisAttr.value();
-		if (strncmp(value, "x", strlen("x")) == 0)
-			map.staggerAxis = MapModel::StaggerAxis::X;
-		else if (strncmp(value, "y", strlen("y")) == 0)
-			map.staggerAxis = MapModel::StaggerAxis::Y;
+bool loadTxFile(const char *filename, MapModel::ObjectTemplate &objectTemplate, StringTable &strings)
+{
+	pugi::xml_document txDocument;
+	MappedFile txFile;
+	const bool hasLoaded = loadXmlFile(filename, txDocument, txFile);
+	if (hasLoaded)
+	{
+		pugi::xml_node templateNode = txDocument.child("template");
+		// The tileset of a template is always external
+		MapModel::TileSet tileSet;
+		if (parseTileSetContent(tileSet, strings, templateNode.child("tileset")))
+		{
+			objectTemplate.tileSetSource = tileSet.source;
+			objectTemplate.tileSetFirstGid = tileSet.firstGid;
+		}
+		parseObjectNode(objectTemplate.object, strings, templateNode.child("object"));
 	}
+	return hasLoaded;
+}
+
+bool parseTileSetNodes(nctl::Array<MapModel::TileSet> &tileSets, StringTable &strings, pugi::xml_node firstTileSetNode, const nctl::String &tmxDirName, nctl::String &tsxDirName)
+{
+	const SiblingNodes tileSetNodes(firstTileSetNode, "tileset");
+	if (tileSetNodes.size() == 0)
+		return false;
+	tileSets.setCapacity(tileSetNodes.size());
 
-	pugi::xml_attribute staggerIndexAttr = mapNode.attribute("staggerindex");
-	if (staggerIndexAttr.empty() == false)
+	for (unsigned int i = 0; i < tileSetNodes.size(); i++)
 	{
-		const char *value = staggerIndexAttr.value();
-		if (strncmp(value, "even", strlen("even")) == 0)
-			map.staggerIndex = MapModel::StaggerIndex::Even;
-		else if (strncmp(value, "odd", strlen("odd")) == 0)
-			map.staggerIndex = MapModel::StaggerIndex::Odd;
+		pugi::xml_node tileSetNode = tileSetNodes[i];
+		tileSets.emplaceBack();
+		// The element of an external tileset only has the `firstgid` and `source` attributes
+		parseTileSetContent(tileSets.back(), strings, tileSetNode);
 	}
 
-	parseColor(map.backgroundColor, mapNode.attribute("backgroundcolor"));
-
-	pugi::xml_attribute nextLayerIdAttr = mapNode.attribute("nextlayerid");
-	if (nextLayerIdAttr.empty() == false)
-		map.nextLayerId = nextLayerIdAttr.as_int();
-
-	pugi::xml_attribute nextObjectIdAttr = mapNode.attribute("nextobjectid");
-	if (nextObjectIdAttr.empty() == false)
-		map.nextObjectId = nextObjectIdAttr.as_int();
+	// External tilesets that are not in the cache are loaded in parallel once all tilesets have been created
+	return TileSetCache::loadExternal(tileSets, strings, tmxDirName, tsxDirName, loadTsxFromMemory);
+}
 
-	pugi::xml_attribute infiniteAttr = mapNode.attribute("infinite");
-	if (infiniteAttr.empty() == false)
-		map.infinite = infiniteAttr.as_bool();
+bool parseMapNode(MapModel &mapModel, pugi::xml_node mapNode, bool lazyDecoding)
+{
+	if (mapNode.empty())
+		return false;
 
-	parseTileSetNodes(map.tileSets, mapNode.child("tileset"), mapModel.tmxDirName(), mapModel.tsxDirName());
-	parseLayerNodes(map.layers, mapNode.child("layer"));
-	parseObjectGroupNodes(map.objectGroups, mapNode.child("objectgroup"));
-	parseImageLayerNodes(map.imageLayers, mapNode.child("imagelayer"));
-	parseProperties(map.properties, mapNode.child("properties"));
+	MapModel::Map &map = mapModel.map();
+	StringTable &strings = mapModel.strings();
+	applyAttributes(map, mapNode, TmxAttributes::applyMap);
+
+	parseTileSetNodes(map.tileSets, strings, mapNode.child("tileset"), mapModel.tmxDirName(), mapModel.tsxDirName());
+	// Layer data strings point inside the buffer of the document, they are decoded in parallel or when they are needed
+	LayerDecoder layerDecoder;
+	parseLayerTree(map, strings, mapNode, -1, layerDecoder);
+	if (lazyDecoding)
+		mapModel.setPendingLayers(nctl::makeUnique<LayerDecoder>(nctl::move(layerDecoder)));
+	else
+		layerDecoder.decode(map.layers);
+	map.accumulateGroupValues();
+	parseProperties(map.properties, strings, mapNode.child("properties"));
+	TemplateCache::resolve(mapModel, loadTxFile);
 
-	// Not parsing <group>, <editorsettings>
+	// Not parsing <editorsettings>
 
 	return true;
 }
 
 }
 
-bool TmxParser::loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize)
+bool TmxParser::loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize, Backend backend, bool lazyDecoding)
 {
+	if (backend == Backend::Stream)
+		return TmxStreamParser::loadFromMemory(mapModel, bufferPtr, bufferSize, lazyDecoding);
+
 	pugi::xml_document doc;
 	pugi::xml_parse_result result = doc.load_buffer_inplace(bufferPtr, bufferSize);
 
@@ -1119,16 +523,59 @@ bool TmxParser::loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, uns
 		return false;
 	}
 
-	return parseMapNode(mapModel, doc.child("map"));
+	return parseMapNode(mapModel, doc.child("map"), lazyDecoding);
+}
+
+bool TmxParser::loadFromFile(MapModel &mapModel, const char *filename, Backend backend, bool lazyDecoding)
+{
+	// A file whose contents outlive the parsing is read instead of being mapped
+	nctl::UniquePtr<MappedFile> xmlFile = nctl::makeUnique<MappedFile>();
+	const bool hasLoaded = xmlFile->open(filename, lazyDecoding == false);
+	if (hasLoaded == false)
+		return false;
+
+	mapModel.tmxDirName() = nc::fs::dirName(filename);
+
+	const bool hasParsed = loadFromMemory(mapModel, xmlFile->data(), xmlFile->size(), backend, lazyDecoding);
+	if (hasParsed && mapModel.hasPendingLayers())
+		mapModel.setSourceFile(nctl::move(xmlFile));
+	return hasParsed;
+}
+
+bool TmxParser::loadRegionFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize, const Region &region, Backend backend)
+{
+	if (region.rect.w <= 0 || region.rect.h <= 0)
+	{
+		LOGE_X("Invalid region size of %dx%d tiles", region.rect.w, region.rect.h);
+		return false;
+	}
+
+	// The layer data is only referenced while parsing, then the region is decoded before the buffer goes away
+	if (loadFromMemory(mapModel, bufferPtr, bufferSize, backend, true) == false)
+		return false;
+
+	const nctl::Array<MapModel::Layer> &layers = mapModel.map().layers;
+	nctl::Array<unsigned int> layerIndices(layers.size());
+	for (unsigned int layerIdx = 0; layerIdx < layers.size(); layerIdx++)
+	{
+		bool isIncluded = region.layerNames.isEmpty();
+		for (unsigned int nameIdx = 0; nameIdx < region.layerNames.size() && isIncluded == false; nameIdx++)
+			isIncluded = (strcmp(region.layerNames[nameIdx].data(), mapModel.string(layers[layerIdx].name)) == 0);
+		if (isIncluded)
+			layerIndices.pushBack(layerIdx);
+	}
+
+	return mapModel.decodeRegion(region.rect, layerIndices);
 }
 
-bool TmxParser::loadFromFile(MapModel &mapModel, const char *filename)
+bool TmxParser::loadRegionFromFile(MapModel &mapModel, const char *filename, const Region &region, Backend backend)
 {
-	long int xmlFileSize = 0;
-	nctl::UniquePtr<unsigned char[]> xmlFileBuffer;
-	loadFile(filename, xmlFileBuffer, xmlFileSize);
+	MappedFile xmlFile;
+	const bool hasLoaded = xmlFile.open(filename);
+	if (hasLoaded == false)
+		return false;
 
 	mapModel.tmxDirName() = nc::fs::dirName(filename);
 
-	return loadFromMemory(mapModel, xmlFileBuffer.get(), xmlFileSize);
+	return loadRegionFromMemory(mapModel, xmlFile.data(), xmlFile.size(), region, backend);
 }
@@ -0,0 +1,489 @@
+#include <nctl/CString.h>
+
+#include "TmxStreamParser.h"
+#include "XmlStreamReader.h"
+#include "TmxAttributes.h"
+#include "LayerDecoder.h"
+#include "TileSetCache.h"
+#include "TemplateCache.h"
+#include "MappedFile.h"
+
+namespace {
+
+using Event = XmlStreamReader::Event;
+
+template <class T>
+void applyAttributes(T &model, const XmlStreamReader &reader, bool (*applyFunction)(T &, const char *, const char *))
+{
+	for (unsigned int i = 0; i < reader.numAttributes(); i++)
+		applyFunction(model, reader.attribute(i).name, reader.attribute(i).value);
+}
+
+template <class T>
+void applyAttributes(T &model, StringTable &strings, const XmlStreamReader &reader, bool (*applyFunction)(T &, StringTable &, const char *, const char *))
+{
+	for (unsigned int i = 0; i < reader.numAttributes(); i++)
+		applyFunction(model, strings, reader.attribute(i).name, reader.attribute(i).value);
+}
+
+/// Advances to the start of the next child element, returns false at the end of the current element or on errors
+/*! Every child element should be either parsed until its end or skipped. */
+bool nextChild(XmlStreamReader &reader)
+{
+	for (;;)
+	{
+		const Event event = reader.next();
+		if (event == Event::StartElement)
+			return true;
+		else if (event != Event::Text)
+			return false;
+	}
+}
+
+bool isWhitespace(const char *string)
+{
+	while (*string == ' ' || *string == '\t' || *string == '\n' || *string == '\r')
+		string++;
+	return (*string == '\0');
+}
+
+/// Returns the first text of the current element that is not only whitespace, consuming the element
+const char *readText(XmlStreamReader &reader)
+{
+	const char *text = "";
+	bool hasText = false;
+	for (;;)
+	{
+		const Event event = reader.next();
+		if (event == Event::Text)
+		{
+			if (hasText == false && isWhitespace(reader.text()) == false)
+			{
+				text = reader.text();
+				hasText = true;
+			}
+		}
+		else if (event == Event::StartElement)
+			reader.skipElement();
+		else
+			return text;
+	}
+}
+
+void parseProperties(XmlStreamReader &reader, StringTable &strings, nctl::Array<MapModel::Property> &properties)
+{
+	while (nextChild(reader))
+	{
+		if (reader.isElement("property"))
+		{
+			properties.emplaceBack();
+			MapModel::Property &property = properties.back();
+
+			applyAttributes(property, strings, reader, TmxAttributes::applyProperty);
+
+			// The value is applied last as it depends on the type
+			const char *value = reader.attributeValue("value");
+			if (value != nullptr)
+				TmxAttributes::applyPropertyValue(property, strings, value);
+		}
+		reader.skipElement();
+	}
+}
+
+void parseObject(XmlStreamReader &reader, StringTable &strings, MapModel::Object &object)
+{
+	// Objects without a `gid` attribute are rectangles unless they have a shape element
+	object.objectType = MapModel::ObjectType::Rectangle;
+	applyAttributes(object, strings, reader, TmxAttributes::applyObject);
+
+	while (nextChild(reader))
+	{
+		if (reader.isElement("ellipse"))
+			object.objectType = MapModel::ObjectType::Ellipse;
+		else if (reader.isElement("point"))
+			object.objectType = MapModel::ObjectType::Point;
+		else if (reader.isElement("polygon") || reader.isElement("polyline"))
+		{
+			object.objectType = reader.isElement("polygon") ? MapModel::ObjectType::Polygon : MapModel::ObjectType::Polyline;
+			const char *points = reader.attributeValue("points");
+			TmxAttributes::parsePolyPoints(points ? points : "", object.points);
+		}
+		else if (reader.isElement("text"))
+		{
+			object.objectType = MapModel::ObjectType::Text;
+			applyAttributes(object.text, strings, reader, TmxAttributes::applyText);
+			object.text.data[0] = '\0';
+			nctl::strncpy(object.text.data, readText(reader), MapModel::Text::MaxDataLength - 1);
+			continue;
+		}
+		else if (reader.isElement("properties"))
+		{
+			parseProperties(reader, strings, object.properties);
+			continue;
+		}
+		reader.skipElement();
+	}
+}
+
+void parseObjectGroup(XmlStreamReader &reader, StringTable &strings, MapModel::ObjectGroup &objectGroup)
+{
+	applyAttributes(objectGroup, strings, reader, TmxAttributes::applyObjectGroup);
+
+	while (nextChild(reader))
+	{
+		if (reader.isElement("object"))
+		{
+			MapModel::Object object;
+			parseObject(reader, strings, object);
+			objectGroup.objects.append(object);
+		}
+		else if (reader.isElement("properties"))
+			parseProperties(reader, strings, objectGroup.properties);
+		else
+			reader.skipElement();
+	}
+	objectGroup.objects.shrinkToFit();
+}
+
+void parseImageLayer(XmlStreamReader &reader, StringTable &strings, MapModel::ImageLayer &imageLayer)
+{
+	applyAttributes(imageLayer, strings, reader, TmxAttributes::applyImageLayer);
+
+	while (nextChild(reader))
+	{
+		if (reader.isElement("image"))
+			applyAttributes(imageLayer.image, strings, reader, TmxAttributes::applyImage);
+		else if (reader.isElement("properties"))
+		{
+			parseProperties(reader, strings, imageLayer.properties);
+			continue;
+		}
+		reader.skipElement();
+	}
+}
+
+bool parseData(XmlStreamReader &reader, MapModel::Layer &layer, unsigned int layerIndex, LayerDecoder &layerDecoder)
+{
+	applyAttributes(layer.data, reader, TmxAttributes::applyData);
+
+	// The data is decoded after the whole map has been read, the strings stay valid in the buffer
+	bool hasText = false;
+	for (;;)
+	{
+		const Event event = reader.next();
+		if (event == Event::Text)
+		{
+			// Only the first text is decoded, as with the document parser
+			if (hasText == false && isWhitespace(reader.text()) == false)
+			{
+				layerDecoder.addLayer(layerIndex, reader.text());
+				hasText = true;
+			}
+		}
+		else if (event == Event::StartElement)
+		{
+			if (reader.isElement("chunk"))
+			{
+				layer.chunks.emplaceBack();
+				applyAttributes(layer.chunks.back(), reader, TmxAttributes::applyChunk);
+				layerDecoder.addChunk(layerIndex, readText(reader));
+			}
+			else
+				reader.skipElement();
+		}
+		else
+			break;
+	}
+
+	return (hasText || layer.chunks.isEmpty() == false);
+}
+
+void parseLayer(XmlStreamReader &reader, StringTable &strings, MapModel::Layer &layer, unsigned int layerIndex, LayerDecoder &layerDecoder)
+{
+	applyAttributes(layer, strings, reader, TmxAttributes::applyLayer);
+
+	while (nextChild(reader))
+	{
+		if (reader.isElement("data"))
+			parseData(reader, layer, layerIndex, layerDecoder);
+		else if (reader.isElement("properties"))
+			parseProperties(reader, strings, layer.properties);
+		else
+			reader.skipElement();
+	}
+}
+
+void parseTerrainTypes(XmlStreamReader &reader, StringTable &strings, nctl::Array<MapModel::Terrain> &terrainTypes)
+{
+	while (nextChild(reader))
+	{
+		if (reader.isElement("terrain") == false)
+		{
+			reader.skipElement();
+			continue;
+		}
+
+		terrainTypes.emplaceBack();
+		MapModel::Terrain &terrain = terrainTypes.back();
+		applyAttributes(terrain, strings, reader, TmxAttributes::applyTerrain);
+
+		while (nextChild(reader))
+		{
+			if (reader.isElement("properties"))
+				parseProperties(reader, strings, terrain.properties);
+			else
+				reader.skipElement();
+		}
+	}
+}
+
+void parseTile(XmlStreamReader &reader, StringTable &strings, MapModel::Tile &tile)
+{
+	applyAttributes(tile, reader, TmxAttributes::applyTile);
+
+	while (nextChild(reader))
+	{
+		if (reader.isElement("animation"))
+		{
+			while (nextChild(reader))
+			{
+				if (reader.isElement("frame"))
+				{
+					tile.frames.emplaceBack();
+					applyAttributes(tile.frames.back(), reader, TmxAttributes::applyFrame);
+				}
+				reader.skipElement();
+			}
+		}
+		else if (reader.isElement("properties"))
+			parseProperties(reader, strings, tile.properties);
+		else
+			reader.skipElement(); // Not parsing <image>, <objectgroup>
+	}
+}
+
+void parseTileSetContent(XmlStreamReader &reader, StringTable &strings, MapModel::TileSet &tileSet)
+{
+	applyAttributes(tileSet, strings, reader, TmxAttributes::applyTileSet);
+
+	while (nextChild(reader))
+	{
+		if (reader.isElement("image"))
+			applyAttributes(tileSet.image, strings, reader, TmxAttributes::applyImage);
+		else if (reader.isElement("tileoffset"))
+			applyAttributes(tileSet.tileOffset, reader, TmxAttributes::applyTileOffset);
+		else if (reader.isElement("grid"))
+			applyAttributes(tileSet.grid, reader, TmxAttributes::applyGrid);
+		else if (reader.isElement("terraintypes"))
+		{
+			parseTerrainTypes(reader, strings, tileSet.terrainTypes);
+			continue;
+		}
+		else if (reader.isElement("tile"))
+		{
+			tileSet.tiles.emplaceBack();
+			parseTile(reader, strings, tileSet.tiles.back());
+			continue;
+		}
+		else if (reader.isElement("properties"))
+		{
+			parseProperties(reader, strings, tileSet.properties);
+			continue;
+		}
+
+		// Not parsing <wangsets>
+		reader.skipElement();
+	}
+}
+
+void parseGroup(XmlStreamReader &reader, StringTable &strings, MapModel::Map &map, int parentIndex, LayerDecoder &layerDecoder);
+
+/// Parses a layer of any type or a group, adding it to the draw list of the map, returns false if the element is something else
+bool parseLayerElement(XmlStreamReader &reader, StringTable &strings, MapModel::Map &map, int groupIndex, LayerDecoder &layerDecoder)
+{
+	if (reader.isElement("layer"))
+	{
+		map.layers.emplaceBack();
+		map.layers.back().groupIndex = groupIndex;
+		map.addDrawEntry(MapModel::LayerType::TileLayer, map.layers.size() - 1);
+		parseLayer(reader, strings, map.layers.back(), map.layers.size() - 1, layerDecoder);
+	}
+	else if (reader.isElement("objectgroup"))
+	{
+		map.objectGroups.emplaceBack();
+		map.objectGroups.back().groupIndex = groupIndex;
+		map.addDrawEntry(MapModel::LayerType::ObjectGroup, map.objectGroups.size() - 1);
+		parseObjectGroup(reader, strings, map.objectGroups.back());
+	}
+	else if (reader.isElement("imagelayer"))
+	{
+		map.imageLayers.emplaceBack();
+		map.imageLayers.back().groupIndex = groupIndex;
+		map.addDrawEntry(MapModel::LayerType::ImageLayer, map.imageLayers.size() - 1);
+		parseImageLayer(reader, strings, map.imageLayers.back());
+	}
+	else if (reader.isElement("group"))
+		parseGroup(reader, strings, map, groupIndex, layerDecoder);
+	else
+		return false;
+
+	return true;
+}
+
+void parseGroup(XmlStreamReader &reader, StringTable &strings, MapModel::Map &map, int parentIndex, LayerDecoder &layerDecoder)
+{
+	// The group is referenced by index as nested groups can reallocate the array
+	map.groups.emplaceBack();
+	const int groupIndex = map.groups.size() - 1;
+	map.groups[groupIndex].parentIndex = parentIndex;
+	applyAttributes(map.groups[groupIndex], strings, reader, TmxAttributes::applyGroup);
+
+	while (nextChild(reader))
+	{
+		if (parseLayerElement(reader, strings, map, groupIndex, layerDecoder))
+			continue;
+		else if (reader.isElement("properties"))
+			parseProperties(reader, strings, map.groups[groupIndex].properties);
+		else
+			reader.skipElement();
+	}
+}
+
+void parseMap(XmlStreamReader &reader, StringTable &strings, MapModel::Map &map, LayerDecoder &layerDecoder)
+{
+	applyAttributes(map, reader, TmxAttributes::applyMap);
+
+	while (nextChild(reader))
+	{
+		if (reader.isElement("tileset"))
+		{
+			map.tileSets.emplaceBack();
+			// The element of an external tileset only has the `firstgid` and `source` attributes
+			parseTileSetContent(reader, strings, map.tileSets.back());
+		}
+		else if (parseLayerElement(reader, strings, map, -1, layerDecoder))
+			continue;
+		else if (reader.isElement("properties"))
+			parseProperties(reader, strings, map.properties);
+		else
+			reader.skipElement(); // Not parsing <editorsettings>
+	}
+
+	map.accumulateGroupValues();
+}
+
+void parseTemplate(XmlStreamReader &reader, StringTable &strings, MapModel::ObjectTemplate &objectTemplate)
+{
+	while (nextChild(reader))
+	{
+		if (reader.isElement("tileset"))
+		{
+			// The tileset of a template is always external
+			MapModel::TileSet tileSet;
+			parseTileSetContent(reader, strings, tileSet);
+			objectTemplate.tileSetSource = tileSet.source;
+			objectTemplate.tileSetFirstGid = tileSet.firstGid;
+		}
+		else if (reader.isElement("object"))
+			parseObject(reader, strings, objectTemplate.object);
+		else
+			reader.skipElement();
+	}
+}
+
+/// Advances to the root element and checks its name
+bool findRootElement(XmlStreamReader &reader, const char *name)
+{
+	Event event = reader.next();
+	while (event == Event::Text)
+		event = reader.next();
+
+	return (event == Event::StartElement && reader.isElement(name));
+}
+
+bool checkErrors(const XmlStreamReader &reader)
+{
+	if (reader.errorDescription() != nullptr)
+	{
+		LOGE_X("Error description: %s", reader.errorDescription());
+		LOGE_X("Error offset: %lu", reader.errorOffset());
+		return false;
+	}
+	return true;
+}
+
+/// Describes a parsing error in a string instead of logging it, for the functions that run on worker threads
+bool checkErrors(const XmlStreamReader &reader, nctl::String &error)
+{
+	if (reader.errorDescription() != nullptr)
+	{
+		error.format("%s at offset %lu", reader.errorDescription(), reader.errorOffset());
+		return false;
+	}
+	return true;
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+bool TmxStreamParser::loadFromMemory(MapModel &mapModel, unsigned char *bufferPtr, unsigned long int bufferSize, bool lazyDecoding)
+{
+	XmlStreamReader reader(reinterpret_cast<char *>(bufferPtr), bufferSize);
+	if (findRootElement(reader, "map") == false)
+	{
+		checkErrors(reader);
+		return false;
+	}
+
+	MapModel::Map &map = mapModel.map();
+	LayerDecoder layerDecoder;
+	parseMap(reader, mapModel.strings(), map, layerDecoder);
+	if (checkErrors(reader) == false)
+		return false;
+
+	if (lazyDecoding)
+		mapModel.setPendingLayers(nctl::makeUnique<LayerDecoder>(nctl::move(layerDecoder)));
+	else
+		layerDecoder.decode(map.layers);
+
+	// External tilesets that are not in the cache are loaded in parallel once the map has been read
+	TileSetCache::loadExternal(map.tileSets, mapModel.strings(), mapModel.tmxDirName(), mapModel.tsxDirName(), loadTileSetFromMemory);
+	TemplateCache::resolve(mapModel, loadTemplateFile);
+
+	return true;
+}
+
+bool TmxStreamParser::loadTileSetFromMemory(const char *filename, unsigned char *bufferPtr, unsigned long int bufferSize, MapModel::TileSet &tileSet, StringTable &strings, nctl::String &error)
+{
+	XmlStreamReader reader(reinterpret_cast<char *>(bufferPtr), bufferSize);
+	if (findRootElement(reader, "tileset") == false)
+	{
+		if (checkErrors(reader, error))
+			error = "There is no <tileset> element";
+		return false;
+	}
+
+	parseTileSetContent(reader, strings, tileSet);
+	return checkErrors(reader, error);
+}
+
+bool TmxStreamParser::loadTemplateFile(const char *filename, MapModel::ObjectTemplate &objectTemplate, StringTable &strings)
+{
+	MappedFile txFile;
+	const bool hasLoaded = txFile.open(filename);
+	if (hasLoaded == false)
+		return false;
+
+	XmlStreamReader reader(reinterpret_cast<char *>(txFile.data()), txFile.size());
+	if (findRootElement(reader, "template") == false)
+	{
+		checkErrors(reader);
+		return false;
+	}
+
+	parseTemplate(reader, strings, objectTemplate);
+	return checkErrors(reader);
+}
@@ -0,0 +1,76 @@
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+	#define WITH_WORKER_THREADS
+#endif
+
+#ifdef WITH_WORKER_THREADS
+	#include <thread>
+	#include <atomic>
+#endif
+
+#include "WorkerPool.h"
+
+namespace {
+
+/// The number of threads requested by the user, zero for automatic
+unsigned int requestedNumThreads = 0;
+
+#ifdef WITH_WORKER_THREADS
+void workerFunction(std::atomic<unsigned int> *nextJobIndex, unsigned int numJobs, WorkerPool::JobFunction function, void *userData)
+{
+	unsigned int jobIndex = nextJobIndex->fetch_add(1);
+	while (jobIndex < numJobs)
+	{
+		function(jobIndex, userData);
+		jobIndex = nextJobIndex->fetch_add(1);
+	}
+}
+#endif
+
+}
+
+void WorkerPool::run(unsigned int numJobs, JobFunction function, void *userData)
+{
+	if (numJobs == 0 || function == nullptr)
+		return;
+
+	const unsigned int numWorkers = (numJobs < numThreads()) ? numJobs : numThreads();
+	if (numWorkers <= 1)
+	{
+		for (unsigned int jobIndex = 0; jobIndex < numJobs; jobIndex++)
+			function(jobIndex, userData);
+		return;
+	}
+
+#ifdef WITH_WORKER_THREADS
+	std::atomic<unsigned int> nextJobIndex(0);
+	std::thread threads[MaxThreads];
+
+	// The calling thread is one of the workers
+	for (unsigned int i = 0; i < numWorkers - 1; i++)
+		threads[i] = std::thread(workerFunction, &nextJobIndex, numJobs, function, userData);
+	workerFunction(&nextJobIndex, numJobs, function, userData);
+
+	for (unsigned int i = 0; i < numWorkers - 1; i++)
+		threads[i].join();
+#endif
+}
+
+unsigned int WorkerPool::numThreads()
+{
+#ifdef WITH_WORKER_THREADS
+	if (requestedNumThreads > 0)
+		return requestedNumThreads;
+
+	const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	if (hardwareThreads == 0)
+		return 1;
+	return (hardwareThreads < MaxThreads) ? hardwareThreads : MaxThreads;
+#else
+	return 1;
+#endif
+}
+
+void WorkerPool::setNumThreads(unsigned int numThreads)
+{
+	requestedNumThreads = (numThreads < MaxThreads) ? numThreads : MaxThreads;
+}
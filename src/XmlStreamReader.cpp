@@ -0,0 +1,389 @@
+#include <cstring> // for `memchr()`, `memcmp()` and `strlen()`
+#include <cstdlib> // for `strtoul()`
+
+#include "XmlStreamReader.h"
+
+namespace {
+
+inline bool isSpace(char c)
+{
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+}
+
+char *findString(char *begin, const char *end, const char *string)
+{
+	const unsigned long int length = strlen(string);
+	while (begin + length <= end)
+	{
+		char *first = static_cast<char *>(memchr(begin, string[0], end - begin));
+		if (first == nullptr || first + length > end)
+			return nullptr;
+		if (memcmp(first, string, length) == 0)
+			return first;
+		begin = first + 1;
+	}
+	return nullptr;
+}
+
+/// Writes the UTF-8 encoding of a code point and returns the position after it
+char *encodeUtf8(char *dest, unsigned long int codePoint)
+{
+	if (codePoint < 0x80)
+		*dest++ = static_cast<char>(codePoint);
+	else if (codePoint < 0x800)
+	{
+		*dest++ = static_cast<char>(0xC0 | (codePoint >> 6));
+		*dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+	else if (codePoint < 0x10000)
+	{
+		*dest++ = static_cast<char>(0xE0 | (codePoint >> 12));
+		*dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+	else
+	{
+		*dest++ = static_cast<char>(0xF0 | (codePoint >> 18));
+		*dest++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+	return dest;
+}
+
+/// Decodes a single entity between '&' and ';', returns false if it is not recognized
+/*! The decoded form is never longer than the entity, so it can be written in place. */
+bool decodeEntity(const char *entity, unsigned long int length, char *&dest)
+{
+	if (length == 2 && memcmp(entity, "lt", 2) == 0)
+		*dest++ = '<';
+	else if (length == 2 && memcmp(entity, "gt", 2) == 0)
+		*dest++ = '>';
+	else if (length == 3 && memcmp(entity, "amp", 3) == 0)
+		*dest++ = '&';
+	else if (length == 4 && memcmp(entity, "apos", 4) == 0)
+		*dest++ = '\'';
+	else if (length == 4 && memcmp(entity, "quot", 4) == 0)
+		*dest++ = '"';
+	else if (length >= 2 && entity[0] == '#')
+	{
+		const bool isHex = (entity[1] == 'x');
+		const char *digits = isHex ? entity + 2 : entity + 1;
+		char *digitsEnd = nullptr;
+		const unsigned long int codePoint = strtoul(digits, &digitsEnd, isHex ? 16 : 10);
+		if (digitsEnd != entity + length || digitsEnd == digits || codePoint > 0x10FFFF)
+			return false;
+		dest = encodeUtf8(dest, codePoint);
+	}
+	else
+		return false;
+
+	return true;
+}
+
+/// Decodes the entities of a range in place and returns its new end
+char *decodeEntities(char *begin, char *end)
+{
+	char *ampersand = static_cast<char *>(memchr(begin, '&', end - begin));
+	if (ampersand == nullptr)
+		return end;
+
+	// The longest entity that can be recognized is a numeric reference like `&#x10FFFF;`
+	const unsigned long int MaxEntityLength = 10;
+	char *dest = ampersand;
+	const char *src = ampersand;
+	while (src < end)
+	{
+		if (*src == '&')
+		{
+			const unsigned long int remaining = static_cast<unsigned long int>(end - src - 1);
+			const unsigned long int searchLength = (remaining < MaxEntityLength) ? remaining : MaxEntityLength;
+			const char *semicolon = static_cast<const char *>(memchr(src + 1, ';', searchLength));
+			// Unrecognized entities are kept verbatim, the `strtoul()` call cannot go past the semicolon
+			if (semicolon != nullptr && decodeEntity(src + 1, semicolon - src - 1, dest))
+			{
+				src = semicolon + 1;
+				continue;
+			}
+		}
+		*dest++ = *src++;
+	}
+
+	return dest;
+}
+
+}
+
+///////////////////////////////////////////////////////////
+// CONSTRUCTORS and DESTRUCTOR
+///////////////////////////////////////////////////////////
+
+XmlStreamReader::XmlStreamReader(char *buffer, unsigned long int size)
+    : buffer_(buffer), end_(buffer + size), pos_(buffer), tagPending_(false), endPending_(false),
+      depth_(0), numAttributes_(0), text_(nullptr), errorDescription_(nullptr), errorOffset_(0)
+{
+	current_.name = nullptr;
+	current_.length = 0;
+
+	// Skipping the UTF-8 byte order mark
+	if (size >= 3 && memcmp(buffer, "\xEF\xBB\xBF", 3) == 0)
+		pos_ += 3;
+}
+
+///////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+///////////////////////////////////////////////////////////
+
+XmlStreamReader::Event XmlStreamReader::next()
+{
+	if (errorDescription_ != nullptr)
+		return Event::Error;
+
+	if (endPending_)
+	{
+		endPending_ = false;
+		depth_--;
+		numAttributes_ = 0;
+		return Event::EndElement;
+	}
+
+	for (;;)
+	{
+		if (tagPending_ == false)
+		{
+			if (pos_ >= end_)
+			{
+				if (depth_ > 0)
+					return error("Unexpected end of document", pos_);
+				return Event::EndDocument;
+			}
+
+			if (*pos_ != '<')
+			{
+				char *lessThan = static_cast<char *>(memchr(pos_, '<', end_ - pos_));
+				// Text outside of the root element is ignored
+				if (depth_ == 0)
+				{
+					pos_ = (lessThan != nullptr) ? lessThan : end_;
+					continue;
+				}
+				if (lessThan == nullptr)
+					return error("Unexpected end of document", pos_);
+
+				char *textEnd = decodeEntities(pos_, lessThan);
+				text_ = pos_;
+				// Overwriting the '<' character has to be remembered for the next call
+				tagPending_ = (textEnd == lessThan);
+				*textEnd = '\0';
+				pos_ = lessThan;
+				return Event::Text;
+			}
+		}
+
+		tagPending_ = false;
+		char *p = pos_ + 1;
+		if (p >= end_)
+			return error("Unexpected end of document", pos_);
+
+		if (*p == '?')
+		{
+			pos_ = p;
+			if (skipAfter("?>") == false)
+				return error("Unterminated processing instruction", p);
+		}
+		else if (*p == '!')
+		{
+			if (end_ - p >= 3 && p[1] == '-' && p[2] == '-')
+			{
+				pos_ = p + 3;
+				if (skipAfter("-->") == false)
+					return error("Unterminated comment", p);
+			}
+			else if (end_ - p >= 8 && memcmp(p, "![CDATA[", 8) == 0)
+			{
+				char *cdataEnd = findString(p + 8, end_, "]]>");
+				if (cdataEnd == nullptr)
+					return error("Unterminated CDATA section", p);
+				if (depth_ == 0)
+					return error("CDATA section outside of the root element", p);
+
+				text_ = p + 8;
+				*cdataEnd = '\0';
+				pos_ = cdataEnd + 3;
+				return Event::Text;
+			}
+			else
+			{
+				pos_ = p;
+				if (skipDoctype() == false)
+					return error("Unterminated document type declaration", p);
+			}
+		}
+		else if (*p == '/')
+			return parseEndElement(p + 1);
+		else
+			return parseStartElement(p);
+	}
+}
+
+bool XmlStreamReader::skipElement()
+{
+	const unsigned int parentDepth = depth_ - 1;
+	for (;;)
+	{
+		const Event event = next();
+		if (event == Event::EndElement && depth_ == parentDepth)
+			return true;
+		else if (event == Event::Error || event == Event::EndDocument)
+			return false;
+	}
+}
+
+bool XmlStreamReader::isElement(const char *name) const
+{
+	const unsigned long int length = strlen(name);
+	return (length == current_.length && memcmp(current_.name, name, length) == 0);
+}
+
+const char *XmlStreamReader::attributeValue(const char *name) const
+{
+	for (unsigned int i = 0; i < numAttributes_; i++)
+	{
+		if (strcmp(attributes_[i].name, name) == 0)
+			return attributes_[i].value;
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+///////////////////////////////////////////////////////////
+
+XmlStreamReader::Event XmlStreamReader::error(const char *description, const char *position)
+{
+	errorDescription_ = description;
+	errorOffset_ = static_cast<unsigned long int>(position - buffer_);
+	return Event::Error;
+}
+
+bool XmlStreamReader::skipAfter(const char *terminator)
+{
+	char *found = findString(pos_, end_, terminator);
+	if (found == nullptr)
+		return false;
+
+	pos_ = found + strlen(terminator);
+	return true;
+}
+
+bool XmlStreamReader::skipDoctype()
+{
+	int bracketDepth = 0;
+	for (char *p = pos_; p < end_; p++)
+	{
+		if (*p == '[')
+			bracketDepth++;
+		else if (*p == ']')
+			bracketDepth--;
+		else if (*p == '>' && bracketDepth <= 0)
+		{
+			pos_ = p + 1;
+			return true;
+		}
+	}
+	return false;
+}
+
+XmlStreamReader::Event XmlStreamReader::parseStartElement(char *name)
+{
+	char *p = name;
+	while (p < end_ && isSpace(*p) == false && *p != '/' && *p != '>')
+		p++;
+	if (p == name)
+		return error("Invalid element name", name);
+	if (depth_ >= MaxDepth)
+		return error("Maximum element depth exceeded", name);
+
+	// Element names are not terminated in place, as the next character may be needed
+	current_.name = name;
+	current_.length = static_cast<unsigned int>(p - name);
+	numAttributes_ = 0;
+
+	for (;;)
+	{
+		while (p < end_ && isSpace(*p))
+			p++;
+		if (p >= end_)
+			return error("Unterminated start tag", name);
+
+		if (*p == '>')
+		{
+			pos_ = p + 1;
+			break;
+		}
+		else if (*p == '/')
+		{
+			if (p + 1 >= end_ || p[1] != '>')
+				return error("Invalid start tag", p);
+			pos_ = p + 2;
+			endPending_ = true;
+			break;
+		}
+
+		char *attributeName = p;
+		while (p < end_ && isSpace(*p) == false && *p != '=' && *p != '/' && *p != '>')
+			p++;
+		char *attributeNameEnd = p;
+		while (p < end_ && isSpace(*p))
+			p++;
+		if (p >= end_ || *p != '=')
+			return error("Attribute without a value", attributeName);
+		p++;
+		*attributeNameEnd = '\0';
+
+		while (p < end_ && isSpace(*p))
+			p++;
+		if (p >= end_ || (*p != '"' && *p != '\''))
+			return error("Attribute value without quotes", attributeName);
+		const char quote = *p++;
+		char *valueEnd = static_cast<char *>(memchr(p, quote, end_ - p));
+		if (valueEnd == nullptr)
+			return error("Unterminated attribute value", attributeName);
+		if (numAttributes_ >= MaxAttributes)
+			return error("Too many attributes", attributeName);
+
+		*decodeEntities(p, valueEnd) = '\0';
+		attributes_[numAttributes_].name = attributeName;
+		attributes_[numAttributes_].value = p;
+		numAttributes_++;
+		p = valueEnd + 1;
+	}
+
+	elementStack_[depth_] = current_;
+	depth_++;
+	return Event::StartElement;
+}
+
+XmlStreamReader::Event XmlStreamReader::parseEndElement(char *name)
+{
+	char *p = name;
+	while (p < end_ && isSpace(*p) == false && *p != '>')
+		p++;
+	const unsigned int length = static_cast<unsigned int>(p - name);
+	while (p < end_ && isSpace(*p))
+		p++;
+	if (p >= end_ || *p != '>')
+		return error("Unterminated end tag", name);
+	if (depth_ == 0)
+		return error("Unexpected end tag", name);
+
+	const ElementName &openElement = elementStack_[depth_ - 1];
+	if (openElement.length != length || memcmp(openElement.name, name, length) != 0)
+		return error("Mismatched end tag", name);
+
+	current_ = openElement;
+	depth_--;
+	numAttributes_ = 0;
+	pos_ = p + 1;
+	return Event::EndElement;
+}
@@ -15,6 +15,12 @@
 
 #include "MapModel.h"
 #include "TmxParser.h"
+#include "TmjParser.h"
+#include "TileSetCache.h"
+#include "TemplateCache.h"
+#include "FileWatcher.h"
+#include "WorkerPool.h"
+#include "MapCache.h"
 #include "MapFactory.h"
 #include "FileDialog.h"
 #include "CameraController.h"
@@ -244,23 +250,23 @@ const char *VerticalAlignToString(MapModel::VerticalAlign vAlign)
 	}
 }
 
-void treeProperties(const nctl::Array<MapModel::Property> &properties)
+void treeProperties(const MapModel::Property *properties, unsigned int numProperties, const MapModel &mapModel, const char *label = "Properties")
 {
 	static nctl::String auxString(256);
 
-	if (properties.isEmpty() == false && ImGui::TreeNode(&properties, "Properties"))
+	if (numProperties > 0 && ImGui::TreeNode(properties, "%s", label))
 	{
-		for (unsigned int propertyIDx = 0; propertyIDx < properties.size(); propertyIDx++)
+		for (unsigned int propertyIDx = 0; propertyIDx < numProperties; propertyIDx++)
 		{
 			const MapModel::Property &property = properties[propertyIDx];
-			auxString.format("#%u %s \"%s\":", propertyIDx, propertyTypeToString(property.type), property.name);
+			auxString.format("#%u %s \"%s\":", propertyIDx, propertyTypeToString(property.type), mapModel.string(property.name));
 			if (property.type != MapModel::PropertyType::ColorType)
 				auxString.append(" ");
 
 			switch (property.type)
 			{
 				case MapModel::PropertyType::StringType:
-					auxString.formatAppend("\"%s\"", property.string);
+					auxString.formatAppend("\"%s\"", mapModel.string(property.stringValue()));
 					break;
 				case MapModel::PropertyType::IntType:
 					auxString.formatAppend("%d", property.intValue());
@@ -274,7 +280,7 @@ void treeProperties(const nctl::Array<MapModel::Property> &properties)
 				case MapModel::PropertyType::ColorType:
 					break;
 				case MapModel::PropertyType::FileType:
-					auxString.formatAppend("\"%s\"", property.string);
+					auxString.formatAppend("\"%s\"", mapModel.string(property.stringValue()));
 					break;
 				case MapModel::PropertyType::ObjectType:
 					auxString.formatAppend("%d", property.object());
@@ -286,7 +292,7 @@ void treeProperties(const nctl::Array<MapModel::Property> &properties)
 			{
 				ImGui::SameLine();
 				nc::Colorf objectColor(property.color());
-				auxString.format("###%s", property.name);
+				auxString.format("###%s", mapModel.string(property.name));
 				ImGui::ColorEdit4(auxString.data(), objectColor.data(), ImGuiColorEditFlags_NoPicker |
 				                  ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoDragDrop);
 			}
@@ -296,6 +302,11 @@ void treeProperties(const nctl::Array<MapModel::Property> &properties)
 	}
 }
 
+void treeProperties(const nctl::Array<MapModel::Property> &properties, const MapModel &mapModel)
+{
+	treeProperties(properties.data(), properties.size(), mapModel);
+}
+
 void unload(MapFactory::Configuration &config)
 {
 	if (config.animSprites)
@@ -311,27 +322,133 @@ void unload(MapFactory::Configuration &config)
 		config.textures->clear();
 }
 
+bool useMapCache = true;
+bool lazyDecoding = true;
+TmxParser::Backend parserBackend = TmxParser::Backend::Dom;
+bool hotReload = true;
+FileWatcher fileWatcher;
+
+/// The map whose cache is saved once it has been drawn, as the data of its hidden layers has to be decoded first
+nctl::String pendingCacheFilename;
+unsigned int framesBeforeCacheSave = 0;
+/// The number of frames to wait, so that the map is drawn at least once even when it is loaded before the first frame
+const unsigned int CacheSaveDelay = 2;
+
+/// Saves the cache of a map after decoding the data of the layers that are still pending
+void saveMapCache(MapModel &mapModel, const char *filename)
+{
+	const nc::TimeStamp timestamp = nc::TimeStamp::now();
+	mapModel.decodeLayers();
+	if (MapCache::save(mapModel, filename))
+		LOGI_X("Map cache saved in %f ms", timestamp.millisecondsSince());
+}
+
+/// Watches the map file and its dependencies, tracking the index of the tileset or template that each one belongs to
+void watchMap(const MapModel &mapModel, const char *filename)
+{
+	const MapModel::Map &map = mapModel.map();
+	fileWatcher.clear();
+	fileWatcher.add(filename, FileWatcher::FileType::Map, 0);
+
+	for (unsigned int i = 0; i < map.tileSets.size(); i++)
+	{
+		const MapModel::TileSet &tileSet = map.tileSets[i];
+		if (tileSet.source != StringTable::EmptyId)
+			fileWatcher.add(nc::fs::joinPath(mapModel.tmxDirName(), mapModel.string(tileSet.source)).data(), FileWatcher::FileType::TileSet, i);
+		if (tileSet.image.source != StringTable::EmptyId)
+			fileWatcher.add(nc::fs::joinPath(mapModel.tsxDirName(), mapModel.string(tileSet.image.source)).data(), FileWatcher::FileType::Image, i);
+	}
+	for (unsigned int i = 0; i < map.templates.size(); i++)
+		fileWatcher.add(nc::fs::joinPath(mapModel.tmxDirName(), mapModel.string(map.templates[i].source)).data(), FileWatcher::FileType::Template, i);
+}
+
+/// Loads a map, from its cache if allowed, then instantiates it
 bool loadMap(MapFactory::Configuration &mapConfig, MapModel &mapModel, const char *filename)
 {
 	if (filename[0] == '\0' || nc::fs::isReadableFile(filename) == false)
 		return false;
 
 	LOGI_X("Loading map \"%s\"", filename);
+	pendingCacheFilename.clear();
 	mapModel = MapModel();
 	nc::TimeStamp timestamp = nc::TimeStamp::now();
-	const bool hasParsed = TmxParser::loadFromFile(mapModel, filename);
-	LOGI_X("Map parsed in %f ms", timestamp.millisecondsSince());
+	bool hasParsed = useMapCache && MapCache::load(mapModel, filename);
+	if (hasParsed)
+		LOGI_X("Map loaded from cache in %f ms", timestamp.millisecondsSince());
+	else
+	{
+		mapModel = MapModel();
+		timestamp = nc::TimeStamp::now();
+		if (nc::fs::hasExtension(filename, "tmj") || nc::fs::hasExtension(filename, "json"))
+		{
+			hasParsed = TmjParser::loadFromFile(mapModel, filename, lazyDecoding);
+			LOGI_X("Map parsed with the JSON parser in %f ms", timestamp.millisecondsSince());
+		}
+		else
+		{
+			hasParsed = TmxParser::loadFromFile(mapModel, filename, parserBackend, lazyDecoding);
+			LOGI_X("Map parsed with the %s parser in %f ms", (parserBackend == TmxParser::Backend::Stream) ? "stream" : "DOM", timestamp.millisecondsSince());
+		}
+		LOGI_X("Layer data and tilesets decoded by up to %u threads", WorkerPool::numThreads());
+		LOGI_X("Tileset cache has %u entries, %u hits and %u misses", TileSetCache::size(), TileSetCache::numHits(), TileSetCache::numMisses());
+		LOGI_X("Template cache has %u entries, %u hits and %u misses", TemplateCache::size(), TemplateCache::numHits(), TemplateCache::numMisses());
+
+		if (hasParsed && useMapCache)
+		{
+			if (mapModel.hasPendingLayers())
+			{
+				pendingCacheFilename = nctl::String(filename);
+				framesBeforeCacheSave = CacheSaveDelay;
+			}
+			else
+				saveMapCache(mapModel, filename);
+		}
+	}
+
 	if (hasParsed)
 	{
 		unload(mapConfig);
 		timestamp = nc::TimeStamp::now();
 		MapFactory::instantiate(mapModel, mapConfig);
 		LOGI_X("Map instantiated in %f ms", timestamp.millisecondsSince());
+		watchMap(mapModel, filename);
 		return true;
 	}
 	return false;
 }
 
+/// Reloads only what depends on the files that have changed since the last poll
+/*! A changed tileset image only reloads its texture, any other change parses and instantiates the map again,
+ *  while the tileset and template caches still skip the files that have not changed. */
+void reloadChangedFiles(MapFactory::Configuration &mapConfig, MapModel &mapModel)
+{
+	static nctl::Array<FileWatcher::Change> changes;
+	changes.clear();
+	if (fileWatcher.poll(changes) == false)
+		return;
+
+	bool reloadMap = false;
+	for (unsigned int i = 0; i < changes.size(); i++)
+	{
+		const FileWatcher::Change &change = changes[i];
+		LOGI_X("File \"%s\" has changed", change.filename);
+		if (change.type == FileWatcher::FileType::Image)
+		{
+			if (reloadMap == false && MapFactory::reloadTileSetImage(mapModel, mapConfig, change.index) == false)
+				reloadMap = true;
+		}
+		else
+			reloadMap = true;
+	}
+
+	if (reloadMap)
+	{
+		// The name of the map is copied as the watcher is cleared when the map is loaded
+		const nctl::String filename(fileWatcher.filename(0));
+		loadMap(mapConfig, mapModel, filename.data());
+	}
+}
+
 MapModel mapModel;
 MapFactory::Configuration mapConfig;
 bool showInterface = true;
@@ -394,20 +511,41 @@ void MyEventHandler::onFrameStart()
 	const float frameTime = nc::theApplication().frameTime();
 	const MapModel::Map &map = mapModel.map();
 
+	if (pendingCacheFilename.isEmpty() == false && --framesBeforeCacheSave == 0)
+	{
+		saveMapCache(mapModel, pendingCacheFilename.data());
+		pendingCacheFilename.clear();
+	}
+
 	static nctl::String fileSelection(nc::fs::MaxPathLength);
 	if (FileDialog::create(FileDialog::config, fileSelection))
 		loadMap(mapConfig, mapModel, fileSelection.data());
+	else if (hotReload)
+		reloadChangedFiles(mapConfig, mapModel);
 
 	ImGui::SetNextWindowPos(ImVec2(nc::theApplication().width() * 0.75f, 0.0f), ImGuiCond_FirstUseEver);
 	ImGui::SetNextWindowSize(ImVec2(nc::theApplication().width() * 0.25f, nc::theApplication().height()), ImGuiCond_FirstUseEver);
 	if (showInterface && ImGui::Begin("ncTiledViewer", &showInterface))
 	{
 		ImGui::Checkbox("Use Mesh Sprites", &mapConfig.useMeshSprites);
+		ImGui::SameLine();
+		ImGui::Checkbox("Use Map Cache", &useMapCache);
+		ImGui::SameLine();
+		ImGui::Checkbox("Hot Reload", &hotReload);
+		ImGui::SameLine();
+		ImGui::Checkbox("Lazy Decoding", &lazyDecoding);
+		static int currentComboParserBackend = 0;
+		const char *parserBackendStrings[2] = { "DOM", "Stream" };
+		if (ImGui::Combo("Parser", &currentComboParserBackend, parserBackendStrings, IM_ARRAYSIZE(parserBackendStrings)))
+			parserBackend = static_cast<TmxParser::Backend>(currentComboParserBackend);
+		static int numWorkerThreads = 0;
+		if (ImGui::SliderInt("Worker Threads", &numWorkerThreads, 0, WorkerPool::MaxThreads, (numWorkerThreads == 0) ? "Auto" : "%d"))
+			WorkerPool::setNumThreads(static_cast<unsigned int>(numWorkerThreads));
 		if (ImGui::Button("Load Map..."))
 		{
-			FileDialog::config.windowTitle = "Open TMX map";
+			FileDialog::config.windowTitle = "Open TMX or TMJ map";
 			FileDialog::config.selectionType = FileDialog::SelectionType::FILE;
-			FileDialog::config.extensions = "tmx\0\0";
+			FileDialog::config.extensions = "tmx\0tmj\0json\0\0";
 			FileDialog::config.modalPopup = true;
 			FileDialog::config.windowOpen = true;
 		}
@@ -514,7 +652,7 @@ void MyEventHandler::onFrameStart()
 			ImGui::Text("Next Object Id: %d", map.nextObjectId);
 			ImGui::Text("Infinite: %s", map.infinite ? "yes" : "no");
 
-			treeProperties(map.properties);
+			treeProperties(map.properties, mapModel);
 
 			if (map.tileSets.isEmpty() == false && ImGui::TreeNode("Tilesets"))
 			{
@@ -524,8 +662,8 @@ void MyEventHandler::onFrameStart()
 					if (ImGui::TreeNode(&tileSet, "Tileset #%u", tileSetIdx))
 					{
 						ImGui::Text("First GID: %d", tileSet.firstGid);
-						ImGui::Text("Source: %s", tileSet.source);
-						ImGui::Text("Name: %s", tileSet.name);
+						ImGui::Text("Source: %s", mapModel.string(tileSet.source));
+						ImGui::Text("Name: %s", mapModel.string(tileSet.name));
 						ImGui::Text("Tile Width: %d", tileSet.tileWidth);
 						ImGui::Text("Tile Height: %d", tileSet.tileHeight);
 						ImGui::Text("Spacing: %d", tileSet.spacing);
@@ -534,11 +672,11 @@ void MyEventHandler::onFrameStart()
 						ImGui::Text("Columns: %d", tileSet.columns);
 						ImGui::Text("Object Alignment: %s", objectAlignmentToString(tileSet.objectAlignment));
 
-						if (nctl::strnlen(tileSet.image.source, MapModel::MaxSourceLength) && ImGui::TreeNode("Image"))
+						if (tileSet.image.source != StringTable::EmptyId && ImGui::TreeNode("Image"))
 						{
 							const MapModel::Image &image = tileSet.image;
 							ImGui::Text("Format: %s", image.format);
-							ImGui::Text("Source: %s", image.source);
+							ImGui::Text("Source: %s", mapModel.string(image.source));
 							if (image.hasTransparency)
 							{
 								nc::Colorf transColor(image.trans);
@@ -575,10 +713,10 @@ void MyEventHandler::onFrameStart()
 								const MapModel::Terrain &terrain = tileSet.terrainTypes[terrainTypeIdx];
 								if (ImGui::TreeNode(&terrain, "Terrain #%u", terrainTypeIdx))
 								{
-									ImGui::Text("Name: %s", terrain.name);
+									ImGui::Text("Name: %s", mapModel.string(terrain.name));
 									ImGui::Text("Tile: %d", terrain.tile);
 
-									treeProperties(terrain.properties);
+									treeProperties(terrain.properties, mapModel);
 
 									ImGui::TreePop();
 								}
@@ -617,7 +755,7 @@ void MyEventHandler::onFrameStart()
 										ImGui::TreePop();
 									}
 
-									treeProperties(tile.properties);
+									treeProperties(tile.properties, mapModel);
 
 									ImGui::TreePop();
 								}
@@ -626,7 +764,7 @@ void MyEventHandler::onFrameStart()
 							ImGui::TreePop();
 						}
 
-						treeProperties(tileSet.properties);
+						treeProperties(tileSet.properties, mapModel);
 
 						ImGui::TreePop();
 					}
@@ -643,7 +781,7 @@ void MyEventHandler::onFrameStart()
 					if (ImGui::TreeNode(&layer, "Layer #%u", layerIdx))
 					{
 						ImGui::Text("Id: %d", layer.id);
-						ImGui::Text("Name: %s", layer.name);
+						ImGui::Text("Name: %s", mapModel.string(layer.name));
 						ImGui::Text("X: %d", layer.x);
 						ImGui::Text("Y: %d", layer.y);
 						ImGui::Text("Width: %d", layer.width);
@@ -656,19 +794,40 @@ void MyEventHandler::onFrameStart()
 						ImGui::Text("Offset X: %f", layer.offsetX);
 						ImGui::Text("Offset Y: %f", layer.offsetY);
 
-						if (layer.data.string && ImGui::TreeNode("Data"))
+						const bool isPending = mapModel.isLayerPending(layerIdx);
+						if ((isPending || layer.data.string || layer.data.tileGids.isEmpty() == false || layer.chunks.isEmpty() == false) && ImGui::TreeNode("Data"))
 						{
 							const MapModel::Data &data = layer.data;
 							ImGui::Text("Encoding: %s", encodingToString(data.encoding));
 							ImGui::Text("Compression: %s", compressionToString(data.compression));
 
+							if (isPending)
+							{
+								ImGui::Text("Not decoded yet");
+								ImGui::SameLine();
+								if (ImGui::Button("Decode"))
+								{
+									nctl::Array<unsigned int> layerIndices(1);
+									layerIndices.pushBack(layerIdx);
+									mapModel.decodeLayers(layerIndices);
+								}
+							}
+
 							if (data.tileGids.isEmpty() == false)
 								ImGui::Text("Tile GIDs: %u", data.tileGids.size());
+							if (layer.chunks.isEmpty() == false)
+							{
+								unsigned int numTileGids = 0;
+								for (unsigned int chunkIdx = 0; chunkIdx < layer.chunks.size(); chunkIdx++)
+									numTileGids += layer.chunks[chunkIdx].tileGids.size();
+								ImGui::Text("Chunks: %u", layer.chunks.size());
+								ImGui::Text("Tile GIDs: %u", numTileGids);
+							}
 
 							ImGui::TreePop();
 						}
 
-						treeProperties(layer.properties);
+						treeProperties(layer.properties, mapModel);
 
 						ImGui::TreePop();
 					}
@@ -685,7 +844,7 @@ void MyEventHandler::onFrameStart()
 					if (ImGui::TreeNode(&objectGroup, "Object Group #%u", groupIdx))
 					{
 						ImGui::Text("Id: %d", objectGroup.id);
-						ImGui::Text("Name: %s", objectGroup.name);
+						ImGui::Text("Name: %s", mapModel.string(objectGroup.name));
 						nc::Colorf color(objectGroup.color);
 						ImGui::ColorEdit4("Color", color.data(), ImGuiColorEditFlags_NoPicker |
 						                  ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoDragDrop);
@@ -702,35 +861,38 @@ void MyEventHandler::onFrameStart()
 						ImGui::Text("Offset Y: %f", objectGroup.offsetY);
 						ImGui::Text("Draw Order: %s", drawOrderToString(objectGroup.drawOrder));
 
-						treeProperties(objectGroup.properties);
+						treeProperties(objectGroup.properties, mapModel);
 
 						if (map.objectGroups.isEmpty() == false && ImGui::TreeNode("Objects"))
 						{
-							for (unsigned int objectIdx = 0; objectIdx < objectGroup.objects.size(); objectIdx++)
+							const MapModel::ObjectArray &objects = objectGroup.objects;
+							for (unsigned int objectIdx = 0; objectIdx < objects.size(); objectIdx++)
 							{
-								const MapModel::Object &object = objectGroup.objects[objectIdx];
-								if (ImGui::TreeNode(&object, "Object #%u (%s)", objectIdx, objectTypeToString(object.objectType)))
+								const MapModel::ObjectDetails &details = objects.details[objectIdx];
+								const MapModel::ObjectType objectType = objects.objectTypes[objectIdx];
+								if (ImGui::TreeNode(&details, "Object #%u (%s)", objectIdx, objectTypeToString(objectType)))
 								{
-									ImGui::Text("Id: %d", object.id);
-									ImGui::Text("Name: %s", object.name);
-									ImGui::Text("X: %f", object.x);
-									ImGui::Text("Y: %f", object.y);
-									ImGui::Text("Width: %f", object.width);
-									ImGui::Text("Height: %f", object.height);
-									ImGui::Text("Rotation: %f", object.rotation);
-									if (object.objectType == MapModel::ObjectType::Tile)
-										ImGui::Text("GID: %d", object.gid);
-									ImGui::Text("Visible: %s", object.visible ? "yes" : "no");
-									if (object.templateFile[0] != '\0')
-										ImGui::Text("Template: %s", object.templateFile);
-									ImGui::Text("Object Type: %s", objectTypeToString(object.objectType));
-
-									if (object.objectType == MapModel::ObjectType::Polygon ||
-									    object.objectType == MapModel::ObjectType::Polyline)
+									ImGui::Text("Id: %d", details.id);
+									ImGui::Text("Name: %s", mapModel.string(details.name));
+									ImGui::Text("X: %f", objects.positions[objectIdx].x);
+									ImGui::Text("Y: %f", objects.positions[objectIdx].y);
+									ImGui::Text("Width: %f", objects.sizes[objectIdx].x);
+									ImGui::Text("Height: %f", objects.sizes[objectIdx].y);
+									ImGui::Text("Rotation: %f", objects.rotations[objectIdx]);
+									if (objectType == MapModel::ObjectType::Tile)
+										ImGui::Text("GID: %d", objects.gids[objectIdx]);
+									ImGui::Text("Visible: %s", objects.visible[objectIdx] ? "yes" : "no");
+									if (details.templateFile != StringTable::EmptyId)
+										ImGui::Text("Template: %s", mapModel.string(details.templateFile));
+									ImGui::Text("Object Type: %s", objectTypeToString(objectType));
+
+									if (objectType == MapModel::ObjectType::Polygon ||
+									    objectType == MapModel::ObjectType::Polyline)
 									{
-										const nctl::Array<nc::Vector2i> &points = object.points;
+										const nc::Vector2f *points = objects.objectPoints(objectIdx, map.templates);
+										const unsigned int numPoints = objects.numObjectPoints(objectIdx, map.templates);
 
-										if (points.isEmpty() == false && ImGui::TreeNode(&points, "%u points", points.size()))
+										if (numPoints > 0 && ImGui::TreeNode(points, "%u points", numPoints))
 										{
 											ImGui::Columns(2, "points", true);
 											ImGui::Text("X");
@@ -739,11 +901,11 @@ void MyEventHandler::onFrameStart()
 											ImGui::NextColumn();
 											ImGui::Separator();
 
-											for (unsigned int i = 0; i < points.size(); i++)
+											for (unsigned int i = 0; i < numPoints; i++)
 											{
-												ImGui::Text("%d", points[i].x);
+												ImGui::Text("%f", points[i].x);
 												ImGui::NextColumn();
-												ImGui::Text("%d", points[i].y);
+												ImGui::Text("%f", points[i].y);
 												ImGui::NextColumn();
 											}
 
@@ -751,13 +913,13 @@ void MyEventHandler::onFrameStart()
 											ImGui::TreePop();
 										}
 									}
-									else if (object.objectType == MapModel::ObjectType::Text)
+									else if (objectType == MapModel::ObjectType::Text)
 									{
-										const MapModel::Text &text = object.text;
+										const MapModel::Text &text = *objects.objectText(objectIdx, map.templates);
 										if (ImGui::TreeNode(&text, "Text (\"%10s\")", text.data))
 										{
 											ImGui::Text("Data: %s", text.data);
-											ImGui::Text("Font Family: %s", text.fontFamily);
+											ImGui::Text("Font Family: %s", mapModel.string(text.fontFamily));
 											ImGui::Text("Pixel Size: %d", text.pixelSize);
 											ImGui::Text("Wrap: %s", text.wrap ? "yes" : "no");
 											nc::Colorf textColor(text.color);
@@ -775,7 +937,12 @@ void MyEventHandler::onFrameStart()
 										}
 									}
 
-									treeProperties(object.properties);
+									treeProperties(objects.objectProperties(objectIdx), details.numProperties, mapModel);
+									if (details.templateIndex >= 0)
+									{
+										const nctl::Array<MapModel::Property> &templateProperties = map.templates[details.templateIndex].object.properties;
+										treeProperties(templateProperties.data(), templateProperties.size(), mapModel, "Template Properties");
+									}
 
 									ImGui::TreePop();
 								}
@@ -799,7 +966,7 @@ void MyEventHandler::onFrameStart()
 					if (ImGui::TreeNode(&imageLayer, "Image Layer #%u", layerIdx))
 					{
 						ImGui::Text("Id: %d", imageLayer.id);
-						ImGui::Text("Name: %s", imageLayer.name);
+						ImGui::Text("Name: %s", mapModel.string(imageLayer.name));
 						ImGui::Text("Offset X: %f", imageLayer.offsetX);
 						ImGui::Text("Offset Y: %f", imageLayer.offsetY);
 						ImGui::Text("X: %d", imageLayer.x);
@@ -817,6 +984,34 @@ void MyEventHandler::onFrameStart()
 
 				ImGui::TreePop();
 			}
+
+			if (map.groups.isEmpty() == false && ImGui::TreeNode("Groups"))
+			{
+				for (unsigned int groupIdx = 0; groupIdx < map.groups.size(); groupIdx++)
+				{
+					const MapModel::Group &group = map.groups[groupIdx];
+					if (ImGui::TreeNode(&group, "Group #%u", groupIdx))
+					{
+						ImGui::Text("Id: %d", group.id);
+						ImGui::Text("Name: %s", mapModel.string(group.name));
+						if (group.parentIndex >= 0)
+							ImGui::Text("Parent: Group #%d", group.parentIndex);
+						ImGui::Text("Offset X: %f", group.offsetX);
+						ImGui::Text("Offset Y: %f", group.offsetY);
+						ImGui::Text("Opacity: %f", group.opacity);
+						ImGui::Text("Visible: %s", group.visible ? "yes" : "no");
+						nc::Colorf tintColor(group.tintColor);
+						ImGui::ColorEdit4("Tint Color", tintColor.data(), ImGuiColorEditFlags_NoPicker |
+						                  ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoDragDrop);
+
+						treeProperties(group.properties, mapModel);
+
+						ImGui::TreePop();
+					}
+				}
+
+				ImGui::TreePop();
+			}
 		}
 		ImGui::End();
 	}
@@ -828,7 +1023,7 @@ void MyEventHandler::onPostUpdate()
 {
 	if (drawOverlay)
 	{
-		for (unsigned int i = 0; i < mapModel.map().objectGroups.size(); i++)
+		for (unsigned int i = 0; i < mapModel.map().drawList.size(); i++)
 			MapFactory::drawObjectsWithImGui(cameraCtrl_->camera(), mapModel, i);
 	}
 }